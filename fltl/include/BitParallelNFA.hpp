@@ -0,0 +1,396 @@
+/*
+ * BitParallelNFA.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_BITPARALLELNFA_HPP_
+#define FLTL_BITPARALLELNFA_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/NFA.hpp"
+
+#include "fltl/include/nfa/SymbolByte.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace fltl {
+
+    /// runs an NFA over bytes without determinizing it, by keeping the set
+    /// of active states as a bitset of one or more machine words.
+    ///
+    /// the NFA is first put into Glushkov form: its epsilon transitions are
+    /// closed over, and each state is split into one position per byte
+    /// that leads into it, so that every position is entered on a single
+    /// byte. position 0 is the start. reading byte c then moves the active
+    /// set D to follow(D) & enter[c], where follow(D) is the union of the
+    /// successors of D. follow(D) is found a chunk of D at a time through
+    /// tables that hold the union of the successors of every subset of the
+    /// positions of a chunk, so that each step costs one table lookup per
+    /// non-zero chunk of D instead of one per active position.
+    template <typename AlphaT>
+    class BitParallelNFA : private trait::Uncopyable {
+    public:
+
+        typedef uint64_t word_type;
+
+        enum {
+            NUM_BYTES = 256,
+            WORD_BITS = 64,
+
+            /// upper bound on the number of words in the follow tables, so that
+            /// they stay in cache
+            MAX_TABLE_WORDS = 1U << 17U
+        };
+
+    private:
+
+        typedef NFA<AlphaT> nfa_type;
+        typedef typename nfa_type::state_type state_type;
+        typedef typename nfa_type::transition_type transition_type;
+        typedef typename nfa_type::generator_type generator_type;
+
+        unsigned num_positions_;
+
+        /// the number of words in each bitset
+        unsigned num_words;
+
+        /// the number of bits of the active set looked up at a time
+        unsigned chunk_bits;
+
+        /// enter[c * num_words + w] is word w of the positions entered on
+        /// byte c
+        std::vector<word_type> enter;
+
+        /// the positions that accept
+        std::vector<word_type> accept;
+
+        /// follow[((k << chunk_bits) + v) * num_words + w] is word w of
+        /// the union of the successors of the positions of chunk k that
+        /// are set in v
+        std::vector<word_type> follow;
+
+        /// the successors of the positions of chunk k are all within words
+        /// follow_begin[k] up to follow_end[k], so that steps only touch
+        /// the words that can change
+        std::vector<unsigned> follow_begin;
+        std::vector<unsigned> follow_end;
+
+        /// the active positions, and the next active positions
+        std::vector<word_type> curr;
+        std::vector<word_type> next;
+
+        inline static void set_bit(word_type *set, unsigned i) throw() {
+            set[i / WORD_BITS] |= static_cast<word_type>(1U) << (i % WORD_BITS);
+        }
+
+        /// next = follow(curr) & enter[byte]
+        void step(unsigned char byte) throw() {
+            const unsigned chunks_per_word(WORD_BITS / chunk_bits);
+            const word_type chunk_mask(
+                (static_cast<word_type>(1U) << chunk_bits) - 1U
+            );
+
+            for(unsigned w(0); w < num_words; ++w) {
+                next[w] = 0;
+            }
+
+            for(unsigned w(0); w < num_words; ++w) {
+                word_type bits(curr[w]);
+                for(unsigned k(w * chunks_per_word); 0 != bits; ++k) {
+                    const unsigned v(static_cast<unsigned>(bits & chunk_mask));
+                    bits >>= chunk_bits;
+
+                    if(0 == v) {
+                        continue;
+                    }
+
+                    const word_type *succ(
+                        &(follow[((k << chunk_bits) + v) * num_words])
+                    );
+
+                    for(unsigned i(follow_begin[k]); i < follow_end[k]; ++i) {
+                        next[i] |= succ[i];
+                    }
+                }
+            }
+
+            const word_type *entered(&(enter[byte * num_words]));
+            for(unsigned w(0); w < num_words; ++w) {
+                next[w] &= entered[w];
+            }
+
+            curr.swap(next);
+        }
+
+        bool curr_is_empty(void) const throw() {
+            for(unsigned w(0); w < num_words; ++w) {
+                if(0 != curr[w]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool curr_accepts(void) const throw() {
+            for(unsigned w(0); w < num_words; ++w) {
+                if(0 != (curr[w] & accept[w])) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void reset(void) throw() {
+            for(unsigned w(0); w < num_words; ++w) {
+                curr[w] = 0;
+            }
+            curr[0] = 1U;
+        }
+
+    public:
+
+        BitParallelNFA(void) throw()
+            : trait::Uncopyable()
+            , num_positions_(0)
+            , num_words(0)
+            , chunk_bits(1)
+        { }
+
+        /// compile an NFA whose input symbols each stand for a single
+        /// byte. returns false if the automaton has a symbol that isn't a
+        /// single byte.
+        bool compile(const nfa_type &nfa) throw() {
+            const unsigned num_states(nfa.num_states_capacity());
+
+            num_positions_ = 0;
+            num_words = 0;
+            enter.clear();
+            accept.clear();
+            follow.clear();
+            follow_begin.clear();
+            follow_end.clear();
+
+            std::vector<std::vector<unsigned> > epsilons(num_states);
+            std::vector<std::vector<std::pair<unsigned char, unsigned> > >
+                moves(num_states);
+
+            // positions are (state, byte) pairs that some transition enters
+            std::map<std::pair<unsigned, unsigned char>, unsigned> positions;
+            std::vector<unsigned> position_state(1U, nfa.get_start_state().number());
+            std::vector<unsigned char> position_byte(1U, 0U);
+
+            transition_type trans;
+            generator_type transitions(nfa.search(~trans));
+            for(; transitions.match_next(); ) {
+                const unsigned source(trans.source().number());
+                const unsigned sink(trans.sink().number());
+
+                if(nfa.epsilon() == trans.read()) {
+                    epsilons[source].push_back(sink);
+                    continue;
+                }
+
+                unsigned char byte(0);
+                if(!nfa::symbol_byte(nfa.get_alpha(trans.read()), byte)) {
+                    return false;
+                }
+
+                moves[source].push_back(std::make_pair(byte, sink));
+
+                const std::pair<unsigned, unsigned char> key(sink, byte);
+                if(0U == positions.count(key)) {
+                    positions[key] = static_cast<unsigned>(position_state.size());
+                    position_state.push_back(sink);
+                    position_byte.push_back(byte);
+                }
+            }
+
+            std::vector<bool> is_accept(num_states, false);
+            state_type state;
+            generator_type states(nfa.search(~state));
+            for(; states.match_next(); ) {
+                is_accept[state.number()] = nfa.is_accept_state(state);
+            }
+
+            num_positions_ = static_cast<unsigned>(position_state.size());
+            num_words = (num_positions_ + WORD_BITS - 1U) / WORD_BITS;
+
+            // the successors of each position depend only on its state, so
+            // find the successors of each state that a position is in
+            std::vector<word_type> successors;
+            std::vector<int> successor_set(num_states, -1);
+            std::vector<bool> state_accepts(num_states, false);
+            std::vector<unsigned> seen(num_states, 0U);
+            std::vector<unsigned> work;
+            unsigned stamp(0);
+
+            for(unsigned p(0); p < num_positions_; ++p) {
+                const unsigned q(position_state[p]);
+                if(0 <= successor_set[q]) {
+                    continue;
+                }
+
+                successor_set[q] = static_cast<int>(successors.size());
+                successors.resize(successors.size() + num_words, 0U);
+                word_type *succ(&(successors[successor_set[q]]));
+
+                // walk the epsilon closure of q
+                ++stamp;
+                work.clear();
+                work.push_back(q);
+                seen[q] = stamp;
+
+                for(; !work.empty(); ) {
+                    const unsigned r(work.back());
+                    work.pop_back();
+
+                    if(is_accept[r]) {
+                        state_accepts[q] = true;
+                    }
+
+                    for(unsigned i(0); i < moves[r].size(); ++i) {
+                        set_bit(succ, positions[std::make_pair(
+                            moves[r][i].second, moves[r][i].first
+                        )]);
+                    }
+
+                    for(unsigned i(0); i < epsilons[r].size(); ++i) {
+                        const unsigned s(epsilons[r][i]);
+                        if(stamp != seen[s]) {
+                            seen[s] = stamp;
+                            work.push_back(s);
+                        }
+                    }
+                }
+            }
+
+            enter.assign(NUM_BYTES * num_words, 0U);
+            accept.assign(num_words, 0U);
+
+            for(unsigned p(0); p < num_positions_; ++p) {
+                if(0U != p) {
+                    set_bit(&(enter[position_byte[p] * num_words]), p);
+                }
+
+                if(state_accepts[position_state[p]]) {
+                    set_bit(&(accept[0]), p);
+                }
+            }
+
+            // use the widest chunks whose tables fit
+            const unsigned num_bits(num_words * WORD_BITS);
+            for(chunk_bits = 8U; chunk_bits > 1U; chunk_bits /= 2U) {
+                const unsigned long table_words(
+                    static_cast<unsigned long>(num_bits / chunk_bits) *
+                    (1UL << chunk_bits) * num_words
+                );
+
+                if(table_words <= MAX_TABLE_WORDS) {
+                    break;
+                }
+            }
+
+            const unsigned num_chunks(num_bits / chunk_bits);
+            const unsigned num_entries(1U << chunk_bits);
+            follow.assign(num_chunks * num_entries * num_words, 0U);
+            follow_begin.assign(num_chunks, num_words);
+            follow_end.assign(num_chunks, 0U);
+
+            for(unsigned p(0); p < num_positions_; ++p) {
+                const unsigned k(p / chunk_bits);
+                const unsigned bit(1U << (p % chunk_bits));
+                const word_type *succ(
+                    &(successors[successor_set[position_state[p]]])
+                );
+
+                for(unsigned w(0); w < num_words; ++w) {
+                    if(0 != succ[w]) {
+                        follow_begin[k] = std::min(follow_begin[k], w);
+                        follow_end[k] = std::max(follow_end[k], w + 1U);
+                    }
+                }
+
+                // add the successors of p to each subset that has p
+                for(unsigned v(bit); v < num_entries; v = (v + 1U) | bit) {
+                    word_type *entry(&(follow[((k << chunk_bits) + v) * num_words]));
+                    for(unsigned w(0); w < num_words; ++w) {
+                        entry[w] |= succ[w];
+                    }
+                }
+            }
+
+            curr.assign(num_words, 0U);
+            next.assign(num_words, 0U);
+            return true;
+        }
+
+        /// does the NFA accept all of [begin, end)?
+        bool run(const char *begin, const char *end) throw() {
+            assert(0 != num_words);
+
+            reset();
+            for(; begin < end && !curr_is_empty(); ++begin) {
+                step(static_cast<unsigned char>(*begin));
+            }
+
+            return begin == end && curr_accepts();
+        }
+
+        /// find the first position in [begin, end) at which some substring
+        /// accepted by the NFA ends. returns that position, or 0 if no
+        /// substring is accepted.
+        const char *find(const char *begin, const char *end) throw() {
+            assert(0 != num_words);
+
+            reset();
+            if(curr_accepts()) {
+                return begin;
+            }
+
+            for(; begin < end; ) {
+                curr[0] |= 1U; // start a new match at every byte
+                step(static_cast<unsigned char>(*begin++));
+                if(curr_accepts()) {
+                    return begin;
+                }
+            }
+
+            return 0;
+        }
+
+        /// the number of positions of the Glushkov form of the NFA
+        inline unsigned num_positions(void) const throw() {
+            return num_positions_;
+        }
+
+        /// the number of machine words in each set of positions
+        inline unsigned num_set_words(void) const throw() {
+            return num_words;
+        }
+    };
+}
+
+#endif /* FLTL_BITPARALLELNFA_HPP_ */
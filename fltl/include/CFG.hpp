@@ -37,13 +37,17 @@
 #include <map>
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 #include <functional>
 
 #include "fltl/include/helper/Align.hpp"
+#include "fltl/include/helper/Arena.hpp"
 #include "fltl/include/helper/Array.hpp"
 #include "fltl/include/helper/BlockAllocator.hpp"
-#include "fltl/include/helper/StorageChain.hpp"
+#include "fltl/include/helper/Interner.hpp"
+#include "fltl/include/helper/SharedBlockAllocator.hpp"
+#include "fltl/include/helper/ThreadLocal.hpp"
 #include "fltl/include/helper/UnsafeCast.hpp"
 
 #include "fltl/include/mpl/If.hpp"
@@ -116,6 +120,8 @@ namespace fltl {
         template <typename, typename> class Unbound;
         template <typename> class Generator;
         template <typename> class OpaquePattern;
+        template <typename> class Listener;
+        template <typename> class BulkLoader;
 
         template <typename, typename> class Pattern;
         template <typename> class AnySymbol;
@@ -194,6 +200,7 @@ namespace fltl {
     ///
     /// Assumptions:
     ///     - AlphaT has a strict weak ordering.
+    ///     - AlphaT's traits can hash and compare elements for equality.
     ///     - AlphaT is default constructible
     ///     - AlphaT is copy constructible
     template <typename AlphaT>
@@ -212,6 +219,8 @@ namespace fltl {
         friend class cfg::ProductionBuilder<AlphaT>;
         friend class cfg::Production<AlphaT>;
         friend class cfg::detail::SimpleGenerator<AlphaT>;
+        friend class cfg::Listener<AlphaT>;
+        friend class cfg::BulkLoader<AlphaT>;
 
         template <typename, typename>
         friend class cfg::detail::PatternGenerator;
@@ -228,33 +237,36 @@ namespace fltl {
         /// injective mapping between non-zero negative integers and pointers
         /// to the parameterized alphabet type. the association between
         /// terminals and their representations needs to be maintained.
+        /// the alphabet values and names themselves are owned by the
+        /// interners below.
         mutable helper::Array<std::pair<alphabet_type, const char *> > terminal_map;
-        typedef std::map<
+        typedef helper::Interner<
             alphabet_type,
-            cfg::internal_sym_type,
-            typename traits_type::less_type
+            cfg::internal_sym_type
         > terminal_map_inv_type;
         terminal_map_inv_type terminal_map_inv;
 
         /// injective mapping between strings and terminal types representing
-        /// variable terminals.
-        typedef std::map<
+        /// variable terminals. this also owns the names of automatically
+        /// named variable terminals.
+        typedef helper::Interner<
             const char *,
-            cfg::TerminalSymbol<AlphaT>,
-            trait::Alphabet<const char *>::less_type
+            cfg::internal_sym_type
         > variable_terminal_map_type;
-        variable_terminal_map_type variable_terminal_map;
+        mutable variable_terminal_map_type variable_terminal_map;
 
         /// injective mapping between non-zero positive integers and pointers
         /// to the structure containing the productions related to the
         /// variable.
         mutable helper::Array<cfg::Variable<AlphaT> *> variable_map;
-        typedef std::map<
+
+        /// injective mapping between strings and variables. this also owns
+        /// the names of automatically named variables.
+        typedef helper::Interner<
             const char *,
-            cfg::VariableSymbol<AlphaT>,
-            trait::Alphabet<const char *>::less_type
+            cfg::internal_sym_type
         > named_variable_map_type;
-        named_variable_map_type named_variable_map;
+        mutable named_variable_map_type named_variable_map;
 
         /// unused variables
         cfg::Variable<AlphaT> *unused_variables;
@@ -273,15 +285,23 @@ namespace fltl {
         /// the start variable
         cfg::Variable<AlphaT> *start_variable;
 
+        /// objects to tell about changes to this grammar
+        cfg::Listener<AlphaT> *first_listener;
+
         /// allocator for variables
-        static helper::StorageChain<helper::BlockAllocator<
-            cfg::Variable<AlphaT>
-        > > variable_allocator;
+        helper::BlockAllocator<cfg::Variable<AlphaT> > variable_allocator;
 
-        /// allocator for productions
-        static helper::StorageChain<helper::BlockAllocator<
+        /// allocator for productions. productions can outlive the grammar
+        /// (e.g. if a production_type is destroyed after the grammar), so
+        /// the allocator is shared with the productions.
+        helper::SharedBlockAllocator<
             cfg::Production<AlphaT>
-        > > production_allocator;
+        > *production_allocator;
+
+        /// the arena that variables, productions and production symbols
+        /// are allocated from, if any. nothing in an arena is ever freed
+        /// individually.
+        helper::Arena *arena;
 
         // copy constructor
         CFG(const CFG<AlphaT> &) throw() { assert(false); }
@@ -292,6 +312,20 @@ namespace fltl {
 
         typedef CFG<AlphaT> self_type;
 
+        /// add the epsilon terminal and the null variable
+        void init(void) throw() {
+            static const char * const UB("$0");
+            static const char * const EPSILON("epsilon");
+
+            auto_symbol_upper_bound = UB;
+
+            terminal_map.append(std::make_pair<alphabet_type,const char *>(
+                mpl::Static<AlphaT>::VALUE,
+                EPSILON
+            ));
+            variable_map.append(0);
+        }
+
     public:
 
         /// arbitrary symbol (terminal, non-terminal) of a grammar
@@ -317,6 +351,9 @@ namespace fltl {
 
         typedef cfg::OpaquePattern<AlphaT> pattern_type;
 
+        /// adds many productions to the grammar at once
+        typedef cfg::BulkLoader<AlphaT> bulk_loader_type;
+
         /// short forms
         typedef symbol_type sym_t;
         typedef symbol_buffer_type sym_buff_t;
@@ -348,59 +385,141 @@ namespace fltl {
             , num_variables_(0)
             , first_production(0)
             , start_variable(0)
+            , first_listener(0)
+            , variable_allocator()
+            , production_allocator(helper::SharedBlockAllocator<
+                cfg::Production<AlphaT>
+              >::create())
+            , arena(0)
             , _()
             , __()
         {
-            static const char * const UB("$0");
-            static const char * const EPSILON("epsilon");
-
-            auto_symbol_upper_bound = UB;
+            init();
+        }
 
-            terminal_map.append(std::make_pair<alphabet_type,const char *>(
-                mpl::Static<AlphaT>::VALUE,
-                EPSILON
-            ));
-            variable_map.append(0);
+        /// constructor for a grammar whose variables, productions and
+        /// production symbols live in an arena. destroying such a grammar
+        /// doesn't free any of them; they are all freed at once when the
+        /// arena is destroyed. this is meant for short-lived programs that
+        /// build a big grammar, print it and exit.
+        ///
+        /// note: - the arena must outlive the grammar, as well as every
+        ///         production, symbol string, generator or pattern that
+        ///         refers to the grammar.
+        ///       - removed productions and variables are never freed, so
+        ///         memory use only grows.
+        explicit CFG(helper::Arena &arena_) throw()
+            : trait::Uncopyable()
+            , next_variable_id(1)
+            , next_terminal_id(-1)
+            , terminal_map(256U)
+            , terminal_map_inv()
+            , variable_terminal_map()
+            , variable_map(256U)
+            , named_variable_map()
+            , unused_variables(0)
+            , num_productions_(0)
+            , num_variables_(0)
+            , first_production(0)
+            , start_variable(0)
+            , first_listener(0)
+            , variable_allocator()
+            , production_allocator(0)
+            , arena(&arena_)
+            , _()
+            , __()
+        {
+            init();
         }
 
         /// destructor
         ~CFG(void) throw() {
 
-            unsigned j(0);
-
-            // free the variables
-            const unsigned max(static_cast<unsigned>(next_variable_id));
-            for(unsigned i(1U); i < max; ++i) {
-                if(0 != variable_map.get(i)) {
-                    variable_allocator->deallocate(variable_map.get(i));
-                    variable_map.set(i, 0);
-                    ++j;
+            // free the variables. the variables of a grammar in an arena,
+            // along with their productions, are freed by the arena.
+            if(0 == arena) {
+                const unsigned max(static_cast<unsigned>(next_variable_id));
+                for(unsigned i(1U); i < max; ++i) {
+                    if(0 != variable_map.get(i)) {
+                        variable_allocator.deallocate(variable_map.get(i));
+                        variable_map.set(i, 0);
+                    }
                 }
-            }
 
-            // free the terminals
-            for(unsigned i(1U); i < terminal_map.size(); ++i) {
-                std::pair<alphabet_type,const char *> &pp(
-                    terminal_map.get(i)
-                );
+                for(cfg::Variable<AlphaT> *var(unused_variables), *next(0);
+                    0 != var;
+                    var = next) {
 
-                traits_type::destroy(pp.first);
-                trait::Alphabet<const char *>::destroy(pp.second);
+                    next = var->next;
+                    variable_allocator.deallocate(var);
+                }
             }
 
-            for(cfg::Variable<AlphaT> *var(unused_variables), *next_var(0);
-                0 != var;
-                var = next_var) {
+            // detach the listeners
+            for(cfg::Listener<AlphaT> *listener(first_listener), *next(0);
+                0 != listener;
+                listener = next) {
 
-                next_var = var->next;
-                variable_allocator->deallocate(var);
-                ++j;
+                next = listener->next_listener;
+                listener->listened_cfg = 0;
+                listener->prev_listener = 0;
+                listener->next_listener = 0;
             }
 
             first_production = 0;
             unused_variables = 0;
             num_productions_ = 0;
             auto_symbol_upper_bound = 0;
+            first_listener = 0;
+
+            if(0 != production_allocator) {
+                production_allocator->release();
+            }
+
+            production_allocator = 0;
+            arena = 0;
+        }
+
+        /// attach a listener to this grammar, so that it is told about
+        /// changes to the grammar. a listener can only be attached to one
+        /// grammar at a time.
+        void add_listener(cfg::Listener<AlphaT> *listener) throw() {
+            assert(
+                0 == listener->listened_cfg &&
+                "Listener is already attached to a grammar."
+            );
+
+            listener->listened_cfg = this;
+            listener->prev_listener = 0;
+            listener->next_listener = first_listener;
+
+            if(0 != first_listener) {
+                first_listener->prev_listener = listener;
+            }
+
+            first_listener = listener;
+        }
+
+        /// detach a listener from this grammar
+        void remove_listener(cfg::Listener<AlphaT> *listener) throw() {
+            assert(
+                this == listener->listened_cfg &&
+                "Listener is not attached to this grammar."
+            );
+
+            if(0 != listener->prev_listener) {
+                listener->prev_listener->next_listener = listener->next_listener;
+            } else {
+                first_listener = listener->next_listener;
+            }
+
+            if(0 != listener->next_listener) {
+                listener->next_listener->prev_listener = listener->prev_listener;
+            }
+
+            listener->listened_cfg = 0;
+            listener->prev_listener = 0;
+            listener->next_listener = 0;
         }
 
         /// get the starting variable for this grammar
@@ -424,33 +543,29 @@ namespace fltl {
 
             assert(is_valid_symbol_name(name));
 
-            typename named_variable_map_type::iterator var_loc(
-                named_variable_map.find(name)
-            );
+            cfg::internal_sym_type id(0);
 
             // it's a variable
-            if(named_variable_map.end() != var_loc) {
-                return (*var_loc).second;
+            if(named_variable_map.find(name, id)) {
+                return variable_type(id);
             }
 
-            typename variable_terminal_map_type::iterator term_loc(
-                variable_terminal_map.find(name)
-            );
-
             // it's a variable terminal
-            if(variable_terminal_map.end() != term_loc) {
-                return (*term_loc).second;
+            if(variable_terminal_map.find(name, id)) {
+                return terminal_type(id);
             }
 
             // create a variable terminal for it
             terminal_type term(next_terminal_id);
             --next_terminal_id;
-            const char *name_copy(trait::Alphabet<const char *>::copy(name));
+            const char *name_copy(variable_terminal_map.insert(
+                name,
+                term.value
+            ));
             terminal_map.append(std::make_pair(
                 mpl::Static<alphabet_type>::VALUE,
                 name_copy
             ));
-            variable_terminal_map[name_copy] = term;
 
             // check if it's an upper bound
             if('$' == *name) {
@@ -475,7 +590,7 @@ namespace fltl {
             terminal_type term(next_terminal_id);
             --next_terminal_id;
 
-            const char *name(trait::Alphabet<const char *>::copy(buffer));
+            const char *name(variable_terminal_map.store(buffer));
             terminal_map.append(std::make_pair(
                 mpl::Static<alphabet_type>::VALUE,
                 name
@@ -493,20 +608,18 @@ namespace fltl {
 
             assert(is_valid_symbol_name(name));
 
-            typename named_variable_map_type::iterator loc(
-                named_variable_map.find(name)
-            );
+            cfg::internal_sym_type id(0);
 
             // no variable with this name
-            if(named_variable_map.end() == loc) {
+            if(!named_variable_map.find(name, id)) {
                 variable_type var(add_variable());
 
-                const char *name_copy(trait::Alphabet<
-                    const char *
-                >::copy(name));
+                const char *name_copy(named_variable_map.insert(
+                    name,
+                    var.value
+                ));
 
                 get_variable(var)->name = name_copy;
-                named_variable_map[name_copy] = var;
 
                 // check if it's an upper bound
                 if('$' == *name) {
@@ -517,7 +630,7 @@ namespace fltl {
 
                 return var;
             } else {
-                return (*loc).second;
+                return variable_type(id);
             }
         }
 
@@ -529,7 +642,13 @@ namespace fltl {
             cfg::internal_sym_type var_id(1);
 
             if(0 == var) {
-                var = variable_allocator->allocate();
+                if(0 != arena) {
+                    var = arena->make<cfg::Variable<AlphaT> >();
+                    var->arena = arena;
+                } else {
+                    var = variable_allocator.allocate();
+                }
+
                 var->name = 0;
                 var_id = next_variable_id;
                 ++next_variable_id;
@@ -620,7 +739,9 @@ namespace fltl {
             }
 
             // clear out this var's info
+            var->clear_production_set();
             var->first_production = 0;
+            var->last_production = 0;
             var->num_productions = 0;
             var->prev = 0;
 
@@ -631,6 +752,12 @@ namespace fltl {
             variable_map.set(static_cast<unsigned>(var->id), 0);
 
             --num_variables_;
+
+            for(cfg::Listener<AlphaT> *listener(first_listener);
+                0 != listener;
+                listener = listener->next_listener) {
+                listener->on_remove_variable(_var);
+            }
         }
 
         /// remove a variable and all productions in the grammar that
@@ -681,29 +808,38 @@ namespace fltl {
 
         /// does this grammar have this particular terminal?
         bool has_terminal(const alphabet_type term) const throw() {
-            return 0 != terminal_map_inv.count(term);
+            cfg::internal_sym_type term_id(0);
+            return terminal_map_inv.find(term, term_id);
+        }
+
+        /// look up the terminal reference for a particular terminal without
+        /// adding it to the grammar. returns false if the grammar doesn't
+        /// have the terminal.
+        bool find_terminal(
+            const alphabet_type term,
+            terminal_type &out
+        ) const throw() {
+            cfg::internal_sym_type term_id(0);
+            if(!terminal_map_inv.find(term, term_id)) {
+                return false;
+            }
+
+            out = terminal_type(term_id);
+            return true;
         }
 
         /// get the terminal reference for a particular terminal.
         const terminal_type get_terminal(const alphabet_type term) throw() {
-            typename terminal_map_inv_type::iterator pos(
-                terminal_map_inv.find(term)
-            );
-            cfg::internal_sym_type term_id;
+            cfg::internal_sym_type term_id(0);
 
             // add in the terminal
-            if(terminal_map_inv.end() == pos) {
+            if(!terminal_map_inv.find(term, term_id)) {
                 term_id = next_terminal_id;
                 --next_terminal_id;
-                alphabet_type copy(traits_type::copy(term));
+                alphabet_type copy(terminal_map_inv.insert(term, term_id));
                 terminal_map.append(std::make_pair<alphabet_type,const char *>(
                     copy, 0
                 ));
-                terminal_map_inv[copy] = term_id;
-
-            // return the terminal
-            } else {
-                term_id = (*pos).second;
             }
 
             return terminal_type(term_id);
@@ -756,7 +892,7 @@ namespace fltl {
             // make the new name
             char buffer[1024] = {'\0'};
             sprintf(buffer, "$%lu", prev_ub + 1);
-            const char *name(trait::Alphabet<const char *>::copy(buffer));
+            const char *name(named_variable_map.store(buffer));
 
             var->name = name;
             auto_symbol_upper_bound = name;
@@ -769,88 +905,15 @@ namespace fltl {
             const variable_type _var,
             symbol_string_type str
         ) throw() {
+            bool is_new(true);
+            cfg::Production<AlphaT> *prod(insert_production(
+                get_variable(_var),
+                str,
+                is_new
+            ));
 
-            cfg::Variable<AlphaT> *var(get_variable(_var));
-            cfg::Production<AlphaT> *prod(production_allocator->allocate());
-
-            prod->var = var;
-            prod->symbols.assign(str);
-
-            ++num_productions_;
-            ++(var->num_productions);
-
-            // if we have a no productions then add this production in
-            if(0 == var->first_production) {
-
-                prod->next = 0;
-                var->first_production = prod;
-                cfg::Production<AlphaT>::hold(prod);
-
-            // no null production; go look for equivalent productions to
-            // make sure we don't add a duplicate
-            } else {
-
-                cfg::Production<AlphaT> *related_prod(var->first_production);
-                cfg::Production<AlphaT> *prev_prod(0);
-
-                // make sure the production is unique
-                for(; 0 != related_prod;
-                    prev_prod = related_prod,
-                    related_prod = related_prod->next) {
-
-                    // we've found our insertion point
-                    if(prod->is_less_than(*related_prod)) {
-
-                        prod->next = related_prod;
-                        prod->prev = related_prod->prev;
-                        related_prod->prev = prod;
-
-                        if(0 == prod->prev) {
-                            var->first_production = prod;
-                        } else {
-                            prod->prev->next = prod;
-                        }
-
-                        cfg::Production<AlphaT>::hold(prod);
-                        goto done;
-
-                    // insertion sort by hash value
-                    } else if(prod->is_greater_than(*related_prod)) {
-                        continue;
-
-                    // possible duplicate found
-                    } else if(related_prod->is_equivalent_to(*prod)) {
-
-                        if(related_prod->is_deleted) {
-                            related_prod->is_deleted = false;
-                            cfg::Production<AlphaT>::hold(related_prod);
-                        } else {
-                            --num_productions_;
-                            --(var->num_productions);
-                        }
-
-                        production_allocator->deallocate(prod);
-                        prod = related_prod;
-                        goto done;
-                    }
-                }
-
-                // add to the end of the list
-
-                assert(0 != prev_prod);
-                prev_prod->next = prod;
-                prod->prev = prev_prod;
-                prod->next = 0;
-                cfg::Production<AlphaT>::hold(prod);
-            }
-
-        done:
-
-            if(0 == first_production
-            || first_production->var->id > var->id
-            || (first_production->var->id == var->id
-                && prod->is_less_than(*first_production))) {
-                first_production = prod;
+            if(is_new) {
+                notify_add_production(prod);
             }
 
             return production_type(prod);
@@ -913,6 +976,12 @@ namespace fltl {
             --(var->num_productions);
 
             cfg::Production<AlphaT>::release(prod);
+
+            for(cfg::Listener<AlphaT> *listener(first_listener);
+                0 != listener;
+                listener = listener->next_listener) {
+                listener->on_remove_production(_prod);
+            }
         }
 
 
@@ -1107,6 +1176,97 @@ namespace fltl {
             return next;
         }
 
+        /// tell the listeners about a production that was added
+        void notify_add_production(cfg::Production<AlphaT> *prod) throw() {
+            const production_type ret(prod);
+            for(cfg::Listener<AlphaT> *listener(first_listener);
+                0 != listener;
+                listener = listener->next_listener) {
+                listener->on_add_production(ret);
+            }
+        }
+
+        /// add a production to a variable, or revive a deleted production
+        /// with the same symbols, without telling the listeners. is_new
+        /// is set to false if the production was already in the grammar.
+        cfg::Production<AlphaT> *insert_production(
+            cfg::Variable<AlphaT> *var,
+            const symbol_string_type &str,
+            bool &is_new
+        ) throw() {
+
+            // look for an equivalent production (possibly one that has
+            // been deleted but is still referenced) so that we don't add
+            // a duplicate
+            cfg::Production<AlphaT> *prod(var->find_production(str));
+            is_new = true;
+
+            if(0 != prod) {
+                is_new = prod->is_deleted;
+
+                if(prod->is_deleted) {
+                    prod->is_deleted = false;
+                    cfg::Production<AlphaT>::hold(prod);
+                    ++num_productions_;
+                    ++(var->num_productions);
+
+                    // the revived production might come before the
+                    // current first production of this variable
+                    if(0 != first_production
+                    && first_production->var == var) {
+                        set_next_production(var->id);
+                    }
+                }
+
+                goto done;
+            }
+
+            // productions in an arena have no allocator, and their symbols
+            // are copied into the arena. other productions share symbols
+            // with the string, unless the string's symbols are in an arena.
+            if(0 != arena) {
+                prod = arena->make<cfg::Production<AlphaT> >();
+                prod->symbols.symbols = symbol_string_type::pin(str, *arena);
+            } else {
+                prod = production_allocator->allocate();
+                prod->allocator = production_allocator;
+
+                if(symbol_string_type::is_pinned(str.symbols)) {
+                    prod->symbols.copy(str);
+                } else {
+                    prod->symbols.assign(str);
+                }
+            }
+
+            prod->var = var;
+
+            ++num_productions_;
+            ++(var->num_productions);
+
+            // add the production to the end of the variable's list
+            prod->next = 0;
+            prod->prev = var->last_production;
+
+            if(0 == var->last_production) {
+                var->first_production = prod;
+            } else {
+                var->last_production->next = prod;
+            }
+
+            var->last_production = prod;
+            var->index_production(prod);
+            cfg::Production<AlphaT>::hold(prod);
+
+        done:
+
+            if(0 == first_production
+            || first_production->var->id > var->id) {
+                first_production = prod;
+            }
+
+            return prod;
+        }
+
         /// go find and set the next production
         void set_next_production(const cfg::internal_sym_type id) throw() {
             cfg::Production<AlphaT> *next(0);
@@ -1179,17 +1339,6 @@ namespace fltl {
         }
 
     };
-
-    // initialize the static variables
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        cfg::Variable<AlphaT>
-    > > CFG<AlphaT>::variable_allocator;
-
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        cfg::Production<AlphaT>
-    > > CFG<AlphaT>::production_allocator(CFG<AlphaT>::variable_allocator);
 }
 
 #include "fltl/include/cfg/ProductionBuilder.hpp"
@@ -1200,5 +1349,7 @@ namespace fltl {
 #include "fltl/include/cfg/Generator.hpp"
 #include "fltl/include/cfg/Pattern.hpp"
 #include "fltl/include/cfg/OpaquePattern.hpp"
+#include "fltl/include/cfg/Listener.hpp"
+#include "fltl/include/cfg/BulkLoader.hpp"
 
 #endif /* FLTL_LIB_CONTEXTFREEGRAMMAR_HPP_ */
@@ -0,0 +1,293 @@
+/*
+ * CompiledDFA.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_COMPILEDDFA_HPP_
+#define FLTL_COMPILEDDFA_HPP_
+
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/NFA.hpp"
+
+#include "fltl/include/nfa/SymbolByte.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace fltl {
+
+    /// a DFA over bytes, compiled into a form that is fast to run. bytes
+    /// that no state of the DFA can tell apart are put into the same
+    /// equivalence class, and the transitions are stored in a dense
+    /// (states + 1) x classes table, where the extra state is a dead state
+    /// that every missing transition goes to. the entries of the table are
+    /// the offsets of the rows of the next states, so running the DFA is
+    /// two table loads per byte and no branches.
+    ///
+    /// the states of the compiled DFA have the same numbers as the states
+    /// of the DFA that it was compiled from.
+    template <typename AlphaT>
+    class CompiledDFA : private trait::Uncopyable {
+    public:
+
+        enum {
+            NUM_BYTES = 256
+        };
+
+    private:
+
+        typedef NFA<AlphaT> nfa_type;
+        typedef typename nfa_type::state_type state_type;
+        typedef typename nfa_type::transition_type transition_type;
+        typedef typename nfa_type::generator_type generator_type;
+
+        unsigned num_states_;
+        unsigned num_classes_;
+
+        /// row offset of the start state
+        unsigned start;
+
+        unsigned char byte_class[NUM_BYTES];
+
+        /// next[row + c] is the row offset of the next state
+        unsigned *next;
+
+        /// is_accept[state]
+        bool *is_accept;
+
+        void clear(void) throw() {
+            if(0 != next) {
+                delete [] next;
+            }
+
+            if(0 != is_accept) {
+                delete [] is_accept;
+            }
+
+            next = 0;
+            is_accept = 0;
+            num_states_ = 0;
+            num_classes_ = 0;
+            start = 0;
+            memset(byte_class, 0, sizeof byte_class);
+        }
+
+    public:
+
+        CompiledDFA(void) throw()
+            : trait::Uncopyable()
+            , num_states_(0)
+            , num_classes_(0)
+            , start(0)
+            , next(0)
+            , is_accept(0)
+        {
+            memset(byte_class, 0, sizeof byte_class);
+        }
+
+        ~CompiledDFA(void) throw() {
+            clear();
+        }
+
+        /// compile a DFA whose input symbols each stand for a single byte.
+        /// returns false, and leaves this empty, if the automaton has an
+        /// epsilon transition, two transitions on the same byte from the
+        /// same state, or a symbol that isn't a single byte.
+        bool compile(const nfa_type &dfa) throw() {
+            clear();
+
+            const unsigned num_states(dfa.num_states_capacity());
+
+            // the (byte, sink) pairs of the transitions of each state
+            std::vector<std::vector<std::pair<unsigned char, unsigned> > >
+                moves(num_states);
+
+            transition_type trans;
+            generator_type transitions(dfa.search(~trans));
+            for(; transitions.match_next(); ) {
+                unsigned char byte(0);
+
+                if(dfa.epsilon() == trans.read()
+                || !nfa::symbol_byte(dfa.get_alpha(trans.read()), byte)) {
+                    return false;
+                }
+
+                moves[trans.source().number()].push_back(
+                    std::make_pair(byte, trans.sink().number())
+                );
+            }
+
+            // refine the partition of the bytes by each state in turn:
+            // two bytes stay in the same class only if every state sends
+            // them to the same next state
+            std::vector<unsigned> classes(NUM_BYTES, 0U);
+            std::vector<int> seen(NUM_BYTES, -1);
+            std::map<std::pair<unsigned, unsigned>, unsigned> split;
+            unsigned num_ids(1);
+
+            for(unsigned s(0); s < num_states; ++s) {
+                split.clear();
+
+                for(unsigned i(0); i < moves[s].size(); ++i) {
+                    const unsigned char byte(moves[s][i].first);
+
+                    if(static_cast<int>(s) == seen[byte]) {
+                        return false;
+                    }
+
+                    seen[byte] = static_cast<int>(s);
+
+                    const std::pair<unsigned, unsigned> key(
+                        classes[byte], moves[s][i].second
+                    );
+
+                    typename std::map<
+                        std::pair<unsigned, unsigned>, unsigned
+                    >::iterator it(split.find(key));
+
+                    if(split.end() == it) {
+                        it = split.insert(std::make_pair(key, num_ids++)).first;
+                    }
+
+                    classes[byte] = it->second;
+                }
+            }
+
+            // number the classes densely
+            std::vector<int> dense(num_ids, -1);
+            for(unsigned b(0); b < NUM_BYTES; ++b) {
+                if(0 > dense[classes[b]]) {
+                    dense[classes[b]] = static_cast<int>(num_classes_++);
+                }
+
+                byte_class[b] = static_cast<unsigned char>(dense[classes[b]]);
+            }
+
+            num_states_ = num_states;
+
+            const unsigned dead(num_states * num_classes_);
+            next = new unsigned[(num_states + 1U) * num_classes_];
+            is_accept = new bool[num_states + 1U];
+
+            for(unsigned i(0); i < ((num_states + 1U) * num_classes_); ++i) {
+                next[i] = dead;
+            }
+
+            for(unsigned s(0); s < num_states; ++s) {
+                for(unsigned i(0); i < moves[s].size(); ++i) {
+                    next[(s * num_classes_) + byte_class[moves[s][i].first]] =
+                        moves[s][i].second * num_classes_;
+                }
+            }
+
+            memset(is_accept, 0, sizeof(bool) * (num_states + 1U));
+
+            state_type state;
+            generator_type states(dfa.search(~state));
+            for(; states.match_next(); ) {
+                is_accept[state.number()] = dfa.is_accept_state(state);
+            }
+
+            start = dfa.get_start_state().number() * num_classes_;
+            return true;
+        }
+
+        /// does the DFA accept all of [begin, end)?
+        bool run(const char *begin, const char *end) const throw() {
+            assert(0 != next);
+
+            unsigned row(start);
+            for(; begin < end; ++begin) {
+                row = next[row + byte_class[static_cast<unsigned char>(*begin)]];
+            }
+
+            return is_accept[row / num_classes_];
+        }
+
+        /// find the longest prefix of [begin, end) that the DFA accepts.
+        /// returns the end of the prefix, or 0 if no prefix is accepted.
+        const char *longest_prefix(
+            const char *begin,
+            const char *end
+        ) const throw() {
+            assert(0 != next);
+
+            const unsigned dead(num_states_ * num_classes_);
+            const char *prefix_end(is_accept[start / num_classes_] ? begin : 0);
+
+            unsigned row(start);
+            for(; begin < end; ) {
+                row = next[row + byte_class[static_cast<unsigned char>(*begin++)]];
+
+                if(dead == row) {
+                    break;
+                } else if(is_accept[row / num_classes_]) {
+                    prefix_end = begin;
+                }
+            }
+
+            return prefix_end;
+        }
+
+        /// the number of states, not counting the dead state
+        inline unsigned num_states(void) const throw() {
+            return num_states_;
+        }
+
+        /// the number of equivalence classes of bytes
+        inline unsigned num_classes(void) const throw() {
+            return num_classes_;
+        }
+
+        inline unsigned start_state(void) const throw() {
+            return start / num_classes_;
+        }
+
+        /// the equivalence class of a byte
+        inline unsigned class_of(unsigned char byte) const throw() {
+            return byte_class[byte];
+        }
+
+        /// the next state after reading any byte of a class, or -1 if there
+        /// is no next state
+        inline int next_state(unsigned state, unsigned cls) const throw() {
+            assert(state < num_states_);
+            assert(cls < num_classes_);
+
+            const unsigned row(next[(state * num_classes_) + cls]);
+            if((num_states_ * num_classes_) == row) {
+                return -1;
+            }
+
+            return static_cast<int>(row / num_classes_);
+        }
+
+        inline bool is_accept_state(unsigned state) const throw() {
+            assert(state < num_states_);
+            return is_accept[state];
+        }
+    };
+}
+
+#endif /* FLTL_COMPILEDDFA_HPP_ */
@@ -38,7 +38,9 @@
 
 #include "fltl/include/helper/Array.hpp"
 #include "fltl/include/helper/BlockAllocator.hpp"
-#include "fltl/include/helper/StorageChain.hpp"
+#include "fltl/include/helper/Interner.hpp"
+#include "fltl/include/helper/SharedBlockAllocator.hpp"
+#include "fltl/include/helper/ThreadLocal.hpp"
 #include "fltl/include/helper/UnsafeCast.hpp"
 
 #include "fltl/include/trait/Alphabet.hpp"
@@ -187,30 +189,27 @@ namespace fltl {
         >
         class PatternIsValid;
 
-        typedef std::map<
-            alphabet_type,
-            unsigned,
-            typename traits_type::less_type
-        > symbol_map_inv_type;
+        typedef helper::Interner<alphabet_type, unsigned> symbol_map_inv_type;
 
         /// bijective mapping between external alphabet elements and the
-        /// symbols used to represent those alphabet elements.
+        /// symbols used to represent those alphabet elements. this owns
+        /// the copies of the alphabet elements in the symbol map.
         symbol_map_inv_type symbol_map_inv;
 
         mutable helper::Array<
             std::pair<alphabet_type, const char *>
         > symbol_map;
 
-        typedef std::map<
+        typedef helper::Interner<
             const char *,
-            unsigned,
-            typename trait::Alphabet<const char *>::less_type
+            unsigned
         > named_symbol_map_inv_type;
 
         /// maps states to their names. uniqueness of names is not enforced.
         mutable std::map<unsigned, const char *> state_names;
 
-        /// bijective mapping between the
+        /// bijective mapping between the names of stack symbols and the
+        /// symbols. this owns the names in the symbol map.
         named_symbol_map_inv_type named_symbol_map_inv;
 
         /// represents an adjacency list of all transitions leaving a
@@ -238,13 +237,15 @@ namespace fltl {
         /// the first transition of this PDA
         pda::Transition<AlphaT> *first_transition;
 
-        /// transition allocator
-        static helper::StorageChain<helper::BlockAllocator<
+        /// transition allocator; this is shared with the transitions so
+        /// that they can outlive the PDA
+        helper::SharedBlockAllocator<
             pda::Transition<AlphaT>
-        > > transition_allocator;
+        > *transition_allocator;
 
-        /// pattern allocator
-        static helper::StorageChain<helper::BlockAllocator<
+        /// pattern allocator; patterns aren't tied to a PDA, so each thread
+        /// gets its own allocator
+        static helper::ThreadLocal<helper::BlockAllocator<
             pda::Pattern<AlphaT>
         > > pattern_allocator;
 
@@ -264,6 +265,9 @@ namespace fltl {
             , num_transitions_(0U)
             , final_states()
             , first_transition(0)
+            , transition_allocator(helper::SharedBlockAllocator<
+                pda::Transition<AlphaT>
+              >::create())
             , _()
         {
             static const char * const UB("$0");
@@ -305,15 +309,6 @@ namespace fltl {
                 state_transitions.set(i, 0);
             }
 
-            // clean up symbols
-            for(unsigned i(1); i < next_symbol_id; ++i) {
-                std::pair<alphabet_type, const char *> &pp(
-                    symbol_map.get(i)
-                );
-                traits_type::destroy(pp.first);
-                trait::Alphabet<const char *>::destroy(pp.second);
-            }
-
             // clean up state names
             std::map<unsigned, const char *>::iterator name_it(state_names.begin());
             for(; name_it != state_names.end(); ++name_it) {
@@ -322,29 +317,24 @@ namespace fltl {
             }
 
             state_names.clear();
+
+            transition_allocator->release();
+            transition_allocator = 0;
         }
 
         /// get the symbol representation for an element of the alphabet
         const symbol_type get_alphabet_symbol(const alphabet_type alpha) throw() {
-            typename symbol_map_inv_type::iterator pos(
-                symbol_map_inv.find(alpha)
-            );
             unsigned alpha_id(0);
 
             // add in the terminal
-            if(symbol_map_inv.end() == pos) {
+            if(!symbol_map_inv.find(alpha, alpha_id)) {
 
                 alpha_id = next_symbol_id;
                 ++next_symbol_id;
-                alphabet_type copy(traits_type::copy(alpha));
+                alphabet_type copy(symbol_map_inv.insert(alpha, alpha_id));
                 symbol_map.append(std::make_pair<alphabet_type,const char *>(
                     copy, 0
                 ));
-                symbol_map_inv[copy] = alpha_id;
-
-            // return the terminal
-            } else {
-                alpha_id = (*pos).second;
             }
 
             return symbol_type(alpha_id);
@@ -363,7 +353,7 @@ namespace fltl {
 
             // make the new name
             sprintf(buffer, "$%lu", prev_ub + 1);
-            const char *name(trait::Alphabet<const char *>::copy(buffer));
+            const char *name(named_symbol_map_inv.store(buffer));
             auto_symbol_upper_bound = name;
 
             unsigned alpha_id(next_symbol_id);
@@ -382,18 +372,17 @@ namespace fltl {
             assert(0 != name);
             assert('\0' != *name);
 
-            typename named_symbol_map_inv_type::iterator pos(
-                named_symbol_map_inv.find(name)
-            );
-
             unsigned alpha_id(0);
 
             // need to add it in
-            if(pos == named_symbol_map_inv.end()) {
+            if(!named_symbol_map_inv.find(name, alpha_id)) {
                 alpha_id = next_symbol_id;
                 ++next_symbol_id;
 
-                const char *name_copy(trait::Alphabet<const char *>::copy(name));
+                const char *name_copy(named_symbol_map_inv.insert(
+                    name,
+                    alpha_id
+                ));
 
                 if('$' == *name_copy) {
                     if(0 < strcmp(name, auto_symbol_upper_bound)) {
@@ -401,14 +390,10 @@ namespace fltl {
                     }
                 }
 
-                named_symbol_map_inv[name_copy] = alpha_id;
                 symbol_map.append(std::make_pair(
                     mpl::Static<alphabet_type>::VALUE,
                     name_copy
                 ));
-
-            } else {
-                alpha_id = (*pos).second;
             }
 
             return symbol_type(alpha_id);
@@ -894,6 +879,7 @@ namespace fltl {
             trans->sym_push = push;
             trans->sink_state = sink_state;
             trans->pda = this;
+            trans->allocator = transition_allocator;
 
             pda::Transition<AlphaT> *prev(0);
             pda::Transition<AlphaT> *curr(state_transitions.get(
@@ -911,14 +897,10 @@ namespace fltl {
                 0 != curr;
                 prev = curr, curr = curr->next) {
 
-                // go as far as until we need to add something in
-                if(read > curr->sym_read) {
-                    continue;
-                } else if(pop > curr->sym_pop) {
-                    continue;
-                } else if(push > curr->sym_push) {
-                    continue;
-                } else if(sink_state > curr->sink_state) {
+                // go as far as until we need to add something in. the
+                // transitions must stay in the same order as operator<,
+                // as generators start from the least transition
+                if(*curr < *trans) {
                     continue;
                 }
 
@@ -976,14 +958,9 @@ namespace fltl {
 
     // static initialize
     template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
+    helper::ThreadLocal<helper::BlockAllocator<
         pda::Pattern<AlphaT>
     > > PDA<AlphaT>::pattern_allocator;
-
-    template <typename AlphaT>
-    helper::StorageChain<helper::BlockAllocator<
-        pda::Transition<AlphaT>
-    > > PDA<AlphaT>::transition_allocator(pattern_allocator);
 }
 
 #endif /* FLTL_PDA_HPP_ */
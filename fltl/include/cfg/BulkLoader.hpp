@@ -0,0 +1,187 @@
+/*
+ * BulkLoader.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_BULKLOADER_HPP_
+#define FLTL_CFG_BULKLOADER_HPP_
+
+namespace fltl { namespace cfg {
+
+    /// adds many productions to a grammar at once. productions are
+    /// buffered as they are added, and then committed to the grammar one
+    /// variable at a time: each variable's production set is sized once
+    /// for all of its new productions, and the productions are then
+    /// de-duplicated and linked in to the end of the variable's list in
+    /// the order that they were added. this makes the result the same as
+    /// calling CFG::add_production for each production, except that the
+    /// listeners of the grammar are told about the new productions grouped
+    /// by variable. pending productions are committed when the loader is
+    /// destroyed.
+    template <typename AlphaT>
+    class BulkLoader : private trait::Uncopyable {
+    private:
+
+        typedef Symbol<AlphaT> symbol_type;
+        typedef SymbolString<AlphaT> symbol_string_type;
+        typedef ProductionBuilder<AlphaT> symbol_buffer_type;
+        typedef VariableSymbol<AlphaT> variable_type;
+
+        /// a production that has not yet been committed; its symbols are
+        /// a slice of the loader's symbol buffer
+        struct PendingProduction {
+        public:
+            Variable<AlphaT> *var;
+            unsigned first_symbol;
+            unsigned length;
+        };
+
+        CFG<AlphaT> &cfg;
+
+        std::vector<PendingProduction> pending;
+        std::vector<symbol_type> symbols;
+
+        inline void add(
+            const variable_type _var,
+            const unsigned first_symbol
+        ) throw() {
+            PendingProduction prod;
+            prod.var = cfg.get_variable(_var);
+            prod.first_symbol = first_symbol;
+            prod.length = static_cast<unsigned>(symbols.size()) - first_symbol;
+            pending.push_back(prod);
+        }
+
+    public:
+
+        explicit BulkLoader(CFG<AlphaT> &cfg_) throw()
+            : trait::Uncopyable()
+            , cfg(cfg_)
+            , pending()
+            , symbols()
+        { }
+
+        ~BulkLoader(void) throw() {
+            commit();
+        }
+
+        /// make room for some number of productions having some total
+        /// number of symbols
+        void reserve(
+            const unsigned num_productions,
+            const unsigned num_symbols
+        ) throw() {
+            pending.reserve(num_productions);
+            symbols.reserve(num_symbols);
+        }
+
+        /// the number of productions waiting to be committed
+        inline unsigned size(void) const throw() {
+            return static_cast<unsigned>(pending.size());
+        }
+
+        /// buffer a production from a production builder
+        void add_production(
+            const variable_type _var,
+            symbol_buffer_type &builder
+        ) throw() {
+            const unsigned first_symbol(static_cast<unsigned>(symbols.size()));
+            for(unsigned i(0); i < builder.size(); ++i) {
+                symbols.push_back(builder.symbol_at(i));
+            }
+            add(_var, first_symbol);
+        }
+
+        /// buffer a production from a symbol string
+        void add_production(
+            const variable_type _var,
+            const symbol_string_type &str
+        ) throw() {
+            const unsigned first_symbol(static_cast<unsigned>(symbols.size()));
+            for(unsigned i(0); i < str.length(); ++i) {
+                symbols.push_back(str.at(i));
+            }
+            add(_var, first_symbol);
+        }
+
+        /// add every buffered production to the grammar
+        void commit(void) throw() {
+            const unsigned num_pending(static_cast<unsigned>(pending.size()));
+            if(0 == num_pending) {
+                return;
+            }
+
+            // bucket the pending productions by variable, keeping the
+            // productions of each variable in the order they were added
+            std::vector<unsigned> offsets(cfg.num_variables_capacity() + 1U, 0U);
+            for(unsigned i(0); i < num_pending; ++i) {
+                ++(offsets[static_cast<unsigned>(pending[i].var->id) + 1U]);
+            }
+
+            for(unsigned v(1); v < offsets.size(); ++v) {
+                offsets[v] += offsets[v - 1U];
+            }
+
+            std::vector<unsigned> order(num_pending);
+            {
+                std::vector<unsigned> next(offsets);
+                for(unsigned i(0); i < num_pending; ++i) {
+                    const unsigned v(static_cast<unsigned>(pending[i].var->id));
+                    order[next[v]++] = i;
+                }
+            }
+
+            const bool has_listeners(0 != cfg.first_listener);
+
+            for(unsigned v(1); v + 1U < offsets.size(); ++v) {
+                const unsigned begin(offsets[v]);
+                const unsigned end(offsets[v + 1U]);
+                if(begin == end) {
+                    continue;
+                }
+
+                Variable<AlphaT> *var(pending[order[begin]].var);
+                var->reserve_production_set(end - begin);
+
+                for(unsigned i(begin); i < end; ++i) {
+                    const PendingProduction &prod(pending[order[i]]);
+                    const symbol_string_type str(
+                        0 == prod.length ? 0 : &(symbols[prod.first_symbol]),
+                        prod.length
+                    );
+
+                    bool is_new(true);
+                    Production<AlphaT> *added(
+                        cfg.insert_production(var, str, is_new)
+                    );
+
+                    if(is_new && has_listeners) {
+                        cfg.notify_add_production(added);
+                    }
+                }
+            }
+
+            pending.clear();
+            symbols.clear();
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_BULKLOADER_HPP_ */
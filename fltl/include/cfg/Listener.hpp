@@ -0,0 +1,77 @@
+/*
+ * Listener.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_LISTENER_HPP_
+#define FLTL_CFG_LISTENER_HPP_
+
+namespace fltl { namespace cfg {
+
+    /// an object that is told about changes to a grammar, e.g. a cache of
+    /// some analysis of the grammar. a listener is attached to a grammar
+    /// with CFG::add_listener, and is detached from it when either the
+    /// listener or the grammar is destroyed.
+    template <typename AlphaT>
+    class Listener : private trait::Uncopyable {
+    private:
+
+        friend class CFG<AlphaT>;
+
+        /// the grammar that this listener is attached to, and its
+        /// neighbours in that grammar's list of listeners
+        CFG<AlphaT> *listened_cfg;
+        Listener<AlphaT> *prev_listener;
+        Listener<AlphaT> *next_listener;
+
+    public:
+
+        typedef typename CFG<AlphaT>::variable_type variable_type;
+        typedef typename CFG<AlphaT>::production_type production_type;
+
+        Listener(void) throw()
+            : trait::Uncopyable()
+            , listened_cfg(0)
+            , prev_listener(0)
+            , next_listener(0)
+        { }
+
+        virtual ~Listener(void) throw() {
+            if(0 != listened_cfg) {
+                listened_cfg->remove_listener(this);
+            }
+        }
+
+        /// a production was added to the grammar, or a previously removed
+        /// production was added back. this is not called when adding a
+        /// production that is already in the grammar.
+        virtual void on_add_production(const production_type &) throw() { }
+
+        /// a production was removed from the grammar
+        virtual void on_remove_production(const production_type &) throw() { }
+
+        /// a variable, along with all of its productions, was removed from
+        /// the grammar. the productions of the variable are not reported
+        /// individually.
+        virtual void on_remove_variable(const variable_type) throw() { }
+    };
+}}
+
+#endif /* FLTL_CFG_LISTENER_HPP_ */
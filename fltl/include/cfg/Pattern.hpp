@@ -1042,8 +1042,11 @@ namespace fltl { namespace cfg {
             /// slots holding pointers back to pattern data
             detail::Slot<AlphaT> slots[NUM_SLOTS];
 
-            /// allocator for patterns
-            static helper::BlockAllocator<self_type, 8U> pattern_allocator;
+            /// allocator for patterns; patterns aren't tied to a grammar,
+            /// so each thread gets its own allocator.
+            static helper::ThreadLocal<
+                helper::BlockAllocator<self_type, 8U>
+            > pattern_allocator;
 
         public:
 
@@ -1094,19 +1097,19 @@ namespace fltl { namespace cfg {
         public:
 
             static self_type *allocate(variable_type *_var) throw() {
-                self_type *self(pattern_allocator.allocate());
+                self_type *self(pattern_allocator->allocate());
                 self->var = _var;
                 return self;
             }
 
             static self_type *allocate(Unbound<AlphaT, variable_tag> *_var) throw() {
-                self_type *self(pattern_allocator.allocate());
+                self_type *self(pattern_allocator->allocate());
                 self->var = _var->symbol;
                 return self;
             }
 
             static self_type *allocate(AnySymbol<AlphaT> *) throw() {
-                return pattern_allocator.allocate();
+                return pattern_allocator->allocate();
             }
 
             static void incref(self_type *self) throw() {
@@ -1115,17 +1118,16 @@ namespace fltl { namespace cfg {
 
             static void decref(PatternData<AlphaT> *self) throw() {
                 if(0 == --(self->ref_count)) {
-                    pattern_allocator.deallocate(self);
+                    pattern_allocator->deallocate(self);
                 }
             }
         };
 
-        /// static allocator for patterns
         template <typename AlphaT>
-        helper::BlockAllocator<
+        helper::ThreadLocal<helper::BlockAllocator<
             PatternData<AlphaT>,
             8U
-        > PatternData<AlphaT>::pattern_allocator;
+        > > PatternData<AlphaT>::pattern_allocator;
     }
 
     template <typename AlphaT, typename VarTagT>
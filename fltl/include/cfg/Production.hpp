@@ -71,6 +71,9 @@ namespace fltl { namespace cfg {
         /// was this production deleted?
         bool is_deleted;
 
+        /// the allocator of the grammar that made this production
+        helper::SharedBlockAllocator<self_type> *allocator;
+
         /// get the number of symbols in this production
         inline unsigned length(void) const throw() {
             return symbols.length();
@@ -126,12 +129,25 @@ namespace fltl { namespace cfg {
                     if(0 != prod->next->var) {
                         prod->next->prev = prod->prev;
                     }
+
+                } else if(0 != prod->var) {
+                    prod->var->last_production = prod->prev;
+                }
+
+                if(0 != prod->var) {
+                    prod->var->unindex_production(prod);
                 }
 
                 prod->next = 0;
                 prod->prev = 0;
                 prod->symbols.clear();
-                CFG<AlphaT>::production_allocator->deallocate(prod);
+
+                // productions of a grammar in an arena are freed by the
+                // arena
+                if(0 != prod->allocator) {
+                    prod->allocator->deallocate(prod);
+                }
+
                 prod = 0;
             }
         }
@@ -172,6 +188,7 @@ namespace fltl { namespace cfg {
             , symbols()
             , ref_count(0)
             , is_deleted(false)
+            , allocator(0)
         { }
 
         Production(const self_type &) throw()
@@ -181,6 +198,7 @@ namespace fltl { namespace cfg {
             , symbols()
             , ref_count(0)
             , is_deleted(false)
+            , allocator(0)
         {
             assert(false);
         }
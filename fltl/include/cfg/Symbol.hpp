@@ -171,7 +171,8 @@ namespace fltl { namespace cfg {
                 ret.symbols[str::HASH].value = (
                     symbol_string_type::hash(
                         hash(),
-                        that.hash()
+                        that.hash(),
+                        1U
                     )
                 );
             }
@@ -343,7 +344,8 @@ namespace fltl { namespace mpl {
                 ret.symbols[cfg::str::HASH].value = (
                     return_type::hash(
                         self->hash(),
-                        that.hash()
+                        that.hash(),
+                        1U
                     )
                 );
             }
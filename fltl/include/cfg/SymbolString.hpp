@@ -89,24 +89,22 @@ namespace fltl { namespace cfg {
             { }
         };
 
-        /// static allocator for symbol arrays
+        /// allocator for symbol arrays. symbol strings aren't tied to a
+        /// grammar, so each thread gets its own allocator.
         template <typename AlphaT, const unsigned num_symbols>
         class SymbolStringAllocator {
         public:
-            static helper::StorageChain<helper::BlockAllocator<
+            static helper::ThreadLocal<helper::BlockAllocator<
                 SymbolArray<AlphaT, num_symbols>,
                 FLTL_SYMBOL_STRING_ALLOC_LIST_SIZE
             > > allocator;
         };
 
-        /// static initialize the symbol array's allocator
         template <typename AlphaT, const unsigned num_symbols>
-        helper::StorageChain<helper::BlockAllocator<
+        helper::ThreadLocal<helper::BlockAllocator<
             SymbolArray<AlphaT, num_symbols>,
             FLTL_SYMBOL_STRING_ALLOC_LIST_SIZE
-        > > SymbolStringAllocator<AlphaT, num_symbols>::allocator(
-            CFG<AlphaT>::production_allocator
-        );
+        > > SymbolStringAllocator<AlphaT, num_symbols>::allocator;
 
         /// symbol array of size zero, i.e. flexible symbol array
         template <typename AlphaT>
@@ -146,6 +144,7 @@ namespace fltl { namespace cfg {
         friend class Production<AlphaT>;
         friend class OpaqueProduction<AlphaT>;
         friend class ProductionBuilder<AlphaT>;
+        friend class BulkLoader<AlphaT>;
         friend class detail::PatternData<AlphaT>;
 
         template <typename, typename> friend class Unbound;
@@ -245,6 +244,35 @@ namespace fltl { namespace cfg {
             }
         }
 
+        enum {
+            /// the reference count of a symbol array that is pinned in an
+            /// arena; it can never drop to zero, so the array is never
+            /// given back to the symbol array allocators
+            PINNED_REF_COUNT = 1 << 30
+        };
+
+        /// is a symbol array owned by an arena?
+        inline static bool is_pinned(const symbol_type *syms) throw() {
+            return 0 != syms
+                && PINNED_REF_COUNT <= syms[str::REF_COUNT].value;
+        }
+
+        /// copy the symbols of a string into an arena
+        static symbol_type *
+        pin(const self_type &that, helper::Arena &arena) throw() {
+            if(0 == that.symbols) {
+                return 0;
+            }
+
+            const unsigned len(str::FIRST_SYMBOL + that.length());
+            symbol_type *syms(arena.make_array<symbol_type>(len));
+
+            memcpy(syms, that.symbols, len * sizeof(symbol_type));
+            syms[str::REF_COUNT].value = PINNED_REF_COUNT;
+
+            return syms;
+        }
+
         /// append a symbol onto the end of this string
         inline self_type append_symbol(const symbol_type *sym) const throw() {
             if(0 == sym->value) {
@@ -266,7 +294,8 @@ namespace fltl { namespace cfg {
 
                 ret.symbols[str::HASH].value = hash(
                     symbols[str::HASH].value,
-                    sym->hash()
+                    sym->hash(),
+                    1U
                 );
             } else {
                 ret.symbols[str::HASH].value = sym->hash();
@@ -295,8 +324,9 @@ namespace fltl { namespace cfg {
                 );
 
                 ret.symbols[str::HASH].value = hash(
+                    sym->hash(),
                     symbols[str::HASH].value,
-                    sym->hash()
+                    len
                 );
             } else {
                 ret.symbols[str::HASH].value = sym->hash();
@@ -305,26 +335,36 @@ namespace fltl { namespace cfg {
             return ret;
         }
 
-        /// very simple associative, commutative hash function
+        /// multiplier of the polynomial string hash
+        static const uint32_t HASH_MULTIPLIER = 0x9E3779B1U;
+
+        /// HASH_MULTIPLIER raised to some power, modulo 2^32
+        FLTL_FORCE_INLINE static uint32_t hash_power(unsigned exp) throw() {
+            uint32_t result(1U);
+            uint32_t base(HASH_MULTIPLIER);
+            for(; 0U != exp; exp >>= 1U) {
+                if(0U != (exp & 1U)) {
+                    result *= base;
+                }
+                base *= base;
+            }
+            return result;
+        }
+
+        /// order-sensitive polynomial hash of symbol strings. The hash of a
+        /// string s_1 ... s_n is the sum of mix32(s_i) * M^(n - i), modulo
+        /// 2^32, so that the hash of a single symbol is the hash of that
+        /// symbol, and the hash of a concatenation x y can be computed from
+        /// the hashes of x and y, and the length of y.
         FLTL_FORCE_INLINE static internal_sym_type hash(
             const internal_sym_type a,
-            const internal_sym_type b
+            const internal_sym_type b,
+            const unsigned b_length
         ) throw() {
-            return a * b;
-            //return symbol_type::mix32(a * b);
-            //return (a * b) % 3931;
-            /*return symbol_type::mix32(
-            //    ((b & 0xFF0000FF) | (a & 0x00FFFF00)) *
-                ((a & 0x0FFF000F) | (b & 0xF000FFF0))
-            );*/
-        }
-
-        /// get the hash of this symbol
-        FLTL_FORCE_INLINE internal_sym_type get_hash(void) const throw() {
-            if(0 == symbols) {
-                return EPSILON_HASH;
-            }
-            return symbols[str::HASH].value;
+            return static_cast<internal_sym_type>(
+                static_cast<uint32_t>(a) * hash_power(b_length)
+              + static_cast<uint32_t>(b)
+            );
         }
 
         /// hash an array
@@ -337,7 +377,7 @@ namespace fltl { namespace cfg {
                 sym < last;
                 ++sym) {
 
-                ihash = hash(ihash, sym->hash());
+                ihash = hash(ihash, sym->hash(), 1U);
             }
             return ihash;
         }
@@ -377,6 +417,14 @@ namespace fltl { namespace cfg {
             : symbols(0)
         { }
 
+        /// get the hash of this symbol string
+        FLTL_FORCE_INLINE internal_sym_type get_hash(void) const throw() {
+            if(0 == symbols) {
+                return EPSILON_HASH;
+            }
+            return symbols[str::HASH].value;
+        }
+
         /// constructor for a generic symbol -> symbol string
         explicit SymbolString(const symbol_type &sym) throw()
             : symbols(0)
@@ -485,8 +533,8 @@ namespace fltl { namespace cfg {
             ret.symbols = allocate(len + other_len);
             if(0 != ret.symbols) {
 
-                internal_sym_type lhash(1);
-                internal_sym_type rhash(1);
+                internal_sym_type lhash(0);
+                internal_sym_type rhash(0);
 
                 if(0 != len) {
                     memcpy(
@@ -506,7 +554,7 @@ namespace fltl { namespace cfg {
                     rhash = that.symbols[str::HASH].value;
                 }
 
-                ret.symbols[str::HASH].value = hash(lhash, rhash);
+                ret.symbols[str::HASH].value = hash(lhash, rhash, other_len);
             }
 
             return ret;
@@ -592,6 +640,12 @@ namespace fltl { namespace cfg {
                 // actually accessing it
                 &(this_syms[str::LENGTH + this_len])
             )) {
+                // arrays pinned in an arena are never shared, so that
+                // strings outside of the arena can't end up using them
+                if(is_pinned(this_syms) || is_pinned(that_syms)) {
+                    return true;
+                }
+
                 // TODO: this might be overkill
                 if(this_syms[str::REF_COUNT].value
                  < that_syms[str::REF_COUNT].value) {
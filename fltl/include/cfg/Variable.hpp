@@ -40,6 +40,7 @@ namespace fltl { namespace cfg {
         friend class detail::SimpleGenerator<AlphaT>;
         friend class Production<AlphaT>;
         friend class OpaqueProduction<AlphaT>;
+        friend class BulkLoader<AlphaT>;
 
         template <typename, typename>
         friend class detail::PatternGenerator;
@@ -51,17 +52,32 @@ namespace fltl { namespace cfg {
         Variable<AlphaT> *next;
         Variable<AlphaT> *prev;
 
-        /// the first production related to this variable
+        /// the first and last productions related to this variable. new
+        /// productions are appended to the end of the list
         Production<AlphaT> *first_production;
+        Production<AlphaT> *last_production;
+
+        /// open-addressed hash set of every production in the above list
+        /// (including deleted productions that are still referenced),
+        /// keyed on the hash of their symbol strings. this lets the CFG
+        /// detect duplicate productions without walking the list.
+        Production<AlphaT> **production_set;
+        unsigned production_set_capacity;
+        unsigned production_set_used;
 
         /// the number of productions
         unsigned num_productions;
 
         /// the name associated with this variable. if the name is 0 then
         /// an automatic name is generated when the CFG is printed. note:
-        /// the name is *owned* by the variable
+        /// the name is owned by the CFG's name interner
         const char *name;
 
+        /// the arena of the grammar that owns this variable, if any. the
+        /// production set of a variable in an arena is allocated from the
+        /// arena, and so is never freed.
+        helper::Arena *arena;
+
     public:
 
         Variable(void) throw()
@@ -69,8 +85,13 @@ namespace fltl { namespace cfg {
             , next(0)
             , prev(0)
             , first_production(0)
+            , last_production(0)
+            , production_set(0)
+            , production_set_capacity(0)
+            , production_set_used(0)
             , num_productions(0)
             , name(0)
+            , arena(0)
         { }
 
         ~Variable(void) throw() {
@@ -90,13 +111,164 @@ namespace fltl { namespace cfg {
                 }
             }
 
-            if(0 != name) {
-                delete [] name;
+            if(0 != production_set && 0 == arena) {
+                delete [] production_set;
             }
 
+            production_set = 0;
+            production_set_capacity = 0;
+            first_production = 0;
+            last_production = 0;
             name = 0;
             num_productions = 0;
         }
+
+    private:
+
+        /// marker for a slot in the production set whose production has
+        /// been removed. the variable itself can never be a production.
+        inline Production<AlphaT> *removed_production(void) const throw() {
+            return helper::unsafe_cast<Production<AlphaT> *>(
+                const_cast<Variable<AlphaT> *>(this)
+            );
+        }
+
+        /// spread the bits of a symbol string hash over the slot mask
+        inline static unsigned
+        slot_of(const SymbolString<AlphaT> &symbols, unsigned mask) throw() {
+            uint32_t h(static_cast<uint32_t>(symbols.get_hash()));
+            h ^= h >> 16;
+            h *= 0x85EBCA6BU;
+            h ^= h >> 13;
+            return static_cast<unsigned>(h) & mask;
+        }
+
+        /// find a production of this variable whose symbols are equal to
+        /// some symbol string
+        Production<AlphaT> *
+        find_production(const SymbolString<AlphaT> &symbols) const throw() {
+            if(0 == production_set_capacity) {
+                return 0;
+            }
+
+            const unsigned mask(production_set_capacity - 1U);
+            Production<AlphaT> *removed(removed_production());
+
+            for(unsigned i(slot_of(symbols, mask)); ; i = (i + 1U) & mask) {
+                Production<AlphaT> *prod(production_set[i]);
+
+                if(0 == prod) {
+                    return 0;
+                } else if(removed != prod && prod->symbols == symbols) {
+                    return prod;
+                }
+            }
+
+            return 0;
+        }
+
+        /// add a production to the production set; assumes that no
+        /// equivalent production is already in the set
+        void index_production(Production<AlphaT> *prod) throw() {
+
+            // keep the load factor (counting removed slots) below 3/4
+            if(((production_set_used + 1U) * 4U)
+               > (production_set_capacity * 3U)) {
+                resize_production_set(1U);
+            }
+
+            const unsigned mask(production_set_capacity - 1U);
+            Production<AlphaT> *removed(removed_production());
+            unsigned i(slot_of(prod->symbols, mask));
+
+            for(; 0 != production_set[i] && removed != production_set[i];
+                i = (i + 1U) & mask) { }
+
+            if(0 == production_set[i]) {
+                ++production_set_used;
+            }
+
+            production_set[i] = prod;
+        }
+
+        /// remove a production from the production set
+        void unindex_production(Production<AlphaT> *prod) throw() {
+            if(0 == production_set_capacity) {
+                return;
+            }
+
+            const unsigned mask(production_set_capacity - 1U);
+
+            for(unsigned i(slot_of(prod->symbols, mask));
+                0 != production_set[i];
+                i = (i + 1U) & mask) {
+
+                if(prod == production_set[i]) {
+                    production_set[i] = removed_production();
+                    return;
+                }
+            }
+        }
+
+        /// forget every production in the production set
+        void clear_production_set(void) throw() {
+            for(unsigned i(0); i < production_set_capacity; ++i) {
+                production_set[i] = 0;
+            }
+            production_set_used = 0;
+        }
+
+        /// make sure that some number of productions can be added to the
+        /// production set without it being re-hashed
+        void reserve_production_set(const unsigned num_new) throw() {
+            if(((production_set_used + num_new) * 4U)
+               > (production_set_capacity * 3U)) {
+                resize_production_set(num_new);
+            }
+        }
+
+        /// re-hash the production set into a table that is big enough to
+        /// hold the live productions of this variable, plus some number of
+        /// new productions, with room to spare. removed slots are dropped
+        /// in the process.
+        void resize_production_set(const unsigned num_new) throw() {
+            Production<AlphaT> **old_set(production_set);
+            const unsigned old_capacity(production_set_capacity);
+            Production<AlphaT> *removed(removed_production());
+
+            unsigned num_live(0);
+            for(unsigned i(0); i < old_capacity; ++i) {
+                if(0 != old_set[i] && removed != old_set[i]) {
+                    ++num_live;
+                }
+            }
+
+            unsigned capacity(8U);
+            for(; (capacity * 3U) <= ((num_live + num_new) * 8U); ) {
+                capacity *= 2U;
+            }
+
+            if(0 != arena) {
+                production_set = arena->make_array<Production<AlphaT> *>(
+                    capacity
+                );
+            } else {
+                production_set = new Production<AlphaT> *[capacity];
+            }
+
+            production_set_capacity = capacity;
+            clear_production_set();
+
+            for(unsigned i(0); i < old_capacity; ++i) {
+                if(0 != old_set[i] && removed != old_set[i]) {
+                    index_production(old_set[i]);
+                }
+            }
+
+            if(0 != old_set && 0 == arena) {
+                delete [] old_set;
+            }
+        }
     };
 
 }}
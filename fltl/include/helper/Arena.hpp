@@ -0,0 +1,131 @@
+/*
+ * Arena.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_ARENA_HPP_
+#define FLTL_ARENA_HPP_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include "fltl/include/helper/Align.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace fltl { namespace helper {
+
+    /// bump-pointer allocator. objects are carved out of large blocks and
+    /// are never freed individually: all of the memory of an arena is given
+    /// back at once when the arena is destroyed, and the destructors of the
+    /// objects in the arena are never run.
+    class Arena : private trait::Uncopyable {
+    private:
+
+        enum {
+            BLOCK_SIZE = 64U * 1024U,
+            ALIGNMENT = 16U
+        };
+
+        /// each block starts with a pointer to the previous block
+        char *block;
+        char *next_byte;
+        char *end_byte;
+
+        /// total number of bytes in all blocks
+        size_t num_bytes;
+
+        void add_block(size_t min_size) throw() {
+            size_t size(BLOCK_SIZE);
+            if((size - ALIGNMENT) < min_size) {
+                size = min_size + ALIGNMENT;
+            }
+
+            char *new_block(new char[size]);
+            *reinterpret_cast<char **>(new_block) = block;
+
+            block = new_block;
+            next_byte = helper::align<ALIGNMENT>(new_block + sizeof(char *));
+            end_byte = new_block + size;
+            num_bytes += size;
+        }
+
+    public:
+
+        Arena(void) throw()
+            : trait::Uncopyable()
+            , block(0)
+            , next_byte(0)
+            , end_byte(0)
+            , num_bytes(0)
+        { }
+
+        ~Arena(void) throw() {
+            for(char *prev(0); 0 != block; block = prev) {
+                prev = *reinterpret_cast<char **>(block);
+                delete [] block;
+            }
+
+            next_byte = 0;
+            end_byte = 0;
+            num_bytes = 0;
+        }
+
+        /// allocate uninitialized, suitably aligned memory
+        void *allocate(size_t size) throw() {
+            size = (size + (ALIGNMENT - 1U)) & ~static_cast<size_t>(
+                ALIGNMENT - 1U
+            );
+
+            if(static_cast<size_t>(end_byte - next_byte) < size) {
+                add_block(size);
+            }
+
+            void *mem(next_byte);
+            next_byte += size;
+            return mem;
+        }
+
+        /// allocate and default-construct an object
+        template <typename T>
+        T *make(void) throw() {
+            return new (allocate(sizeof(T))) T;
+        }
+
+        /// allocate and default-construct an array of objects
+        template <typename T>
+        T *make_array(size_t num) throw() {
+            assert(0 < num);
+            T *arr(reinterpret_cast<T *>(allocate(num * sizeof(T))));
+            for(size_t i(0); i < num; ++i) {
+                new (arr + i) T;
+            }
+            return arr;
+        }
+
+        /// the number of bytes that this arena has taken from the heap
+        size_t size(void) const throw() {
+            return num_bytes;
+        }
+    };
+}}
+
+#endif /* FLTL_ARENA_HPP_ */
@@ -0,0 +1,256 @@
+/*
+ * BitMatrix.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_HELPER_BITMATRIX_HPP_
+#define FLTL_HELPER_BITMATRIX_HPP_
+
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace fltl { namespace helper {
+
+    /// a dense matrix of bits. each row is a bitset, packed into 64-bit
+    /// words, and all rows are stored back to back in one allocation, so
+    /// that the union of two rows is a single pass over their words.
+    class BitMatrix : private trait::Uncopyable {
+    public:
+
+        typedef uint64_t word_type;
+
+    private:
+
+        enum {
+            WORD_BITS = 64U
+        };
+
+        word_type *words;
+
+        unsigned num_rows_;
+        unsigned num_columns_;
+
+        /// number of words in each row
+        unsigned row_length;
+
+        inline word_type *row(unsigned i) throw() {
+            assert(i < num_rows_);
+            return words + (i * row_length);
+        }
+
+        inline const word_type *row(unsigned i) const throw() {
+            assert(i < num_rows_);
+            return words + (i * row_length);
+        }
+
+        inline static word_type mask_of(unsigned col) throw() {
+            return static_cast<word_type>(1U) << (col % WORD_BITS);
+        }
+
+        /// dest |= src, where both are rows of row_length words. returns
+        /// true if any bit of dest changed.
+        inline bool union_words(
+            word_type *dest,
+            const word_type *src
+        ) const throw() {
+            word_type changed(0);
+            for(unsigned i(0); i < row_length; ++i) {
+                const word_type old_word(dest[i]);
+                const word_type new_word(old_word | src[i]);
+                changed |= old_word ^ new_word;
+                dest[i] = new_word;
+            }
+            return 0 != changed;
+        }
+
+    public:
+
+        BitMatrix(void) throw()
+            : trait::Uncopyable()
+            , words(0)
+            , num_rows_(0)
+            , num_columns_(0)
+            , row_length(0)
+        { }
+
+        BitMatrix(unsigned num_rows, unsigned num_columns) throw()
+            : trait::Uncopyable()
+            , words(0)
+            , num_rows_(0)
+            , num_columns_(0)
+            , row_length(0)
+        {
+            resize(num_rows, num_columns);
+        }
+
+        ~BitMatrix(void) throw() {
+            if(0 != words) {
+                delete [] words;
+            }
+
+            words = 0;
+            num_rows_ = 0;
+            num_columns_ = 0;
+            row_length = 0;
+        }
+
+        /// change the shape of the matrix; this clears every bit.
+        void resize(unsigned num_rows, unsigned num_columns) throw() {
+            const unsigned new_row_length(
+                (num_columns + WORD_BITS - 1U) / WORD_BITS
+            );
+            const unsigned old_size(num_rows_ * row_length);
+            const unsigned new_size(num_rows * new_row_length);
+
+            if(old_size != new_size) {
+                if(0 != words) {
+                    delete [] words;
+                    words = 0;
+                }
+
+                if(0 != new_size) {
+                    words = new word_type[new_size];
+                }
+            }
+
+            num_rows_ = num_rows;
+            num_columns_ = num_columns;
+            row_length = new_row_length;
+
+            clear();
+        }
+
+        /// unset every bit
+        void clear(void) throw() {
+            if(0 != words) {
+                memset(words, 0, sizeof(word_type) * num_rows_ * row_length);
+            }
+        }
+
+        inline unsigned num_rows(void) const throw() {
+            return num_rows_;
+        }
+
+        inline unsigned num_columns(void) const throw() {
+            return num_columns_;
+        }
+
+        /// set a bit; returns true if the bit was not already set.
+        inline bool set(unsigned i, unsigned col) throw() {
+            assert(col < num_columns_);
+            word_type &word(row(i)[col / WORD_BITS]);
+            const word_type mask(mask_of(col));
+            if(0 != (word & mask)) {
+                return false;
+            }
+            word |= mask;
+            return true;
+        }
+
+        inline bool test(unsigned i, unsigned col) const throw() {
+            assert(col < num_columns_);
+            return 0 != (row(i)[col / WORD_BITS] & mask_of(col));
+        }
+
+        /// row dest |= row src; returns true if row dest changed.
+        inline bool union_rows(unsigned dest, unsigned src) throw() {
+            return union_words(row(dest), row(src));
+        }
+
+        /// row dest |= row src of another matrix with the same number of
+        /// columns; returns true if row dest changed.
+        inline bool union_rows(
+            unsigned dest,
+            const BitMatrix &that,
+            unsigned src
+        ) throw() {
+            assert(num_columns_ == that.num_columns_);
+            return union_words(row(dest), that.row(src));
+        }
+
+        /// do row i of this matrix and row j of another matrix with the
+        /// same number of columns have any set columns in common?
+        inline bool intersects(
+            unsigned i,
+            const BitMatrix &that,
+            unsigned j
+        ) const throw() {
+            assert(num_columns_ == that.num_columns_);
+            const word_type *a(row(i));
+            const word_type *b(that.row(j));
+            for(unsigned k(0); k < row_length; ++k) {
+                if(0 != (a[k] & b[k])) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// is every bit of a row unset?
+        inline bool is_empty(unsigned i) const throw() {
+            const word_type *r(row(i));
+            for(unsigned k(0); k < row_length; ++k) {
+                if(0 != r[k]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// row dest = row src
+        inline void copy_row(unsigned dest, unsigned src) throw() {
+            if(dest != src) {
+                memcpy(
+                    row(dest),
+                    row(src),
+                    sizeof(word_type) * row_length
+                );
+            }
+        }
+
+        /// return the first set column of a row at or after col, or
+        /// num_columns() if there is none. whole zero words are skipped.
+        unsigned next(unsigned i, unsigned col) const throw() {
+            const word_type *r(row(i));
+
+            for(; col < num_columns_; ) {
+                const word_type word(r[col / WORD_BITS] >> (col % WORD_BITS));
+
+                if(0 == word) {
+                    col = ((col / WORD_BITS) + 1U) * WORD_BITS;
+                    continue;
+                }
+
+                for(word_type w(word); 0 == (w & 1U); w >>= 1U) {
+                    ++col;
+                }
+
+                break;
+            }
+
+            return col < num_columns_ ? col : num_columns_;
+        }
+    };
+}}
+
+#endif /* FLTL_HELPER_BITMATRIX_HPP_ */
@@ -43,18 +43,31 @@ namespace fltl { namespace helper {
 
     namespace detail {
 
+        /// something with the strictest alignment that an object can need
+        union BlockAllocatorAlignment {
+            void *ptr;
+            long integer;
+            double real;
+            long double long_real;
+        };
+
+        /// the storage of a slot is raw memory: objects are only constructed
+        /// when they are allocated, and destroyed when they are deallocated
         template <typename T>
         struct BlockAllocatorSlot {
         public:
 
             typedef BlockAllocatorSlot<T> self_type;
 
-            T obj;
+            union {
+                char bytes[sizeof(T)];
+                BlockAllocatorAlignment alignment;
+            } storage;
+
             self_type *next;
 
             BlockAllocatorSlot(void)
-                : obj()
-                , next(0)
+                : next(0)
             { }
 
             ~BlockAllocatorSlot() { }
@@ -97,8 +110,9 @@ namespace fltl { namespace helper {
         };
     }
 
-    /// note: - destructors of parameterized type are only called if all
-    ///         allocated objects are deallocated!
+    /// note: - objects are constructed by allocate() and destroyed by
+    ///         deallocate(); destroying the allocator does *not* destroy
+    ///         the objects that are still allocated!
     template <typename T, const unsigned BLOCK_SIZE=256U>
     class BlockAllocator : private trait::Uncopyable {
     private:
@@ -146,10 +160,10 @@ namespace fltl { namespace helper {
                 free_list = &(block_list->slots[0]);
             }
 
-            slot_type *obj(free_list);
-            free_list = obj->next;
+            slot_type *slot(free_list);
+            free_list = slot->next;
 
-            return &(obj->obj);
+            return new (&(slot->storage)) T;
 #else
             return new T;
 #endif
@@ -157,24 +171,10 @@ namespace fltl { namespace helper {
 
         inline void deallocate(T *ptr) throw() {
 #if FLTL_USE_BLOCK_ALLOCATOR
-            // destroy and re-instantiate
             ptr->~T();
-            new (ptr) T;
 
-            const ptrdiff_t diff(
-                reinterpret_cast<char *>(&(block_list->slots[0].obj)) -
-                reinterpret_cast<char *>(&(block_list->slots[0]))
-            );
-
-            slot_type *new_head(0);
-
-            if(diff > 0) {
-                new_head = helper::unsafe_cast<slot_type *>(
-                    reinterpret_cast<char *>(ptr) - diff
-                );
-            } else {
-                new_head = helper::unsafe_cast<slot_type *>(ptr);
-            }
+            // the storage is the first thing in a slot
+            slot_type *new_head(helper::unsafe_cast<slot_type *>(ptr));
 
             new_head->next = free_list;
             free_list = new_head;
@@ -0,0 +1,290 @@
+/*
+ * Interner.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_HELPER_INTERNER_HPP_
+#define FLTL_HELPER_INTERNER_HPP_
+
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+#include "fltl/include/helper/Array.hpp"
+
+#include "fltl/include/trait/Alphabet.hpp"
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace fltl { namespace helper {
+
+    namespace detail {
+
+        /// owns the copies of the keys of an interner. the generic version
+        /// copies keys through their alphabet traits and destroys all of
+        /// them when the arena is destroyed.
+        template <typename T>
+        class InternArena : private trait::Uncopyable {
+        private:
+
+            typedef trait::Alphabet<T> traits_type;
+
+            Array<T> copies;
+
+        public:
+
+            InternArena(void) throw()
+                : trait::Uncopyable()
+                , copies(32U)
+            { }
+
+            ~InternArena(void) throw() {
+                for(unsigned i(0); i < copies.size(); ++i) {
+                    traits_type::destroy(copies.get(i));
+                }
+            }
+
+            const T copy(const T &that) throw() {
+                copies.append(traits_type::copy(that));
+                return copies.back();
+            }
+        };
+
+        /// cstrings are bump-allocated out of large blocks of characters
+        /// so that interning a name is one memcpy, and so that all names
+        /// are freed at once.
+        template <>
+        class InternArena<const char *> : private trait::Uncopyable {
+        private:
+
+            enum {
+                BLOCK_SIZE = 4096U
+            };
+
+            /// each block starts with a pointer to the previous block
+            char *block;
+            char *next_char;
+            char *end_char;
+
+            void add_block(size_t min_size) throw() {
+                size_t size(BLOCK_SIZE);
+                if((size - sizeof(char *)) < min_size) {
+                    size = min_size + sizeof(char *);
+                }
+
+                char *new_block(new char[size]);
+                memcpy(new_block, &block, sizeof(char *));
+
+                block = new_block;
+                next_char = new_block + sizeof(char *);
+                end_char = new_block + size;
+            }
+
+        public:
+
+            InternArena(void) throw()
+                : trait::Uncopyable()
+                , block(0)
+                , next_char(0)
+                , end_char(0)
+            { }
+
+            ~InternArena(void) throw() {
+                for(char *prev(0); 0 != block; block = prev) {
+                    memcpy(&prev, block, sizeof(char *));
+                    delete [] block;
+                }
+
+                next_char = 0;
+                end_char = 0;
+            }
+
+            const char *copy(const char *that) throw() {
+                const size_t len(strlen(that) + 1U);
+
+                if(static_cast<size_t>(end_char - next_char) < len) {
+                    add_block(len);
+                }
+
+                char *cpy(next_char);
+                memcpy(cpy, that, len);
+                next_char += len;
+
+                return cpy;
+            }
+        };
+    }
+
+    /// open-addressed hash table that maps elements of an alphabet to ids.
+    /// the interner owns the copies of its keys, so the keys that it hands
+    /// back have stable addresses for as long as the interner lives.
+    ///
+    /// Assumptions:
+    ///     - the alphabet traits of T define hash() and equal().
+    ///     - V is default constructible and copy assignable.
+    template <typename T, typename V>
+    class Interner : private trait::Uncopyable {
+    private:
+
+        typedef trait::Alphabet<T> traits_type;
+
+        struct Slot {
+        public:
+            T key;
+            V value;
+            uint32_t hash;
+            bool is_used;
+
+            Slot(void) throw()
+                : key()
+                , value()
+                , hash(0)
+                , is_used(false)
+            { }
+        };
+
+        detail::InternArena<T> arena;
+
+        Slot *slots;
+        unsigned capacity;
+        unsigned num_keys;
+
+        /// spread the bits of a key hash over the slot mask
+        inline static unsigned slot_of(uint32_t h, unsigned mask) throw() {
+            h ^= h >> 16;
+            h *= 0x85EBCA6BU;
+            h ^= h >> 13;
+            return static_cast<unsigned>(h) & mask;
+        }
+
+        /// double the number of slots and re-hash every key
+        void grow(void) throw() {
+            Slot *old_slots(slots);
+            const unsigned old_capacity(capacity);
+
+            capacity = 0U == capacity ? 16U : capacity * 2U;
+            slots = new Slot[capacity];
+
+            const unsigned mask(capacity - 1U);
+            for(unsigned i(0); i < old_capacity; ++i) {
+                if(!old_slots[i].is_used) {
+                    continue;
+                }
+
+                unsigned j(slot_of(old_slots[i].hash, mask));
+                for(; slots[j].is_used; j = (j + 1U) & mask) { }
+                slots[j] = old_slots[i];
+            }
+
+            if(0 != old_slots) {
+                delete [] old_slots;
+            }
+        }
+
+    public:
+
+        Interner(void) throw()
+            : trait::Uncopyable()
+            , arena()
+            , slots(0)
+            , capacity(0)
+            , num_keys(0)
+        { }
+
+        ~Interner(void) throw() {
+            if(0 != slots) {
+                delete [] slots;
+            }
+
+            slots = 0;
+            capacity = 0;
+            num_keys = 0;
+        }
+
+        /// look up the id associated with a key. returns false if the key
+        /// has not been interned.
+        bool find(const T &key, V &value) const throw() {
+            if(0 == num_keys) {
+                return false;
+            }
+
+            const uint32_t h(traits_type::hash(key));
+            const unsigned mask(capacity - 1U);
+
+            for(unsigned i(slot_of(h, mask));
+                slots[i].is_used;
+                i = (i + 1U) & mask) {
+
+                if(h == slots[i].hash
+                && traits_type::equal(slots[i].key, key)) {
+                    value = slots[i].value;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /// intern a copy of a key and associate it with an id; assumes
+        /// that the key has not already been interned. returns the stable
+        /// copy of the key.
+        const T insert(const T &key, const V &value) throw() {
+
+            // keep the load factor below 3/4
+            if(((num_keys + 1U) * 4U) > (capacity * 3U)) {
+                grow();
+            }
+
+            const uint32_t h(traits_type::hash(key));
+            const unsigned mask(capacity - 1U);
+            unsigned i(slot_of(h, mask));
+
+            for(; slots[i].is_used; i = (i + 1U) & mask) {
+                assert(
+                    !(h == slots[i].hash
+                      && traits_type::equal(slots[i].key, key)) &&
+                    "Key has already been interned."
+                );
+            }
+
+            Slot &slot(slots[i]);
+            slot.key = arena.copy(key);
+            slot.value = value;
+            slot.hash = h;
+            slot.is_used = true;
+            ++num_keys;
+
+            return slot.key;
+        }
+
+        /// copy a key into the interner's storage without making it
+        /// findable. this gives auto-generated names the same lifetime as
+        /// interned names.
+        inline const T store(const T &key) throw() {
+            return arena.copy(key);
+        }
+
+        /// the number of interned keys
+        inline unsigned size(void) const throw() {
+            return num_keys;
+        }
+    };
+}}
+
+#endif /* FLTL_HELPER_INTERNER_HPP_ */
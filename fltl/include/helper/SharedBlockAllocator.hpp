@@ -0,0 +1,88 @@
+/*
+ * SharedBlockAllocator.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_SHAREDBLOCKALLOCATOR_HPP_
+#define FLTL_SHAREDBLOCKALLOCATOR_HPP_
+
+#include <cassert>
+
+#include "fltl/include/helper/BlockAllocator.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace fltl { namespace helper {
+
+    /// a block allocator that belongs to one object, e.g. a grammar, and
+    /// that is kept alive by every object allocated out of it. this lets
+    /// reference-counted objects, e.g. productions, outlive their owner:
+    /// the allocator deletes itself once its owner has released it and
+    /// all of its objects have been deallocated.
+    template <typename T, const unsigned BLOCK_SIZE=256U>
+    class SharedBlockAllocator : private trait::Uncopyable {
+    private:
+
+        typedef SharedBlockAllocator<T,BLOCK_SIZE> self_type;
+
+        BlockAllocator<T,BLOCK_SIZE> allocator;
+
+        /// one reference for the owner, plus one for every allocated
+        /// object
+        unsigned ref_count;
+
+        SharedBlockAllocator(void) throw()
+            : trait::Uncopyable()
+            , allocator()
+            , ref_count(1U)
+        { }
+
+        ~SharedBlockAllocator(void) throw() {
+            assert(0U == ref_count);
+        }
+
+    public:
+
+        /// make a new allocator; the caller is its owner
+        static self_type *create(void) throw() {
+            return new self_type;
+        }
+
+        /// the owner is done with this allocator
+        inline void release(void) throw() {
+            assert(0U < ref_count);
+            if(0U == --ref_count) {
+                delete this;
+            }
+        }
+
+        inline T *allocate(void) throw() {
+            ++ref_count;
+            return allocator.allocate();
+        }
+
+        inline void deallocate(T *ptr) throw() {
+            allocator.deallocate(ptr);
+            release();
+        }
+    };
+}}
+
+#endif /* FLTL_SHAREDBLOCKALLOCATOR_HPP_ */
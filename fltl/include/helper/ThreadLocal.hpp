@@ -0,0 +1,59 @@
+/*
+ * ThreadLocal.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_THREADLOCAL_HPP_
+#define FLTL_THREADLOCAL_HPP_
+
+#include "fltl/include/preprocessor/FORCE_INLINE.hpp"
+#include "fltl/include/preprocessor/THREAD_LOCAL.hpp"
+
+namespace fltl { namespace helper {
+
+    /// gives each thread its own instance of T, e.g. an allocator, which
+    /// is made the first time the thread uses it. all ThreadLocal<T>
+    /// objects share the same per-thread instance.
+    ///
+    /// instances are never destroyed: an object allocated on one thread
+    /// can be freed on another (it goes into the freeing thread's free
+    /// list), so the memory of a thread's instance has to outlive the
+    /// thread.
+    template <typename T>
+    class ThreadLocal {
+    private:
+
+        static FLTL_THREAD_LOCAL T *instance;
+
+    public:
+
+        FLTL_FORCE_INLINE T *operator->(void) const throw() {
+            if(0 == instance) {
+                instance = new T;
+            }
+            return instance;
+        }
+    };
+
+    template <typename T>
+    FLTL_THREAD_LOCAL T *ThreadLocal<T>::instance(0);
+}}
+
+#endif /* FLTL_THREADLOCAL_HPP_ */
@@ -0,0 +1,60 @@
+/*
+ * SymbolByte.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_NFA_SYMBOL_BYTE_HPP_
+#define FLTL_NFA_SYMBOL_BYTE_HPP_
+
+namespace fltl { namespace nfa {
+
+    /// get the byte that an element of an alphabet stands for, if any
+    template <typename T>
+    inline bool symbol_byte(const T &, unsigned char &) throw() {
+        return false;
+    }
+
+    inline bool symbol_byte(const char alpha, unsigned char &byte) throw() {
+        byte = static_cast<unsigned char>(alpha);
+        return true;
+    }
+
+    inline bool symbol_byte(
+        const unsigned char alpha,
+        unsigned char &byte
+    ) throw() {
+        byte = alpha;
+        return true;
+    }
+
+    inline bool symbol_byte(
+        const char * const alpha,
+        unsigned char &byte
+    ) throw() {
+        if(0 == alpha || '\0' == alpha[0] || '\0' != alpha[1]) {
+            return false;
+        }
+
+        byte = static_cast<unsigned char>(alpha[0]);
+        return true;
+    }
+}}
+
+#endif /* FLTL_NFA_SYMBOL_BYTE_HPP_ */
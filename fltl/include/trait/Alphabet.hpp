@@ -31,6 +31,7 @@
 
 #include <functional>
 #include <cstring>
+#include <stdint.h>
 
 #include "fltl/include/mpl/UserOperators.hpp"
 
@@ -53,6 +54,18 @@ namespace fltl { namespace trait {
                 return;
             }
 
+            /// hash an alphabet element; integral alphabets wider than
+            /// 32 bits are folded down
+            static uint32_t hash(const T &that) throw() {
+                const unsigned long bits(static_cast<unsigned long>(that));
+                return static_cast<uint32_t>(bits)
+                     ^ static_cast<uint32_t>((bits >> 16U) >> 16U);
+            }
+
+            static bool equal(const T &a, const T &b) throw() {
+                return a == b;
+            }
+
             static void unserialize(const char *, T &) throw() {
                 assert(false && "Unimplemented.");
             }
@@ -118,6 +131,20 @@ namespace fltl { namespace trait {
             }
         }
 
+        /// 32-bit FNV-1a hash of a cstring
+        static uint32_t hash(const char *that) throw() {
+            uint32_t h(2166136261U);
+            for(; '\0' != *that; ++that) {
+                h ^= static_cast<uint32_t>(static_cast<unsigned char>(*that));
+                h *= 16777619U;
+            }
+            return h;
+        }
+
+        static bool equal(const char *a, const char *b) throw() {
+            return 0 == strcmp(a, b);
+        }
+
         static void unserialize(const char *from, const char *&to) throw() {
             to = from;
         }
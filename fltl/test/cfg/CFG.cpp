@@ -26,8 +26,20 @@
  * THE SOFTWARE.
  */
 
+#include <set>
+#include <vector>
+
 #include "fltl/test/cfg/CFG.hpp"
 
+#include "grail/include/algorithm/CFG_PARSE_EARLEY.hpp"
+#include "grail/include/algorithm/CFG_PARSE_GLR.hpp"
+
+#include "grail/include/cfg/AnalysisCache.hpp"
+#include "grail/include/cfg/compute_first_set.hpp"
+#include "grail/include/cfg/compute_null_set.hpp"
+
+#include "grail/include/io/UTF8FileTokBuffer.hpp"
+
 namespace fltl { namespace test { namespace cfg {
 
     using fltl::CFG;
@@ -103,6 +115,62 @@ namespace fltl { namespace test { namespace cfg {
         FLTL_TEST_NOT_EQUAL_REL((S + a), (a + S));
     }
 
+    void test_string_hashes(void) throw() {
+        CFG<char> cfg;
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::var_t T(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+
+        FLTL_TEST_NOT_EQUAL((S + T).get_hash(), (T + S).get_hash());
+        FLTL_TEST_NOT_EQUAL((S + a + T).get_hash(), (T + a + S).get_hash());
+        FLTL_TEST_NOT_EQUAL((S + S).get_hash(), 0);
+        FLTL_TEST_EQUAL(((S + a) + T).get_hash(), (S + (a + T)).get_hash());
+        FLTL_TEST_EQUAL(
+            ((S + a) + (a + T)).get_hash(),
+            (S + ((a + a) + T)).get_hash()
+        );
+        FLTL_TEST_EQUAL(
+            (S + a + T).substring(1, 2).get_hash(),
+            (a + T).get_hash()
+        );
+
+        // few of the strings of length two and three made from a set of
+        // variables should collide; these have the same shape as the
+        // productions made by PDA_TO_CFG
+        enum {
+            NUM_VARS = 24
+        };
+
+        CFG<char>::var_t vars[NUM_VARS];
+        for(unsigned i(0); i < NUM_VARS; ++i) {
+            vars[i] = cfg.add_variable();
+        }
+
+        std::set<int> hashes;
+        unsigned num_strings(0);
+
+        for(unsigned i(0); i < NUM_VARS; ++i) {
+            for(unsigned j(0); j < NUM_VARS; ++j) {
+                hashes.insert((vars[i] + vars[j]).get_hash());
+                ++num_strings;
+
+                for(unsigned k(0); k < NUM_VARS; ++k) {
+                    hashes.insert((vars[i] + vars[j] + vars[k]).get_hash());
+                    ++num_strings;
+                }
+            }
+        }
+
+        const unsigned num_collisions(
+            num_strings - static_cast<unsigned>(hashes.size())
+        );
+
+        FLTL_TEST_ASSERT(
+            (num_collisions * 1000U) < num_strings,
+            "fewer than one in a thousand symbol strings collide"
+        );
+    }
+
     void test_string_lengths(void) throw() {
         CFG<char> cfg;
         CFG<char>::var_t S(cfg.add_variable());
@@ -132,6 +200,56 @@ namespace fltl { namespace test { namespace cfg {
         FLTL_TEST_EQUAL((a + S + epsilon).length(), 2);
     }
 
+    void test_intern_symbols(void) throw() {
+        CFG<const char *> cfg;
+        CFG<const char *>::term_t found;
+        char buffer[16] = {'\0'};
+
+        FLTL_TEST_ASSERT_FALSE(cfg.has_terminal("a"));
+        FLTL_TEST_ASSERT_FALSE(cfg.find_terminal("a", found));
+
+        CFG<const char *>::term_t a(cfg.get_terminal("a"));
+        CFG<const char *>::var_t S(cfg.get_variable("S"));
+        CFG<const char *>::sym_t X(cfg.get_variable_symbol("X"));
+
+        // look up copies of the strings so that pointer equality isn't
+        // enough to find them
+        strcpy(buffer, "a");
+        FLTL_TEST_ASSERT_TRUE(cfg.has_terminal(buffer));
+        FLTL_TEST_ASSERT_TRUE(cfg.find_terminal(buffer, found));
+        FLTL_TEST_EQUAL_REL(found, a);
+        FLTL_TEST_EQUAL_REL(cfg.get_terminal(buffer), a);
+        FLTL_TEST_ASSERT_TRUE(cfg.get_alpha(a) != buffer);
+        FLTL_TEST_EQUAL(strcmp(cfg.get_alpha(a), "a"), 0);
+
+        strcpy(buffer, "S");
+        FLTL_TEST_EQUAL_REL(cfg.get_variable(buffer), S);
+        FLTL_TEST_EQUAL_REL(cfg.get_variable_symbol(buffer), S);
+
+        strcpy(buffer, "X");
+        FLTL_TEST_ASSERT_TRUE(X.is_terminal());
+        FLTL_TEST_EQUAL_REL(cfg.get_variable_symbol(buffer), X);
+        FLTL_TEST_EQUAL(cfg.num_variable_terminals(), 1U);
+
+        // enough terminals to make the interner grow a few times
+        CFG<const char *>::term_t terms[200];
+        for(unsigned i(0); i < 200U; ++i) {
+            sprintf(buffer, "t%u", i);
+            terms[i] = cfg.get_terminal(buffer);
+        }
+
+        unsigned num_found(0);
+        for(unsigned i(0); i < 200U; ++i) {
+            sprintf(buffer, "t%u", i);
+            if(cfg.find_terminal(buffer, found) && found == terms[i]) {
+                ++num_found;
+            }
+        }
+
+        FLTL_TEST_EQUAL(num_found, 200U);
+        FLTL_TEST_EQUAL(cfg.num_terminals(), 202U);
+    }
+
     void test_add_productions(void) throw() {
 
         CFG<char> cfg;
@@ -199,6 +317,25 @@ namespace fltl { namespace test { namespace cfg {
 
         FLTL_TEST_NOT_EQUAL_REL(not_p.symbols(), p_str);
         FLTL_TEST_EQUAL_REL(not_p.symbols(), not_p_str);
+
+        // enough productions on one variable to grow its production set
+        CFG<char>::var_t T(cfg.add_variable());
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+        CFG<char>::sym_str_t str(cfg.epsilon());
+        for(unsigned i(0); i < 100; ++i) {
+            str = str + ((i % 3) ? a : b);
+            cfg.add_production(T, str);
+            cfg.add_production(T, str);
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_productions(), 105);
+
+        CFG<char>::prod_t P;
+        unsigned num_seen(0);
+        CFG<char>::generator_t prods_of_T(cfg.search(~P, T --->* cfg.__));
+        for(; prods_of_T.match_next(); ++num_seen) { }
+
+        FLTL_TEST_EQUAL(num_seen, 100U);
     }
 
     void test_remove_productions(void) throw() {
@@ -222,6 +359,479 @@ namespace fltl { namespace test { namespace cfg {
 
         FLTL_TEST_DOC(cfg.remove_production(P2));
         FLTL_TEST_EQUAL(cfg.num_productions(), 0);
+
+        FLTL_TEST_DOC(CFG<char>::prod_t P3(cfg.add_production(S, S)));
+        FLTL_TEST_EQUAL(cfg.num_productions(), 1);
+        FLTL_TEST_EQUAL_REL(P1, P3);
+
+        FLTL_TEST_DOC(gen.rewind());
+        FLTL_TEST_ASSERT_TRUE(gen.match_next());
+        FLTL_TEST_EQUAL_REL(P, P3);
+        FLTL_TEST_ASSERT_FALSE(gen.match_next());
+    }
+
+    void test_arena_productions(void) throw() {
+        CFG<char> heap_cfg;
+        CFG<char>::var_t heap_S(heap_cfg.add_variable());
+        CFG<char>::term_t heap_a(heap_cfg.get_terminal('a'));
+        CFG<char>::sym_str_t heap_aS(heap_a + heap_S);
+        CFG<char>::prod_t heap_P;
+
+        {
+            fltl::helper::Arena arena;
+            CFG<char> cfg(arena);
+            CFG<char>::prod_t P;
+            CFG<char>::generator_t gen(cfg.search(~P));
+
+            // the first variable and terminal of each grammar have the same
+            // ids, so their strings of symbols can be compared
+            FLTL_TEST_DOC(CFG<char>::var_t S(cfg.add_variable()));
+            FLTL_TEST_DOC(CFG<char>::term_t a(cfg.get_terminal('a')));
+
+            FLTL_TEST_DOC(CFG<char>::prod_t P1(cfg.add_production(S, a + S)));
+            FLTL_TEST_DOC(CFG<char>::prod_t P2(cfg.add_production(S, a)));
+            FLTL_TEST_DOC(CFG<char>::prod_t P3(cfg.add_production(S, cfg.epsilon())));
+            FLTL_TEST_EQUAL(cfg.num_productions(), 3);
+
+            FLTL_TEST_DOC(cfg.add_production(S, a + S));
+            FLTL_TEST_EQUAL(cfg.num_productions(), 3);
+
+            FLTL_TEST_DOC(cfg.remove_production(P2));
+            FLTL_TEST_EQUAL(cfg.num_productions(), 2);
+
+            unsigned num_seen(0);
+            for(gen.rewind(); gen.match_next(); ++num_seen) {
+                FLTL_TEST_NOT_EQUAL_REL(P, P2);
+            }
+            FLTL_TEST_EQUAL(num_seen, 2U);
+
+            FLTL_TEST_DOC(CFG<char>::prod_t P4(cfg.add_production(S, a)));
+            FLTL_TEST_EQUAL(cfg.num_productions(), 3);
+            FLTL_TEST_EQUAL_REL(P2, P4);
+
+            // enough productions on one variable to grow its production set
+            // in the arena, removing every other one
+            CFG<char>::var_t T(cfg.add_variable());
+            CFG<char>::sym_str_t str(cfg.epsilon());
+            for(unsigned i(0); i < 50; ++i) {
+                str = str + a;
+                P = cfg.add_production(T, str);
+                if(i % 2) {
+                    cfg.remove_production(P);
+                }
+            }
+
+            FLTL_TEST_EQUAL(cfg.num_productions(), 28);
+
+            num_seen = 0;
+            CFG<char>::generator_t prods_of_T(cfg.search(~P, T --->* cfg.__));
+            for(; prods_of_T.match_next(); ++num_seen) {
+                const unsigned parity(P.symbols().length() % 2U);
+                FLTL_TEST_EQUAL(parity, 1U);
+            }
+            FLTL_TEST_EQUAL(num_seen, 25U);
+
+            // comparing a pinned string with an equal unpinned one must not
+            // make the unpinned string share the pinned symbols
+            FLTL_TEST_EQUAL_REL(P1.symbols(), heap_aS);
+            FLTL_TEST_EQUAL_REL(heap_aS, P1.symbols());
+            FLTL_TEST_NOT_EQUAL_REL(P3.symbols(), heap_aS);
+
+            // a heap grammar copies the pinned symbols of the production
+            FLTL_TEST_DOC(heap_P = heap_cfg.add_production(heap_S, P1.symbols()));
+            FLTL_TEST_EQUAL(heap_cfg.num_productions(), 1);
+        }
+
+        // the arena is gone, but the heap grammar's strings still work
+        FLTL_TEST_EQUAL(heap_aS.length(), 2U);
+        FLTL_TEST_EQUAL(heap_aS.at(0), heap_a);
+        FLTL_TEST_EQUAL(heap_aS.at(1), heap_S);
+        FLTL_TEST_EQUAL_REL(heap_P.symbols(), heap_aS);
+        FLTL_TEST_EQUAL_REL(heap_P.symbols(), heap_a + heap_S);
+        FLTL_TEST_EQUAL_REL(
+            heap_cfg.add_production(heap_S, heap_a + heap_S),
+            heap_P
+        );
+        FLTL_TEST_EQUAL(heap_cfg.num_productions(), 1);
+    }
+
+    /// counts the changes that a grammar reports
+    class CountingListener : public fltl::cfg::Listener<char> {
+    public:
+        unsigned num_added;
+        unsigned num_removed;
+        unsigned num_removed_vars;
+
+        CountingListener(void) throw()
+            : fltl::cfg::Listener<char>()
+            , num_added(0)
+            , num_removed(0)
+            , num_removed_vars(0)
+        { }
+
+        virtual void on_add_production(const production_type &) throw() {
+            ++num_added;
+        }
+
+        virtual void on_remove_production(const production_type &) throw() {
+            ++num_removed;
+        }
+
+        virtual void on_remove_variable(const variable_type) throw() {
+            ++num_removed_vars;
+        }
+    };
+
+    void test_listeners(void) throw() {
+        CFG<char> cfg;
+        CountingListener listener;
+
+        FLTL_TEST_DOC(cfg.add_listener(&listener));
+        FLTL_TEST_DOC(CFG<char>::var_t S(cfg.add_variable()));
+        FLTL_TEST_DOC(CFG<char>::var_t T(cfg.add_variable()));
+
+        FLTL_TEST_DOC(CFG<char>::prod_t P1(cfg.add_production(S, S)));
+        FLTL_TEST_EQUAL(listener.num_added, 1U);
+
+        FLTL_TEST_DOC(cfg.add_production(S, S));
+        FLTL_TEST_EQUAL(listener.num_added, 1U);
+
+        FLTL_TEST_DOC(cfg.remove_production(P1));
+        FLTL_TEST_EQUAL(listener.num_removed, 1U);
+
+        FLTL_TEST_DOC(cfg.add_production(S, S));
+        FLTL_TEST_EQUAL(listener.num_added, 2U);
+
+        FLTL_TEST_DOC(cfg.add_production(T, S + T));
+        FLTL_TEST_EQUAL(listener.num_added, 3U);
+
+        FLTL_TEST_DOC(cfg.remove_variable(T));
+        FLTL_TEST_EQUAL(listener.num_removed, 2U);
+        FLTL_TEST_EQUAL(listener.num_removed_vars, 1U);
+
+        FLTL_TEST_DOC(cfg.remove_listener(&listener));
+        FLTL_TEST_DOC(cfg.add_production(S, S + S));
+        FLTL_TEST_EQUAL(listener.num_added, 3U);
+    }
+
+    void test_bulk_loader(void) throw() {
+        CFG<char> cfg;
+        CFG<char> expected_cfg;
+        CountingListener listener;
+
+        FLTL_TEST_DOC(cfg.add_listener(&listener));
+
+        CFG<char>::var_t S(cfg.add_variable());
+        CFG<char>::var_t T(cfg.add_variable());
+        CFG<char>::term_t a(cfg.get_terminal('a'));
+        CFG<char>::term_t b(cfg.get_terminal('b'));
+
+        // the same variables and terminals, in the same order, so that the
+        // symbols of both grammars can be compared
+        expected_cfg.add_variable();
+        expected_cfg.add_variable();
+        expected_cfg.get_terminal('a');
+        expected_cfg.get_terminal('b');
+
+        FLTL_TEST_DOC(cfg.add_production(S, a));
+        FLTL_TEST_DOC(cfg.add_production(T, b));
+        FLTL_TEST_EQUAL(listener.num_added, 2U);
+
+        // duplicates within the batch and of the existing productions
+        const CFG<char>::var_t batch_vars[] = {T, S, S, T, S, T, S};
+        const CFG<char>::sym_str_t a_str(a);
+        const CFG<char>::sym_str_t b_str(b);
+        const CFG<char>::sym_str_t batch_strs[] = {
+            a_str, a_str, b_str, a_str, S + a, cfg.epsilon(), b_str
+        };
+        const unsigned num_batch(sizeof batch_vars / sizeof batch_vars[0]);
+
+        {
+            CFG<char>::bulk_loader_type loader(cfg);
+            CFG<char>::symbol_buffer_type builder;
+
+            for(unsigned i(0); i < num_batch; ++i) {
+                if(i % 2) {
+                    loader.add_production(batch_vars[i], batch_strs[i]);
+                } else {
+                    builder.clear() << batch_strs[i];
+                    loader.add_production(batch_vars[i], builder);
+                }
+            }
+
+            FLTL_TEST_EQUAL(loader.size(), num_batch);
+            FLTL_TEST_EQUAL(cfg.num_productions(), 2);
+            FLTL_TEST_EQUAL(listener.num_added, 2U);
+
+            FLTL_TEST_DOC(loader.commit());
+            FLTL_TEST_EQUAL(loader.size(), 0U);
+            FLTL_TEST_EQUAL(cfg.num_productions(), 6);
+            FLTL_TEST_EQUAL(cfg.num_productions(S), 3U);
+            FLTL_TEST_EQUAL(cfg.num_productions(T), 3U);
+            FLTL_TEST_EQUAL(listener.num_added, 6U);
+
+            // committing again does nothing
+            FLTL_TEST_DOC(loader.commit());
+            FLTL_TEST_EQUAL(cfg.num_productions(), 6);
+
+            // the loader commits what is left when it is destroyed
+            FLTL_TEST_DOC(loader.add_production(T, T + b));
+            FLTL_TEST_DOC(loader.add_production(T, b_str));
+        }
+
+        FLTL_TEST_EQUAL(cfg.num_productions(), 7);
+        FLTL_TEST_EQUAL(listener.num_added, 7U);
+
+        // generators see the productions in the same order as if they had
+        // been added one at a time
+        expected_cfg.add_production(S, a);
+        expected_cfg.add_production(T, b);
+        for(unsigned i(0); i < num_batch; ++i) {
+            expected_cfg.add_production(batch_vars[i], batch_strs[i]);
+        }
+        expected_cfg.add_production(T, T + b);
+        expected_cfg.add_production(T, b);
+
+        CFG<char>::prod_t P;
+        CFG<char>::prod_t expected_P;
+        CFG<char>::generator_t gen(cfg.search(~P));
+        CFG<char>::generator_t expected_gen(expected_cfg.search(~expected_P));
+
+        unsigned num_seen(0);
+        for(; gen.match_next(); ++num_seen) {
+            FLTL_TEST_ASSERT_TRUE(expected_gen.match_next());
+            FLTL_TEST_EQUAL(P.variable(), expected_P.variable());
+            FLTL_TEST_EQUAL_REL(P.symbols(), expected_P.symbols());
+        }
+        FLTL_TEST_ASSERT_FALSE(expected_gen.match_next());
+        FLTL_TEST_EQUAL(num_seen, 7U);
+
+        const CFG<char>::sym_str_t S_order[] = {a_str, b_str, S + a};
+        num_seen = 0;
+        CFG<char>::generator_t prods_of_S(cfg.search(~P, S --->* cfg.__));
+        for(; prods_of_S.match_next(); ++num_seen) {
+            FLTL_TEST_EQUAL_REL(P.symbols(), S_order[num_seen]);
+        }
+        FLTL_TEST_EQUAL(num_seen, 3U);
+
+        FLTL_TEST_DOC(cfg.remove_listener(&listener));
+    }
+
+    /// free the sets made by compute_first_terminals
+    static void free_first_sets(std::vector<std::vector<bool> *> &first) throw() {
+        for(unsigned i(0); i < first.size(); ++i) {
+            delete first[i];
+            first[i] = 0;
+        }
+    }
+
+    void test_analysis_cache(void) throw() {
+        CFG<char> cfg;
+        grail::cfg::AnalysisCache<char> cache(cfg);
+
+        std::vector<CFG<char>::var_t> vars;
+        std::vector<CFG<char>::term_t> terms;
+        for(unsigned i(0); i < 3U; ++i) {
+            vars.push_back(cfg.add_variable());
+            terms.push_back(cfg.get_terminal(static_cast<char>('a' + i)));
+        }
+
+        std::vector<CFG<char>::prod_t> prods;
+        CFG<char>::prod_t P;
+        CFG<char>::generator_t all_prods(cfg.search(~P));
+        CFG<char>::var_t V;
+        CFG<char>::generator_t all_vars(cfg.search(~V));
+        CFG<char>::term_t T;
+        CFG<char>::generator_t all_terms(cfg.search(~T));
+        CFG<char>::symbol_buffer_type buffer;
+
+        std::vector<bool> cached_null;
+        std::vector<bool> null;
+        std::vector<std::vector<bool> *> cached_first;
+        std::vector<std::vector<bool> *> first;
+
+        unsigned num_steps(0);
+        unsigned num_wrong_null(0);
+        unsigned num_wrong_first(0);
+
+        // a fixed linear congruential generator, so that every run makes
+        // the same edits
+        unsigned seed(12345U);
+
+        for(; num_steps < 600U; ++num_steps) {
+            seed = seed * 1103515245U + 12345U;
+            const unsigned choice((seed >> 16U) % 16U);
+
+            // now and then add a new variable or terminal, which eventually
+            // outgrows the room that the cache leaves in its sets
+            if(0U == choice && vars.size() < 24U) {
+                vars.push_back(cfg.add_variable());
+
+            } else if(1U == choice && terms.size() < 24U) {
+                terms.push_back(cfg.get_terminal(
+                    static_cast<char>('a' + terms.size())
+                ));
+
+            // remove a production
+            } else if(choice < 6U) {
+                prods.clear();
+                for(all_prods.rewind(); all_prods.match_next(); ) {
+                    prods.push_back(P);
+                }
+                if(!prods.empty()) {
+                    seed = seed * 1103515245U + 12345U;
+                    cfg.remove_production(
+                        prods[(seed >> 16U) % prods.size()]
+                    );
+                }
+
+            // add a production of up to three symbols, mostly variables
+            } else {
+                seed = seed * 1103515245U + 12345U;
+                const unsigned len((seed >> 16U) % 4U);
+                buffer.clear();
+                for(unsigned i(0); i < len; ++i) {
+                    seed = seed * 1103515245U + 12345U;
+                    const unsigned sym(seed >> 16U);
+                    if(0U == (sym % 3U)) {
+                        buffer << terms[(sym / 3U) % terms.size()];
+                    } else {
+                        buffer << vars[(sym / 3U) % vars.size()];
+                    }
+                }
+                seed = seed * 1103515245U + 12345U;
+                cfg.add_production(vars[(seed >> 16U) % vars.size()], buffer);
+            }
+
+            cache.get_null_set(cached_null);
+            cache.get_first_terminals(cached_first);
+            grail::cfg::compute_null_set(cfg, null);
+            grail::cfg::compute_first_terminals(cfg, null, first);
+
+            if(cached_null != null) {
+                ++num_wrong_null;
+            }
+
+            for(all_vars.rewind(); all_vars.match_next(); ) {
+                const unsigned v(V.number());
+                if(cache.is_nullable(V) != null[v]
+                || 0 == cached_first[v]
+                || *(cached_first[v]) != *(first[v])) {
+                    ++num_wrong_first;
+                    continue;
+                }
+
+                for(all_terms.rewind(); all_terms.match_next(); ) {
+                    if(cache.is_first(V, T) != (*(first[v]))[T.number()]) {
+                        ++num_wrong_first;
+                    }
+                }
+            }
+
+            free_first_sets(cached_first);
+            free_first_sets(first);
+        }
+
+        FLTL_TEST_EQUAL(num_steps, 600U);
+        FLTL_TEST_EQUAL(num_wrong_null, 0U);
+        FLTL_TEST_EQUAL(num_wrong_first, 0U);
+        FLTL_TEST_ASSERT(
+            cfg.num_productions() > 20U,
+            "the edits leave a non-trivial grammar"
+        );
+    }
+
+    /// parse some newline-separated tokens with either the Earley or the
+    /// GLR engine, and return the number of parse trees of the tokens
+    static unsigned count_parse_trees(
+        CFG<const char *> &cfg,
+        const char *tokens,
+        const bool use_glr
+    ) throw() {
+        typedef grail::algorithm::CFG_PARSE_EARLEY<const char *, 1024U> earley_type;
+        typedef grail::algorithm::CFG_PARSE_GLR<const char *, 1024U> glr_type;
+
+        FILE *fp(tmpfile());
+        if(0 == fp) {
+            return 0U;
+        }
+
+        fputs(tokens, fp);
+        rewind(fp);
+
+        grail::io::UTF8FileTokBuffer<1024U> reader(fp, "\n");
+        reader.reset();
+
+        std::vector<grail::cfg::ParseTree<const char *> *> trees;
+        std::vector<bool> is_nullable;
+        std::vector<std::vector<bool> *> first;
+
+        if(use_glr) {
+            glr_type::run(cfg, reader, &trees, 0UL);
+        } else {
+            grail::cfg::compute_null_set(cfg, is_nullable);
+            earley_type::run(cfg, is_nullable, false, first, reader, &trees, 0UL);
+        }
+
+        fclose(fp);
+
+        for(unsigned i(0); i < trees.size(); ++i) {
+            delete trees[i];
+        }
+
+        return static_cast<unsigned>(trees.size());
+    }
+
+    void test_parse_forests(void) throw() {
+
+        // S --> S S | B | a, B --> S; every derivation of S that goes
+        // through B loops back to S over the same tokens
+        CFG<const char *> unit;
+        CFG<const char *>::var_t S(unit.get_variable("S"));
+        CFG<const char *>::var_t B(unit.get_variable("B"));
+        unit.set_start_variable(S);
+        unit.add_production(S, S + S);
+        unit.add_production(S, B);
+        unit.add_production(S, unit.get_terminal("a"));
+        unit.add_production(B, S);
+
+        const unsigned unit_earley(count_parse_trees(unit, "a\na\na\n", false));
+        const unsigned unit_glr(count_parse_trees(unit, "a\na\na\n", true));
+        FLTL_TEST_EQUAL(unit_earley, 2U);
+        FLTL_TEST_EQUAL(unit_glr, 2U);
+
+        // S --> C | C S S, C --> b | epsilon; here the cycles go through
+        // the nullable C
+        CFG<const char *> null;
+        CFG<const char *>::var_t T(null.get_variable("S"));
+        CFG<const char *>::var_t C(null.get_variable("C"));
+        null.set_start_variable(T);
+        null.add_production(T, C);
+        null.add_production(T, C + T + T);
+        null.add_production(C, null.get_terminal("b"));
+        null.add_production(C, null.epsilon());
+
+        const unsigned null_earley(count_parse_trees(null, "b\nb\n", false));
+        const unsigned null_glr(count_parse_trees(null, "b\nb\n", true));
+        FLTL_TEST_EQUAL(null_earley, 8U);
+        FLTL_TEST_EQUAL(null_glr, 8U);
+
+        // E --> E + E | F | 1, F --> E; the unit cycle doesn't hide the
+        // ambiguity of the sum
+        CFG<const char *> sum;
+        CFG<const char *>::var_t E(sum.get_variable("E"));
+        CFG<const char *>::var_t F(sum.get_variable("F"));
+        sum.set_start_variable(E);
+        sum.add_production(E, E + sum.get_terminal("+") + E);
+        sum.add_production(E, F);
+        sum.add_production(E, sum.get_terminal("1"));
+        sum.add_production(F, E);
+
+        const char *four_ones("1\n+\n1\n+\n1\n+\n1\n");
+        const unsigned sum_earley(count_parse_trees(sum, four_ones, false));
+        const unsigned sum_glr(count_parse_trees(sum, four_ones, true));
+        FLTL_TEST_EQUAL(sum_earley, 5U);
+        FLTL_TEST_EQUAL(sum_glr, 5U);
     }
 
     void test_extract_symbols(void) throw() {
@@ -39,10 +39,18 @@ namespace fltl { namespace test { namespace cfg {
         "Test for equivalence of variables, terminals, symbols, and symbol strings."
     );
 
+    FLTL_TEST_CATEGORY(test_string_hashes,
+        "Test that symbol string hashes are order-sensitive and rarely collide."
+    );
+
     FLTL_TEST_CATEGORY(test_string_lengths,
         "Test the length of symbols and symbol strings."
     );
 
+    FLTL_TEST_CATEGORY(test_intern_symbols,
+        "Test that terminals and symbol names map to the same symbols every time they are looked up."
+    );
+
     FLTL_TEST_CATEGORY(test_add_productions,
         "Test that productions are correctly added to the grammar and that duplicates are ignored."
     );
@@ -51,6 +59,26 @@ namespace fltl { namespace test { namespace cfg {
         "Test that productions are correctly removed from the grammar."
     );
 
+    FLTL_TEST_CATEGORY(test_arena_productions,
+        "Test adding, removing, and copying the productions of a grammar whose productions are in an arena."
+    );
+
+    FLTL_TEST_CATEGORY(test_listeners,
+        "Test that listeners are told about the productions and variables added to and removed from a grammar."
+    );
+
+    FLTL_TEST_CATEGORY(test_bulk_loader,
+        "Test that productions committed by a bulk loader are the same as if they were added one at a time."
+    );
+
+    FLTL_TEST_CATEGORY(test_analysis_cache,
+        "Test that an analysis cache agrees with the NULL and FIRST sets computed from scratch as productions are added and removed."
+    );
+
+    FLTL_TEST_CATEGORY(test_parse_forests,
+        "Test that the Earley and GLR parsers output the same parse trees of grammars with cycles, and none that loop through a cycle."
+    );
+
     FLTL_TEST_CATEGORY(test_extract_symbols,
         "Test that symbols and symbol strings can be extracted from productions and symbol strings."
     );
@@ -0,0 +1,325 @@
+/*
+ * CFG_PARSE_CYK.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_PARSE_CYK_HPP_
+#define FLTL_CFG_PARSE_CYK_HPP_
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/helper/BitMatrix.hpp"
+
+#include "grail/include/algorithm/CFG_TO_CNF.hpp"
+
+#include "grail/include/io/verbose.hpp"
+#include "grail/include/io/UTF8FileTokBuffer.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// recognize a token stream using the Cocke-Younger-Kasami algorithm
+    /// over the Chomsky Normal Form of a grammar. Every cell of the chart
+    /// is a bitset of the variables that derive some span of the tokens,
+    /// and all cells are rows of one dense fltl::helper::BitMatrix, laid
+    /// out so that the cells of each span length are contiguous.
+    ///
+    /// Two cells are combined by walking the variables B of the left cell,
+    /// and only looking at the rules A --> B C if the set of all such C
+    /// intersects the right cell; the set of all A for a pair (B, C) is
+    /// precomputed, and is or'd into the combined cell a word at a time.
+    ///
+    /// The chart has n(n+1)/2 cells for n tokens, and so this is meant for
+    /// short inputs.
+    ///
+    /// Note: this converts the grammar into Chomsky Normal Form.
+    template <typename AlphaT, const unsigned MAX_TOK_LENGTH>
+    class CFG_PARSE_CYK {
+    public:
+
+        // take off the templates!
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef fltl::helper::BitMatrix bit_matrix_type;
+
+    private:
+
+        /// the rules of a grammar in chomsky normal form
+        class rules_type {
+        public:
+
+            /// the variables A of each A --> a, by the terminal a
+            bit_matrix_type terminal_heads;
+
+            /// for each B, the set of all C where there is some A --> B C
+            bit_matrix_type seconds;
+
+            /// the pairs (B, C) of each B, as a range of pair_second,
+            /// and the variables A of each A --> B C, by pair
+            std::vector<unsigned> pair_begin;
+            std::vector<unsigned> pair_second;
+            bit_matrix_type pair_heads;
+
+            bool accepts_empty;
+        };
+
+        /// index the rules of a grammar in chomsky normal form
+        static void index_rules(CFG &cfg, rules_type &rules) throw() {
+            const unsigned num_vars(cfg.num_variables_capacity() + 2U);
+            const unsigned num_terms(cfg.num_terminals() + 2U);
+            const variable_type S(cfg.get_start_variable());
+
+            rules.terminal_heads.resize(num_terms, num_vars);
+            rules.seconds.resize(num_vars, num_vars);
+            rules.accepts_empty = false;
+
+            // number the distinct pairs (B, C)
+            std::map<std::pair<unsigned, unsigned>, unsigned> pairs;
+            std::vector<unsigned> pair_heads;
+            std::vector<unsigned> pair_of_rule;
+
+            production_type P;
+            generator_type productions(cfg.search(~P));
+            variable_type B;
+            variable_type C;
+            terminal_type a;
+
+            for(; productions.match_next(); ) {
+                const unsigned A(P.variable().number());
+
+                switch(P.length()) {
+                case 0:
+                    if(S == P.variable()) {
+                        rules.accepts_empty = true;
+                    }
+                    break;
+
+                case 1:
+                    assert(P.symbol_at(0).is_terminal());
+                    a = P.symbol_at(0);
+                    rules.terminal_heads.set(a.number(), A);
+                    break;
+
+                case 2: {
+                    B = P.symbol_at(0);
+                    C = P.symbol_at(1);
+                    rules.seconds.set(B.number(), C.number());
+
+                    const unsigned next(static_cast<unsigned>(pairs.size()));
+                    const unsigned pair(pairs.insert(std::make_pair(
+                        std::make_pair(B.number(), C.number()), next
+                    )).first->second);
+
+                    pair_heads.push_back(A);
+                    pair_of_rule.push_back(pair);
+                    break;
+                }
+
+                default:
+                    assert(false && "Grammar is not in CNF.");
+                    break;
+                }
+            }
+
+            // lay out the pairs sorted by B
+            rules.pair_begin.assign(num_vars + 1U, 0U);
+            rules.pair_second.assign(pairs.size(), 0U);
+            rules.pair_heads.resize(static_cast<unsigned>(pairs.size()), num_vars);
+
+            std::vector<unsigned> row_of_pair(pairs.size(), 0U);
+            unsigned row(0);
+
+            typename std::map<std::pair<unsigned, unsigned>, unsigned>::iterator
+                it(pairs.begin());
+
+            for(; it != pairs.end(); ++it, ++row) {
+                rules.pair_second[row] = it->first.second;
+                row_of_pair[it->second] = row;
+                ++(rules.pair_begin[it->first.first + 1U]);
+            }
+
+            for(unsigned i(0); i < num_vars; ++i) {
+                rules.pair_begin[i + 1U] += rules.pair_begin[i];
+            }
+
+            for(unsigned i(0); i < pair_heads.size(); ++i) {
+                rules.pair_heads.set(row_of_pair[pair_of_rule[i]], pair_heads[i]);
+            }
+        }
+
+        /// chart[dest] |= { A | A --> B C, B in chart[left], C in chart[right] }
+        static void combine(
+            const rules_type &rules,
+            bit_matrix_type &chart,
+            const unsigned left,
+            const unsigned right,
+            const unsigned dest
+        ) throw() {
+            const unsigned num_vars(chart.num_columns());
+
+            for(unsigned B(chart.next(left, 0U));
+                B < num_vars;
+                B = chart.next(left, B + 1U)) {
+
+                if(!rules.seconds.intersects(B, chart, right)) {
+                    continue;
+                }
+
+                const unsigned end(rules.pair_begin[B + 1U]);
+                for(unsigned p(rules.pair_begin[B]); p < end; ++p) {
+                    if(chart.test(right, rules.pair_second[p])) {
+                        chart.union_rows(dest, rules.pair_heads, p);
+                    }
+                }
+            }
+        }
+
+    public:
+
+        /// run the recognizer. Returns true if the grammar generates the
+        /// tokens.
+        static bool run(
+            CFG &cfg,
+            io::UTF8FileTokBuffer<MAX_TOK_LENGTH> &reader
+        ) throw() {
+
+            const char *token(reader.read());
+
+            // is it worth parsing?
+            if(0 == cfg.num_productions()
+            || !cfg.has_start_variable()
+            || 0 == cfg.num_productions(cfg.get_start_variable())) {
+                if(0 == token || '\0' == *token) {
+                    io::verbose("Parsed. Accepted empty language.\n");
+                    return true;
+                } else {
+                    io::verbose("Failed to parse. Language is empty.\n");
+                    return false;
+                }
+            }
+
+            // read in the tokens; unknown tokens are recorded as terminal
+            // number zero, and can be any variable terminal
+            std::vector<unsigned> tokens;
+            alphabet_type lexeme;
+            terminal_type a;
+
+            for(; 0 != token && '\0' != *token; token = reader.read()) {
+                traits_type::unserialize(token, lexeme);
+
+                if(cfg.find_terminal(lexeme, a)) {
+                    tokens.push_back(a.number());
+
+                } else if(0 == cfg.num_variable_terminals()) {
+                    io::verbose("    Unrecognized terminal '%s'.\n", token);
+                    return false;
+
+                } else {
+                    tokens.push_back(0U);
+                }
+            }
+
+            io::verbose("Converting grammar to CNF...\n");
+            CFG_TO_CNF<AlphaT>::run(cfg);
+
+            if(!cfg.has_start_variable()
+            || 0 == cfg.num_productions(cfg.get_start_variable())) {
+                io::verbose("Failed to parse. Language is empty.\n");
+                return false;
+            }
+
+            rules_type rules;
+            index_rules(cfg, rules);
+
+            const unsigned n(static_cast<unsigned>(tokens.size()));
+            const unsigned num_vars(cfg.num_variables_capacity() + 2U);
+
+            if(0U == n) {
+                return rules.accepts_empty;
+            }
+
+            // the cells of each span length are contiguous
+            std::vector<unsigned> first_cell(n + 1U, 0U);
+            for(unsigned len(1); len < n; ++len) {
+                first_cell[len + 1U] = first_cell[len] + (n - len + 1U);
+            }
+
+            bit_matrix_type chart(first_cell[n] + 1U, num_vars);
+            std::vector<bool> is_filled(first_cell[n] + 1U, false);
+
+            io::verbose("Parsing %u tokens...\n", n);
+
+            // spans of length one
+            for(unsigned i(0); i < n; ++i) {
+                if(0U != tokens[i]) {
+                    chart.union_rows(i, rules.terminal_heads, tokens[i]);
+
+                } else {
+                    generator_type terms(cfg.search(~a));
+                    for(; terms.match_next(); ) {
+                        if(cfg.is_variable_terminal(a)) {
+                            chart.union_rows(i, rules.terminal_heads, a.number());
+                        }
+                    }
+                }
+
+                is_filled[i] = !chart.is_empty(i);
+            }
+
+            // longer spans
+            for(unsigned len(2); len <= n; ++len) {
+                for(unsigned i(0); i + len <= n; ++i) {
+                    const unsigned dest(first_cell[len] + i);
+
+                    for(unsigned k(1); k < len; ++k) {
+                        const unsigned left(first_cell[k] + i);
+                        const unsigned right(first_cell[len - k] + i + k);
+
+                        if(is_filled[left] && is_filled[right]) {
+                            combine(rules, chart, left, right, dest);
+                        }
+                    }
+
+                    is_filled[dest] = !chart.is_empty(dest);
+                }
+            }
+
+            const bool parse_result(chart.test(
+                first_cell[n],
+                cfg.get_start_variable().number()
+            ));
+
+            if(parse_result) {
+                io::verbose("Successfully parsed.\n");
+            } else {
+                io::verbose("Failed to parse all input.\n");
+            }
+
+            return parse_result;
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_PARSE_CYK_HPP_ */
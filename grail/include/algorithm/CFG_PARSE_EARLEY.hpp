@@ -29,13 +29,19 @@
 #ifndef FLTL_CFG_EARLEY_PARSE_HPP_
 #define FLTL_CFG_EARLEY_PARSE_HPP_
 
+#include <algorithm>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "fltl/include/CFG.hpp"
 
 #include "fltl/include/helper/BlockAllocator.hpp"
 
+#include "grail/include/cfg/ItemTable.hpp"
+#include "grail/include/cfg/ParseTree.hpp"
+#include "grail/include/cfg/build_null_tree.hpp"
+
 #include "grail/include/io/verbose.hpp"
 #include "grail/include/io/UTF8FileTokBuffer.hpp"
 
@@ -51,7 +57,45 @@ namespace grail { namespace algorithm {
 
         FLTL_CFG_USE_TYPES(CFG);
 
+        typedef cfg::ParseTree<AlphaT> parse_tree_type;
+        typedef cfg::ItemTable<AlphaT> item_table_type;
+        typedef typename item_table_type::item_type table_item_type;
+
         class earley_item_type;
+        class earley_link_type;
+        class earley_set_type;
+
+        /// entry of the completion index of a set: the items of the set
+        /// that wait on a variable, i.e. that have the form
+        /// B --> ... * variable ...
+        class earley_waiting_type {
+        public:
+            unsigned variable;
+
+            // first waiting item; the rest are linked by next_waiting
+            earley_item_type *first;
+
+            // memoized deterministic reduction path (Leo item). If the only
+            // waiting item is B --> ... * variable, then completing the
+            // variable from this set can only lead to the completed item
+            // recorded here, which is the top of the path.
+            unsigned leo_state;
+            unsigned leo_slot;
+            earley_set_type *leo_initial_set;
+
+            // the next entry on the path, i.e. the one that completing B
+            // continues from, or 0 if B --> ... variable * is the top
+            earley_waiting_type *leo_next;
+
+            earley_waiting_type(void)
+                : variable(0)
+                , first(0)
+                , leo_state(0)
+                , leo_slot(0)
+                , leo_initial_set(0)
+                , leo_next(0)
+            { }
+        };
 
         /// Earley set
         class earley_set_type {
@@ -67,14 +111,30 @@ namespace grail { namespace algorithm {
             // offset into the terminal stream
             unsigned offset;
 
+            // completion index, sorted by variable; this is built the
+            // first time that something is completed from this set
+            earley_waiting_type *waiting;
+            unsigned num_waiting;
+            bool is_indexed;
+
             earley_set_type(void)
                 : first(0)
                 , last(0)
                 , next(0)
                 , prev(0)
                 , offset(0)
+                , waiting(0)
+                , num_waiting(0)
+                , is_indexed(false)
             { }
 
+            ~earley_set_type(void) throw() {
+                if(0 != waiting) {
+                    delete [] waiting;
+                    waiting = 0;
+                }
+            }
+
             void push(earley_item_type *item) throw() {
                 if(0 == item) {
                     return;
@@ -101,9 +161,8 @@ namespace grail { namespace algorithm {
         /// Earley item
         class earley_item_type {
         public:
-            // dotted production
-            unsigned dot;
-            production_type production;
+            // dotted production, as an offset into the item table
+            unsigned slot;
 
             // next item in the set
             earley_item_type *next;
@@ -117,42 +176,121 @@ namespace grail { namespace algorithm {
             // set
             earley_item_type *next_with_same_initial_set;
 
+            // the next item in the same set that waits on the same variable
+            earley_item_type *next_waiting;
+
+            // back-pointers to every way in which this item was derived;
+            // these are only recorded when a parse forest is requested,
+            // and together with the items they form the shared packed
+            // parse forest.
+            earley_link_type *links;
+
+            // number of acyclic derivations of this item; only computed
+            // when extracting trees from the forest
+            unsigned long num_derivations;
+            unsigned visit_state;
+
             earley_item_type(void)
-                : dot(0)
-                , production()
+                : slot(0)
                 , next(0)
                 , initial_set(0)
                 , next_with_same_initial_set(0)
+                , next_waiting(0)
+                , links(0)
+                , num_derivations(0)
+                , visit_state(0)
             { }
 
             void scanned_from(
                 earley_item_type *scan
             ) throw() {
-                dot = scan->dot + 1U;
-                production = scan->production;
+                slot = scan->slot + 1U;
                 initial_set = scan->initial_set;
             }
 
             void predicted_from(
                 earley_set_type *set,
-                const production_type &prod
+                const unsigned first_slot
             ) throw() {
-                dot = 0;
-                production = prod;
+                slot = first_slot;
                 initial_set = set;
             }
         };
 
+        /// how the symbol before the dot of an item was derived. A Leo link
+        /// instead derives all of a completed item at the top of a
+        /// deterministic reduction path; the skipped completed items are
+        /// rebuilt from the path when trees are extracted.
+        typedef enum {
+            LINK_SCAN,
+            LINK_COMPLETE,
+            LINK_NULL,
+            LINK_LEO
+        } earley_link_kind;
+
+        /// back-pointer (packed node) of the parse forest. An item
+        /// A --> a X * b has a link for every way of getting it: the
+        /// predecessor item A --> a * X b, and the derivation of X, which
+        /// is either a scanned token, a completed item X --> c *, or an
+        /// empty derivation of a nullable X.
+        class earley_link_type {
+        public:
+            earley_link_type *next;
+            earley_item_type *predecessor;
+
+            // completed item, if this is a completion link; for a Leo link
+            // this is the completed item at the bottom of the path
+            earley_item_type *cause;
+
+            // the first entry of the path, if this is a Leo link
+            earley_waiting_type *leo_path;
+
+            // offset of the scanned token, if this is a scan link
+            unsigned token;
+
+            earley_link_kind kind;
+
+            // number of acyclic derivations that go through this link
+            unsigned long num_derivations;
+
+            // number of acyclic derivations that go through this link when
+            // its item is counted as part of the completed item of the same
+            // production in the same set. The item spans the same tokens as
+            // that completed item, and so fewer of its derivations might be
+            // acyclic than when it is the predecessor of a later item.
+            unsigned long num_owned_derivations;
+
+            earley_link_type(void)
+                : next(0)
+                , predecessor(0)
+                , cause(0)
+                , leo_path(0)
+                , token(0)
+                , kind(LINK_NULL)
+                , num_derivations(0)
+                , num_owned_derivations(0)
+            { }
+        };
+
     private:
 
         enum {
             NUM_BLOCKS = 1024U
         };
 
-        static void
-        clear_index(std::vector<earley_item_type *> &index) throw() {
-            for(unsigned i(0); i < index.size(); ++i) {
-                index[i] = 0;
+        /// reset the entries of a membership index that were used by the
+        /// items of a set
+        static void clear_index(
+            std::vector<earley_item_type *> &index,
+            earley_set_type *set
+        ) throw() {
+            if(0 == set) {
+                return;
+            }
+            for(earley_item_type *item(set->first);
+                0 != item;
+                item = item->next) {
+                index[item->initial_set->offset] = 0;
             }
         }
 
@@ -166,6 +304,564 @@ namespace grail { namespace algorithm {
             earley_set_type, NUM_BLOCKS
         > earley_set_allocator_type;
 
+        /// allocator type for parse forest links
+        typedef fltl::helper::BlockAllocator<
+            earley_link_type, NUM_BLOCKS
+        > earley_link_allocator_type;
+
+        enum {
+            LEO_UNKNOWN = 0U,
+            LEO_NONE = 1U,
+            LEO_FOUND = 2U
+        };
+
+        /// build the completion index of a set. The index is only built
+        /// once the set is finished, i.e. no more items will be added to
+        /// it. The heads vector is scratch space, indexed by variable, that
+        /// must be all null.
+        static void index_set(
+            const item_table_type &table,
+            earley_set_type *set,
+            std::vector<earley_item_type *> &heads,
+            std::vector<unsigned> &variables
+        ) throw() {
+            set->is_indexed = true;
+            variables.clear();
+
+            // group the waiting items by variable
+            for(earley_item_type *item(set->first);
+                0 != item;
+                item = item->next) {
+
+                const table_item_type &slot(table.item(item->slot));
+                if(item_table_type::ITEM_PREDICT != slot.kind) {
+                    continue;
+                }
+
+                if(0 == heads[slot.number]) {
+                    variables.push_back(slot.number);
+                }
+
+                item->next_waiting = heads[slot.number];
+                heads[slot.number] = item;
+            }
+
+            if(variables.empty()) {
+                return;
+            }
+
+            std::sort(variables.begin(), variables.end());
+
+            set->num_waiting = static_cast<unsigned>(variables.size());
+            set->waiting = new earley_waiting_type[set->num_waiting];
+
+            for(unsigned i(0); i < set->num_waiting; ++i) {
+                set->waiting[i].variable = variables[i];
+                set->waiting[i].first = heads[variables[i]];
+                heads[variables[i]] = 0;
+            }
+        }
+
+        /// find the items of a finished set that wait on a variable, or 0
+        /// if there are none
+        static earley_waiting_type *find_waiting(
+            const item_table_type &table,
+            earley_set_type *set,
+            const unsigned variable,
+            std::vector<earley_item_type *> &heads,
+            std::vector<unsigned> &variables
+        ) throw() {
+            if(!set->is_indexed) {
+                index_set(table, set, heads, variables);
+            }
+
+            unsigned low(0);
+            unsigned high(set->num_waiting);
+
+            while(low < high) {
+                const unsigned mid(low + (high - low) / 2U);
+                if(set->waiting[mid].variable < variable) {
+                    low = mid + 1U;
+                } else {
+                    high = mid;
+                }
+            }
+
+            if(low < set->num_waiting && variable == set->waiting[low].variable) {
+                return &(set->waiting[low]);
+            }
+
+            return 0;
+        }
+
+        /// find the top of the deterministic reduction path taken when the
+        /// variable is completed from a finished set. Returns false if
+        /// completing the variable is not deterministic. Results are
+        /// memoized in the completion index of the set.
+        static bool find_leo_item(
+            const item_table_type &table,
+            earley_set_type *set,
+            earley_waiting_type *waiting,
+            std::vector<earley_item_type *> &heads,
+            std::vector<unsigned> &variables
+        ) throw() {
+            if(LEO_UNKNOWN != waiting->leo_state) {
+                return LEO_FOUND == waiting->leo_state;
+            }
+
+            earley_item_type *item(waiting->first);
+
+            // not deterministic, or the variable is not the last symbol of
+            // the waiting item's production
+            if(0 != item->next_waiting
+            || item_table_type::ITEM_COMPLETE != table.item(item->slot + 1U).kind) {
+                waiting->leo_state = LEO_NONE;
+                return false;
+            }
+
+            waiting->leo_state = LEO_FOUND;
+            waiting->leo_slot = item->slot + 1U;
+            waiting->leo_initial_set = item->initial_set;
+            waiting->leo_next = 0;
+
+            // extend the path through the waiting item's initial set
+            if(item->initial_set == set) {
+                return true;
+            }
+
+            earley_waiting_type *top(find_waiting(
+                table,
+                item->initial_set,
+                table.item(waiting->leo_slot).number,
+                heads,
+                variables
+            ));
+
+            if(0 != top
+            && find_leo_item(table, item->initial_set, top, heads, variables)) {
+                waiting->leo_slot = top->leo_slot;
+                waiting->leo_initial_set = top->leo_initial_set;
+                waiting->leo_next = top;
+            }
+
+            return true;
+        }
+
+        enum {
+            VISIT_NONE = 0U,
+            VISIT_ACTIVE = 1U,
+            VISIT_DONE = 2U
+        };
+
+        static const unsigned long MAX_DERIVATIONS = ~0UL;
+
+        /// record a back-pointer from an item to one of its derivations
+        static void add_link(
+            earley_link_allocator_type &allocator,
+            earley_item_type *item,
+            earley_item_type *predecessor,
+            const earley_link_kind kind,
+            earley_item_type *cause,
+            const unsigned token,
+            earley_waiting_type *leo_path=0
+        ) throw() {
+            earley_link_type *link(allocator.allocate());
+            link->predecessor = predecessor;
+            link->cause = cause;
+            link->leo_path = leo_path;
+            link->token = token;
+            link->kind = kind;
+            link->next = item->links;
+            item->links = link;
+        }
+
+        static unsigned long
+        saturating_add(const unsigned long a, const unsigned long b) throw() {
+            return (MAX_DERIVATIONS - a < b) ? MAX_DERIVATIONS : a + b;
+        }
+
+        static unsigned long
+        saturating_mul(const unsigned long a, const unsigned long b) throw() {
+            if(0 != a && MAX_DERIVATIONS / a < b) {
+                return MAX_DERIVATIONS;
+            }
+            return a * b;
+        }
+
+        /// a completed item whose derivations are being counted, and the
+        /// offset of the set that it is in. Together these name a node of
+        /// the parse forest, i.e. a variable that derives the tokens in
+        /// [item->initial_set->offset, offset).
+        typedef std::pair<earley_item_type *, unsigned> active_item_type;
+
+        /// check if a completed item in the set at offset end derives the
+        /// same variable over the same tokens as one of the completed items
+        /// being counted, i.e. if the derivation loops through a cycle of
+        /// unit productions. Every item between the two would span the same
+        /// tokens, and so only the innermost active items are checked.
+        static bool is_cycle(
+            const item_table_type &table,
+            const std::vector<active_item_type> &active,
+            earley_item_type *item,
+            const unsigned end
+        ) throw() {
+            const unsigned variable(table.item(item->slot).number);
+
+            for(unsigned i(static_cast<unsigned>(active.size())); i-- > 0; ) {
+                earley_item_type *active_item(active[i].first);
+
+                if(end != active[i].second
+                || item->initial_set != active_item->initial_set) {
+                    break;
+                }
+
+                if(variable == table.item(active_item->slot).number) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /// count the derivations of an item in the set at offset end.
+        /// Derivations that go through a cycle of unit productions are cut
+        /// where a variable first derives the same tokens as one of its
+        /// ancestors, and are not counted; the counts are stored on the
+        /// links so that extracting a tree follows exactly the derivations
+        /// that were counted.
+        static unsigned long count_derivations(
+            const item_table_type &table,
+            earley_item_type *item,
+            const unsigned end,
+            std::vector<active_item_type> &active
+        ) throw() {
+            const bool is_complete(
+                item_table_type::ITEM_COMPLETE == table.item(item->slot).kind
+            );
+
+            // an incomplete item that spans the same tokens as the innermost
+            // completed item being counted is reached through the null links
+            // of that item, and its count depends on which items are being
+            // counted. That completed item is only counted once, and so this
+            // count is not memoized.
+            const bool is_owned(
+                !is_complete
+                && !active.empty()
+                && end == active.back().second
+                && item->initial_set == active.back().first->initial_set
+            );
+
+            // checked before the memoized count, as the item might have
+            // been counted along some other derivation
+            if(is_complete && is_cycle(table, active, item, end)) {
+                return 0UL;
+            } else if(!is_owned && VISIT_DONE == item->visit_state) {
+                return item->num_derivations;
+            } else if(!is_owned && VISIT_ACTIVE == item->visit_state) {
+                return 0UL;
+            }
+
+            unsigned long count(0 == table.item(item->slot).dot ? 1UL : 0UL);
+            unsigned long num_link_derivations(0);
+
+            if(is_complete) {
+                active.push_back(active_item_type(item, end));
+            }
+
+            if(!is_owned) {
+                item->visit_state = VISIT_ACTIVE;
+            }
+
+            for(earley_link_type *link(item->links);
+                0 != link;
+                link = link->next) {
+
+                // the completed items skipped by the path of a Leo link
+                // each have one derivation for every derivation of the
+                // item below them and of their waiting item. Each waiting
+                // item is in the initial set of the item below it.
+                if(LINK_LEO == link->kind) {
+                    num_link_derivations = count_derivations(
+                        table, link->cause, end, active
+                    );
+                    earley_item_type *below(link->cause);
+                    for(earley_waiting_type *entry(link->leo_path);
+                        0 != entry;
+                        entry = entry->leo_next) {
+                        num_link_derivations = saturating_mul(
+                            num_link_derivations,
+                            count_derivations(
+                                table,
+                                entry->first,
+                                below->initial_set->offset,
+                                active
+                            )
+                        );
+                        below = entry->first;
+                    }
+
+                // the predecessor of a completion link is in the initial
+                // set of the completed item, and the predecessor of a scan
+                // link is in the previous set
+                } else if(LINK_COMPLETE == link->kind) {
+                    num_link_derivations = count_derivations(
+                        table,
+                        link->predecessor,
+                        link->cause->initial_set->offset,
+                        active
+                    );
+                    num_link_derivations = saturating_mul(
+                        num_link_derivations,
+                        count_derivations(table, link->cause, end, active)
+                    );
+
+                } else {
+                    num_link_derivations = count_derivations(
+                        table,
+                        link->predecessor,
+                        LINK_SCAN == link->kind ? end - 1U : end,
+                        active
+                    );
+                }
+
+                if(is_owned) {
+                    link->num_owned_derivations = num_link_derivations;
+                } else {
+                    link->num_derivations = num_link_derivations;
+                }
+
+                count = saturating_add(count, num_link_derivations);
+            }
+
+            if(is_complete) {
+                active.pop_back();
+            }
+
+            if(!is_owned) {
+                item->num_derivations = count;
+                item->visit_state = VISIT_DONE;
+            }
+
+            return count;
+        }
+
+        /// find the link of an item that its k-th derivation goes
+        /// through, and make k relative to that link
+        static earley_link_type *find_link(
+            earley_item_type *item,
+            unsigned long &k,
+            const bool is_owned=false
+        ) throw() {
+            earley_link_type *link(item->links);
+            for(; 0 != link; link = link->next) {
+                const unsigned long num_link_derivations(
+                    is_owned ? link->num_owned_derivations
+                             : link->num_derivations
+                );
+                if(k < num_link_derivations) {
+                    break;
+                }
+                k -= num_link_derivations;
+            }
+
+            assert(0 != link);
+            return link;
+        }
+
+        /// fill in the children of the tree of the k-th derivation of an
+        /// item from right-to-left, by walking back along its predecessors
+        static void add_children(
+            item_table_type &table,
+            parse_tree_type *tree,
+            earley_item_type *item,
+            unsigned long k,
+            std::vector<alphabet_type> &lexemes,
+            std::vector<production_type> &null_prods
+        ) throw() {
+            earley_link_type *link(0);
+            unsigned long num_cause_derivations(0);
+            variable_type V;
+            terminal_type T;
+
+            // the items reached through the null links of a completed item
+            // were counted as part of it
+            bool is_owned(false);
+
+            for(; 0 != table.item(item->slot).dot; item = link->predecessor) {
+
+                link = find_link(item, k, is_owned);
+                is_owned = LINK_NULL == link->kind && (is_owned
+                    || item_table_type::ITEM_COMPLETE
+                        == table.item(item->slot).kind);
+
+                const symbol_type &sym(table.item(item->slot - 1U).symbol);
+
+                switch(link->kind) {
+                case LINK_SCAN:
+                    T = sym;
+                    tree->add_child(new parse_tree_type(
+                        T, lexemes[link->token]
+                    ));
+                    break;
+
+                case LINK_NULL:
+                    V = sym;
+                    tree->add_child(cfg::build_null_tree<AlphaT>(V, null_prods));
+                    break;
+
+                case LINK_COMPLETE:
+                    num_cause_derivations = link->cause->num_derivations;
+                    tree->add_child(build_tree(
+                        table,
+                        link->cause,
+                        k % num_cause_derivations,
+                        lexemes,
+                        null_prods
+                    ));
+                    k /= num_cause_derivations;
+                    break;
+
+                // only completed items at the tops of paths have Leo links,
+                // and completed items are never predecessors
+                case LINK_LEO:
+                    assert(false);
+                    break;
+                }
+            }
+        }
+
+        /// build the k-th derivation of the completed item at the top of
+        /// the path of a Leo link. The completed items that were skipped
+        /// are rebuilt from the bottom of the path up: each is the waiting
+        /// item of an entry of the path, whose last child is the item
+        /// below it.
+        static parse_tree_type *build_leo_tree(
+            item_table_type &table,
+            earley_link_type *link,
+            unsigned long k,
+            std::vector<alphabet_type> &lexemes,
+            std::vector<production_type> &null_prods
+        ) throw() {
+            const unsigned long num_cause_derivations(
+                link->cause->num_derivations
+            );
+
+            parse_tree_type *child(build_tree(
+                table,
+                link->cause,
+                k % num_cause_derivations,
+                lexemes,
+                null_prods
+            ));
+            k /= num_cause_derivations;
+
+            for(earley_waiting_type *entry(link->leo_path);
+                0 != entry;
+                entry = entry->leo_next) {
+
+                earley_item_type *waiting_item(entry->first);
+                const unsigned long num_waiting_derivations(
+                    waiting_item->num_derivations
+                );
+
+                parse_tree_type *tree(new parse_tree_type(table.production(
+                    table.item(waiting_item->slot).production
+                )));
+
+                tree->add_child(child);
+                add_children(
+                    table,
+                    tree,
+                    waiting_item,
+                    k % num_waiting_derivations,
+                    lexemes,
+                    null_prods
+                );
+                k /= num_waiting_derivations;
+                child = tree;
+            }
+
+            return child;
+        }
+
+        /// build the k-th derivation of a completed item
+        static parse_tree_type *build_tree(
+            item_table_type &table,
+            earley_item_type *item,
+            unsigned long k,
+            std::vector<alphabet_type> &lexemes,
+            std::vector<production_type> &null_prods
+        ) throw() {
+            if(0 != table.item(item->slot).dot) {
+                unsigned long link_k(k);
+                earley_link_type *link(find_link(item, link_k));
+                if(LINK_LEO == link->kind) {
+                    return build_leo_tree(
+                        table, link, link_k, lexemes, null_prods
+                    );
+                }
+            }
+
+            parse_tree_type *tree(new parse_tree_type(table.production(
+                table.item(item->slot).production
+            )));
+            add_children(table, tree, item, k, lexemes, null_prods);
+            return tree;
+        }
+
+        /// extract up to max_trees derivations from the parse forest rooted
+        /// at the item for the fake start production. If max_trees is 0
+        /// then all derivations are extracted, unless there are too many
+        /// to count, in which case nothing is extracted and false is
+        /// returned.
+        static bool extract_trees(
+            CFG &cfg,
+            item_table_type &table,
+            earley_item_type *root,
+            const unsigned long max_trees,
+            std::vector<alphabet_type> &lexemes,
+            std::vector<parse_tree_type *> &trees
+        ) throw() {
+            std::vector<production_type> null_prods;
+            cfg::find_null_productions(cfg, null_prods);
+
+            // the root is in the last set, whose offset is the number of
+            // tokens
+            std::vector<active_item_type> active;
+            unsigned long num_trees(count_derivations(
+                table,
+                root,
+                static_cast<unsigned>(lexemes.size()),
+                active
+            ));
+
+            if(MAX_DERIVATIONS == num_trees) {
+                io::verbose("    Found too many derivations to count.\n");
+                if(0 == max_trees) {
+                    return false;
+                }
+            } else {
+                io::verbose("    Found %lu derivation(s).\n", num_trees);
+            }
+
+            if(0 != max_trees && max_trees < num_trees) {
+                num_trees = max_trees;
+            }
+
+            for(unsigned long k(0); k < num_trees; ++k) {
+
+                // the root is the fake start production; its only child is
+                // the tree for the actual start variable
+                parse_tree_type *fake_tree(build_tree(
+                    table, root, k, lexemes, null_prods
+                ));
+                trees.push_back(fake_tree->remove_child(0));
+                delete fake_tree;
+            }
+
+            return true;
+        }
+
         /// check the index for the existence of item, if it's in, return 0,
         /// otherwise return the item and add it to the index
         static earley_item_type *
@@ -184,7 +880,7 @@ namespace grail { namespace algorithm {
                 prev = curr, curr = curr->next_with_same_initial_set) {
 
                 // found an insertion point
-                if(item->dot < curr->dot) {
+                if(item->slot < curr->slot) {
                     item->next_with_same_initial_set = curr;
 
                     if(0 == prev) {
@@ -197,11 +893,11 @@ namespace grail { namespace algorithm {
                     return item;
 
                 // skip
-                } else if(item->dot > curr->dot) {
+                } else if(item->slot > curr->slot) {
                     continue;
 
-                // same dot values, check if the productions are equivalent
-                } else if(curr->production == item->production) {
+                // same dotted production
+                } else {
                     allocator.deallocate(item);
                     return curr;
                 }
@@ -224,23 +920,43 @@ namespace grail { namespace algorithm {
 
 
         /// run the parser; assumes that the NULLABLE set is properly filled
-        /// for this grammar
+        /// for this grammar. If trees is non-null then a parse forest is
+        /// built during parsing, and up to max_trees parse trees (all trees
+        /// if max_trees is 0) are extracted from it into trees. The caller
+        /// owns the extracted trees. If all trees are asked for but there
+        /// are too many to count, then no trees are extracted and
+        /// too_many_trees is set to true.
         static bool run(
             CFG &cfg,
             std::vector<bool> &is_nullable,
             const bool use_first_set,
             std::vector<std::vector<bool> *> &first_terminals,
-            io::UTF8FileTokBuffer<MAX_TOK_LENGTH> &reader
+            io::UTF8FileTokBuffer<MAX_TOK_LENGTH> &reader,
+            std::vector<parse_tree_type *> *trees=0,
+            const unsigned long max_trees=1UL,
+            bool *too_many_trees=0
         ) throw() {
 
             bool parse_result(false);
             const char *token(reader.read());
 
-            // allocator for Earley sets
-            static earley_set_allocator_type set_allocator;
+            // allocators for Earley sets, items and parse forest links.
+            // these belong to this run so that the parser can be run on
+            // several threads at once; the items and links are freed along
+            // with their allocators.
+            earley_set_allocator_type set_allocator;
+            earley_item_allocator_type item_allocator;
+            earley_link_allocator_type link_allocator;
+
+            // copies of the lexemes, used as the leaves of parse trees
+            const bool build_forest(0 != trees);
+
+            std::vector<alphabet_type> lexemes;
 
-            /// allocator for Earley items
-            static earley_item_allocator_type item_allocator;
+            // scratch space for building the completion indexes of sets
+            std::vector<earley_item_type *> waiting_heads;
+            std::vector<unsigned> waiting_variables;
+            earley_waiting_type *waiting(0);
 
             // the actual start variable; we will end up adding a fake
             // start variable later
@@ -271,6 +987,20 @@ namespace grail { namespace algorithm {
                 );
             }
 
+            // compile the grammar into a table of dotted productions; the
+            // fake start variable has exactly one production
+            item_table_type table;
+            table.build(cfg);
+
+            waiting_heads.assign(
+                cfg.num_variables_capacity() + 2U,
+                static_cast<earley_item_type *>(0)
+            );
+
+            const unsigned start_slot(table.first_item(
+                table.productions_begin(SV.number())
+            ));
+
             // set up the base case for the earley parser
             earley_item_type *curr_item(item_allocator.allocate());
             earley_set_type *curr_set(set_allocator.allocate());
@@ -280,28 +1010,15 @@ namespace grail { namespace algorithm {
             earley_set_type *first_set(curr_set);
 
             curr_set->next = 0;
-            curr_item->production = SP;
+            curr_item->slot = start_slot;
             curr_item->initial_set = curr_set;
             curr_set->push(first_item);
 
-            // variables used in the patterns
-            unsigned dot;
-            variable_type A;
-            variable_type B;
-            terminal_type a;
-            production_type prod;
-
-            pattern_type scanner_known((~A) --->* cfg.__(dot) + a + cfg.__);
-            pattern_type scanner_unknown((~A) --->* cfg.__(dot) + ~a + cfg.__);
-            pattern_type predictor((~A) --->* cfg.__(dot) + ~B + cfg.__);
-            pattern_type completer((~A) --->* cfg.__(dot));
-
-            generator_type predictor_related(cfg.search(~prod, B --->* cfg.__));
-            pattern_type completer_related(cfg._ --->* cfg.__(dot) + A + cfg.__);
-
             // terminals
             unsigned i(0);
             alphabet_type lexeme;
+            terminal_type a;
+            unsigned a_number(0);
             bool solve_for_variable_terminal(false);
 
             // indexes for the sets to test membership, +1 as there are n+1
@@ -334,10 +1051,14 @@ namespace grail { namespace algorithm {
 
                     traits_type::unserialize(token, lexeme);
 
+                    if(build_forest) {
+                        lexemes.push_back(traits_type::copy(lexeme));
+                    }
+
                     // try to get the terminal
-                    solve_for_variable_terminal = !cfg.has_terminal(lexeme);
+                    solve_for_variable_terminal = !cfg.find_terminal(lexeme, a);
                     if(!solve_for_variable_terminal) {
-                        a = cfg.get_terminal(lexeme);
+                        a_number = a.number();
 
                     // found a token but this grammar has no variable terminals
                     // and so it can't be substituted for anything
@@ -359,42 +1080,54 @@ namespace grail { namespace algorithm {
                     0 != curr_item;
                     curr_item = curr_item->next) {
 
-                    // move the dot to where the current item is looking so
-                    // that the patterns see the right value
-                    dot = curr_item->dot;
+                    const table_item_type &item(table.item(curr_item->slot));
+
+                    switch(item.kind) {
 
                     // the item has the form A --> ... * B ...
-                    if(predictor.match(curr_item->production)) {
+                    case item_table_type::ITEM_PREDICT: {
 
                         // if B is nullable then add A --> ... B * ... to
                         // the item set
-                        if(is_nullable[B.number()]) {
+                        if(is_nullable[item.number]) {
 
                             next_item = item_allocator.allocate();
                             next_item->scanned_from(curr_item);
-                            indexed_push(
+                            next_item = indexed_push(
                                 curr_set,
                                 set_index[curr_index],
                                 item_allocator,
                                 next_item
                             );
+
+                            if(build_forest) {
+                                add_link(
+                                    link_allocator, next_item, curr_item,
+                                    LINK_NULL, 0, 0
+                                );
+                            }
                         }
 
                         // if we're using FIRST sets then use them to skip
                         // useless predictions
                         if(use_first_set && not_at_end
                         && !solve_for_variable_terminal
-                        && !(first_terminals[B.number()]->operator[](a.number()))) {
-                            continue;
+                        && !(first_terminals[item.number]->operator[](a_number))) {
+                            break;
                         }
 
                         // for each B --> alpha, add B --> * alpha to the
                         // item set
-                        for(predictor_related.rewind();
-                            predictor_related.match_next();) {
+                        const unsigned end(table.productions_end(item.number));
+                        for(unsigned p(table.productions_begin(item.number));
+                            p < end;
+                            ++p) {
 
                             next_item = item_allocator.allocate();
-                            next_item->predicted_from(curr_set, prod);
+                            next_item->predicted_from(
+                                curr_set,
+                                table.first_item(p)
+                            );
 
                             indexed_push(
                                 curr_set,
@@ -403,18 +1136,64 @@ namespace grail { namespace algorithm {
                                 next_item
                             );
                         }
+                        break;
+                    }
 
                     // the item has the form A --> ... *
-                    } else if(completer.match(curr_item->production)) {
+                    case item_table_type::ITEM_COMPLETE:
 
-                        for(earley_item_type *rel_item(curr_item->initial_set->first);
-                            0 != rel_item;
-                            rel_item = rel_item->next) {
+                        // the item was predicted in this set, so A is
+                        // nullable, and so every item in this set that waits
+                        // on A was already advanced when it was predicted
+                        if(curr_item->initial_set == curr_set) {
+                            break;
+                        }
+
+                        // find the items of the form B --> ... * A ... in
+                        // the initial set
+                        waiting = find_waiting(
+                            table,
+                            curr_item->initial_set,
+                            item.number,
+                            waiting_heads,
+                            waiting_variables
+                        );
+
+                        if(0 == waiting) {
+                            break;
+                        }
 
-                            dot = rel_item->dot;
-                            if(!completer_related.match(rel_item->production)) {
-                                continue;
+                        // follow the deterministic reduction path, if any,
+                        // straight to the top-most completed item
+                        if(find_leo_item(
+                            table,
+                            curr_item->initial_set,
+                            waiting,
+                            waiting_heads,
+                            waiting_variables
+                        )) {
+                            next_item = item_allocator.allocate();
+                            next_item->slot = waiting->leo_slot;
+                            next_item->initial_set = waiting->leo_initial_set;
+                            next_item = indexed_push(
+                                curr_set,
+                                set_index[curr_index],
+                                item_allocator,
+                                next_item
+                            );
+
+                            if(build_forest) {
+                                add_link(
+                                    link_allocator, next_item, 0,
+                                    LINK_LEO, curr_item, 0, waiting
+                                );
                             }
+                            break;
+                        }
+
+                        for(earley_item_type *rel_item(waiting->first);
+                            0 != rel_item;
+                            rel_item = rel_item->next_waiting) {
 
                             next_item = item_allocator.allocate();
                             next_item->scanned_from(rel_item);
@@ -424,10 +1203,22 @@ namespace grail { namespace algorithm {
                                 item_allocator,
                                 next_item
                             );
+
+                            if(build_forest) {
+                                add_link(
+                                    link_allocator, next_item, rel_item,
+                                    LINK_COMPLETE, curr_item, 0
+                                );
+                            }
                         }
+                        break;
 
                     // try to "solve" this terminal
-                    } else if(not_at_end) {
+                    case item_table_type::ITEM_SCAN:
+
+                        if(!not_at_end) {
+                            break;
+                        }
 
                         // we don't know the terminal of this lexeme, lets
                         // see if we can substitute a variable terminal
@@ -436,25 +1227,20 @@ namespace grail { namespace algorithm {
                             // try to match this production as
                             // A --> ... * a ... for some variable terminal
                             // a.
-                            if(!scanner_unknown.match(curr_item->production)
-                            || !cfg.is_variable_terminal(a)) {
-                                continue;
+                            if(!item.is_variable_terminal) {
+                                break;
                             }
 
                             io::verbose(
                                 "        Substituting as %s...\n",
-                                cfg.get_name(a)
+                                cfg.get_name(terminal_type(item.symbol))
                             );
 
-                        // we know the terminal of this lexeme
-                        } else {
-
-                            // try to match this production as
-                            // A --> ... * a ... where "a" is the terminal
-                            // of the current lexeme.
-                            if(!scanner_known.match(curr_item->production)) {
-                                continue;
-                            }
+                        // we know the terminal of this lexeme; try to match
+                        // this production as A --> ... * a ... where "a" is
+                        // the terminal of the current lexeme.
+                        } else if(a_number != item.number) {
+                            break;
                         }
 
                         next_set = curr_set->next;
@@ -462,7 +1248,7 @@ namespace grail { namespace algorithm {
                             next_set = set_allocator.allocate();
                             curr_set->set_next(next_set);
                             set_index[1U - curr_index].push_back(0);
-                            clear_index(set_index[1U - curr_index]);
+                            clear_index(set_index[1U - curr_index], prev_set);
                         }
 
                         next_item = item_allocator.allocate();
@@ -473,6 +1259,14 @@ namespace grail { namespace algorithm {
                             item_allocator,
                             next_item
                         );
+
+                        if(build_forest) {
+                            add_link(
+                                link_allocator, next_item, curr_item,
+                                LINK_SCAN, 0, i
+                            );
+                        }
+                        break;
                     }
                 }
             }
@@ -493,10 +1287,20 @@ namespace grail { namespace algorithm {
                     0 != curr_item;
                     curr_item = curr_item->next) {
 
-                    if(1U == curr_item->dot
-                    && SV == curr_item->production.variable()) {
+                    if(start_slot + 1U == curr_item->slot) {
                         io::verbose("Successfully parsed.\n");
                         parse_result = true;
+
+                        if(build_forest) {
+                            io::verbose("Extracting parse trees...\n");
+                            if(!extract_trees(
+                                cfg, table, curr_item, max_trees, lexemes,
+                                *trees
+                            ) && 0 != too_many_trees) {
+                                *too_many_trees = true;
+                            }
+                        }
+
                         goto done;
                     }
                 }
@@ -509,24 +1313,19 @@ namespace grail { namespace algorithm {
 
         done:
 
-            io::verbose("Cleaning up Earley items/sets...\n");
+            io::verbose("Cleaning up Earley sets...\n");
 
+            // the sets own their completion indexes
             next_set = 0;
             for(curr_set = first_set; 0 != curr_set; curr_set = next_set) {
                 next_set = curr_set->next;
-
-                for(curr_item = curr_set->first;
-                    0 != curr_item;
-                    curr_item = next_item) {
-
-                    next_item = curr_item->next;
-
-                    item_allocator.deallocate(curr_item);
-                }
-
                 set_allocator.deallocate(curr_set);
             }
 
+            for(unsigned j(0); j < lexemes.size(); ++j) {
+                traits_type::destroy(lexemes[j]);
+            }
+
             // done; clean up
             cfg.unsafe_remove_variable(SV);
 
@@ -0,0 +1,927 @@
+/*
+ * CFG_PARSE_GLR.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_PARSE_GLR_HPP_
+#define FLTL_CFG_PARSE_GLR_HPP_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/helper/BlockAllocator.hpp"
+
+#include "grail/include/algorithm/CFG_TO_LALR.hpp"
+
+#include "grail/include/cfg/ParseTree.hpp"
+#include "grail/include/cfg/build_null_tree.hpp"
+
+#include "grail/include/io/verbose.hpp"
+#include "grail/include/io/UTF8FileTokBuffer.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// parse a context-free grammar using a Tomita-style GLR parser. The
+    /// parser runs every action of the LALR(1) automaton of the grammar,
+    /// including the actions that conflict, and so the stacks of the
+    /// parser form a graph-structured stack (GSS): a node of the GSS is a
+    /// state of the automaton at some offset into the tokens, and its
+    /// links point to the nodes below it. Stacks that reach the same state
+    /// at the same offset are merged, and so on inputs that only exercise
+    /// the deterministic parts of the automaton, the GSS is a single stack
+    /// and the parser runs like an ordinary LR parser.
+    ///
+    /// Reductions are found by enumerating the paths of the GSS. When a
+    /// reduction adds a new link below a node whose reductions have already
+    /// been done, only the paths that go through the new link are reduced
+    /// again, which keeps reductions over epsilon productions correct.
+    ///
+    /// If parse trees are requested then each link is labelled with a node
+    /// of a shared packed parse forest, where a node stands for a symbol
+    /// spanning some tokens, and each of its families is a different way of
+    /// deriving it.
+    template <typename AlphaT, const unsigned MAX_TOK_LENGTH>
+    class CFG_PARSE_GLR {
+    public:
+
+        // take off the templates!
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef cfg::ParseTree<AlphaT> parse_tree_type;
+        typedef CFG_TO_LALR<AlphaT> lalr_type;
+        typedef typename lalr_type::table_type table_type;
+        typedef typename lalr_type::action_type action_type;
+        typedef typename lalr_type::action_entry_type action_entry_type;
+
+        class forest_node_type;
+
+        /// a way of deriving a forest node: a production and the forest
+        /// nodes of the symbols of the production
+        class forest_family_type {
+        public:
+            forest_family_type *next;
+            unsigned production;
+
+            // offset of the children in the child pool
+            unsigned first_child;
+
+            // number of acyclic derivations through this family; only
+            // computed when extracting trees
+            unsigned long num_derivations;
+
+            forest_family_type(void)
+                : next(0)
+                , production(0)
+                , first_child(0)
+                , num_derivations(0)
+            { }
+        };
+
+        /// node of the shared packed parse forest. a terminal node is the
+        /// token at offset start; a variable node derives the tokens in
+        /// [start, end).
+        class forest_node_type {
+        public:
+            symbol_type symbol;
+            unsigned start;
+            unsigned end;
+            forest_family_type *families;
+
+            unsigned long num_derivations;
+            unsigned visit_state;
+
+            forest_node_type(void)
+                : symbol()
+                , start(0)
+                , end(0)
+                , families(0)
+                , num_derivations(0)
+                , visit_state(0)
+            { }
+        };
+
+        class gss_node_type;
+
+        /// a link from a GSS node to a node below it; the link is
+        /// labelled by the forest node of the symbol that was shifted or
+        /// reduced in going from the lower state to the upper state.
+        class gss_link_type {
+        public:
+            gss_link_type *next;
+            gss_node_type *node;
+            forest_node_type *value;
+
+            gss_link_type(void)
+                : next(0)
+                , node(0)
+                , value(0)
+            { }
+        };
+
+        class gss_node_type {
+        public:
+            unsigned state;
+            unsigned offset;
+            gss_link_type *links;
+
+            // have the reductions of this node been done?
+            bool is_reduced;
+
+            gss_node_type(void)
+                : state(0)
+                , offset(0)
+                , links(0)
+                , is_reduced(false)
+            { }
+        };
+
+    private:
+
+        enum {
+            NUM_BLOCKS = 1024U
+        };
+
+        typedef fltl::helper::BlockAllocator<
+            gss_node_type, NUM_BLOCKS
+        > gss_node_allocator_type;
+
+        typedef fltl::helper::BlockAllocator<
+            gss_link_type, NUM_BLOCKS
+        > gss_link_allocator_type;
+
+        typedef fltl::helper::BlockAllocator<
+            forest_node_type, NUM_BLOCKS
+        > forest_node_allocator_type;
+
+        typedef fltl::helper::BlockAllocator<
+            forest_family_type, NUM_BLOCKS
+        > forest_family_allocator_type;
+
+        /// a reduction found by walking a path of the GSS, but that
+        /// hasn't yet been done
+        class path_type {
+        public:
+            unsigned production;
+            gss_node_type *node;
+            unsigned first_child;
+        };
+
+        /// everything used while parsing the tokens
+        class state_type {
+        public:
+
+            table_type table;
+
+            /// every action of each state, including the conflicting ones,
+            /// sorted by terminal
+            std::vector<std::vector<action_entry_type> > actions;
+
+            gss_node_allocator_type node_allocator;
+            gss_link_allocator_type link_allocator;
+            forest_node_allocator_type forest_allocator;
+            forest_family_allocator_type family_allocator;
+
+            bool build_forest;
+
+            /// the nodes at the current offset, and the node of each
+            /// state at the current offset
+            std::vector<gss_node_type *> frontier;
+            std::vector<gss_node_type *> node_of_state;
+
+            /// terminals that the current token could be
+            std::vector<unsigned> lookaheads;
+
+            /// reductions waiting to be done, and the children of the
+            /// forest families of those reductions
+            std::vector<path_type> paths;
+            std::vector<forest_node_type *> children;
+            std::vector<gss_link_type *> path_links;
+
+            /// forest nodes of variables ending at the current offset, by
+            /// variable and start offset
+            std::map<std::pair<unsigned, unsigned>, forest_node_type *> forest;
+
+            /// stamp of the last time that a production was reduced for a
+            /// node
+            std::vector<unsigned> reduced_stamp;
+            unsigned stamp;
+
+            /// productions used to build the empty derivations of variables
+            std::vector<production_type> null_prods;
+
+            unsigned offset;
+        };
+
+        static bool order_actions(
+            const action_entry_type &a,
+            const action_entry_type &b
+        ) throw() {
+            return a.first < b.first;
+        }
+
+        /// find the range of actions of a state on a terminal
+        static void find_actions(
+            const std::vector<action_entry_type> &row,
+            const unsigned terminal,
+            unsigned &begin,
+            unsigned &end
+        ) throw() {
+            unsigned low(0);
+            unsigned high(static_cast<unsigned>(row.size()));
+
+            while(low < high) {
+                const unsigned mid(low + (high - low) / 2U);
+                if(row[mid].first < terminal) {
+                    low = mid + 1U;
+                } else {
+                    high = mid;
+                }
+            }
+
+            begin = low;
+            for(end = low; end < row.size() && terminal == row[end].first; ) {
+                ++end;
+            }
+        }
+
+        /// find the target of a goto of a state on a variable
+        static unsigned find_goto(
+            const table_type &table,
+            const unsigned state,
+            const unsigned variable
+        ) throw() {
+            const std::vector<typename lalr_type::goto_entry_type> &
+                row(table.gotos[state]);
+
+            unsigned low(0);
+            unsigned high(static_cast<unsigned>(row.size()));
+
+            while(low < high) {
+                const unsigned mid(low + (high - low) / 2U);
+                if(row[mid].first < variable) {
+                    low = mid + 1U;
+                } else {
+                    high = mid;
+                }
+            }
+
+            assert(low < row.size() && variable == row[low].first);
+            return row[low].second;
+        }
+
+        /// add a node for a state to the frontier, or return the existing
+        /// one
+        static gss_node_type *get_node(
+            state_type &s,
+            const unsigned state,
+            bool &is_new
+        ) throw() {
+            gss_node_type *node(s.node_of_state[state]);
+            is_new = (0 == node);
+
+            if(is_new) {
+                node = s.node_allocator.allocate();
+                node->state = state;
+                node->offset = s.offset;
+                s.node_of_state[state] = node;
+                s.frontier.push_back(node);
+            }
+
+            return node;
+        }
+
+        /// find all paths of a given length that start at a node. If via
+        /// is non-null then only paths that go through the link via are
+        /// found. The links of the path are kept on s.path_links.
+        static void find_paths(
+            state_type &s,
+            const unsigned production,
+            gss_node_type *node,
+            const unsigned length,
+            gss_link_type *via,
+            bool used_via
+        ) throw() {
+            if(0U == length) {
+                if(!used_via) {
+                    return;
+                }
+
+                path_type path;
+                path.production = production;
+                path.node = node;
+                path.first_child = static_cast<unsigned>(s.children.size());
+
+                if(s.build_forest) {
+                    for(unsigned i(static_cast<unsigned>(s.path_links.size()));
+                        i-- > 0; ) {
+                        s.children.push_back(s.path_links[i]->value);
+                    }
+                }
+
+                s.paths.push_back(path);
+                return;
+            }
+
+            for(gss_link_type *link(node->links); 0 != link; link = link->next) {
+                s.path_links.push_back(link);
+                find_paths(
+                    s, production, link->node, length - 1U, via,
+                    used_via || link == via
+                );
+                s.path_links.pop_back();
+            }
+        }
+
+        /// find all reductions of a node on the current lookaheads. If via
+        /// is non-null then only reductions of paths through via are found.
+        static void find_reductions(
+            state_type &s,
+            gss_node_type *node,
+            gss_link_type *via
+        ) throw() {
+            const std::vector<action_entry_type> &row(s.actions[node->state]);
+            unsigned begin(0);
+            unsigned end(0);
+
+            ++(s.stamp);
+
+            for(unsigned i(0); i < s.lookaheads.size(); ++i) {
+                find_actions(row, s.lookaheads[i], begin, end);
+
+                for(; begin < end; ++begin) {
+                    const action_type &action(row[begin].second);
+                    if(lalr_type::ACTION_REDUCE != action.kind
+                    || s.stamp == s.reduced_stamp[action.target]) {
+                        continue;
+                    }
+
+                    s.reduced_stamp[action.target] = s.stamp;
+
+                    const unsigned length(
+                        s.table.items.production(action.target).length()
+                    );
+
+                    // reductions of epsilon productions don't go through
+                    // any links
+                    if(0 != via && 0U == length) {
+                        continue;
+                    }
+
+                    find_paths(s, action.target, node, length, via, 0 == via);
+                }
+            }
+        }
+
+        /// add a family to a forest node, unless the node already has an
+        /// identical family
+        static void add_family(
+            state_type &s,
+            forest_node_type *node,
+            const path_type &path,
+            const unsigned length
+        ) throw() {
+            for(forest_family_type *family(node->families);
+                0 != family;
+                family = family->next) {
+
+                if(family->production != path.production) {
+                    continue;
+                }
+
+                unsigned i(0);
+                for(; i < length; ++i) {
+                    if(s.children[family->first_child + i]
+                    != s.children[path.first_child + i]) {
+                        break;
+                    }
+                }
+
+                if(length == i) {
+                    return;
+                }
+            }
+
+            forest_family_type *family(s.family_allocator.allocate());
+            family->production = path.production;
+            family->first_child = path.first_child;
+            family->next = node->families;
+            node->families = family;
+        }
+
+        /// do a reduction; this might add a new link to the GSS
+        static void reduce(state_type &s, const path_type &path) throw() {
+            production_type &prod(s.table.items.production(path.production));
+            const variable_type A(prod.variable());
+            gss_node_type *below(path.node);
+
+            forest_node_type *value(0);
+
+            if(s.build_forest) {
+                forest_node_type *&slot(s.forest[
+                    std::make_pair(A.number(), below->offset)
+                ]);
+
+                if(0 == slot) {
+                    slot = s.forest_allocator.allocate();
+                    slot->symbol = A;
+                    slot->start = below->offset;
+                    slot->end = s.offset;
+                }
+
+                value = slot;
+                add_family(s, value, path, prod.length());
+            }
+
+            bool is_new(false);
+            gss_node_type *node(get_node(
+                s, find_goto(s.table, below->state, A.number()), is_new
+            ));
+
+            // there is already a link, and it is labelled with the same
+            // forest node, as both derive A from below->offset
+            for(gss_link_type *link(node->links); 0 != link; link = link->next) {
+                if(below == link->node) {
+                    return;
+                }
+            }
+
+            gss_link_type *link(s.link_allocator.allocate());
+            link->node = below;
+            link->value = value;
+            link->next = node->links;
+            node->links = link;
+
+            // redo the reductions of already-reduced nodes along the paths
+            // that go through the new link
+            if(!is_new) {
+                for(unsigned i(0); i < s.frontier.size(); ++i) {
+                    if(s.frontier[i]->is_reduced) {
+                        find_reductions(s, s.frontier[i], link);
+                    }
+                }
+            }
+        }
+
+        /// do all reductions of the frontier
+        static void reduce_all(state_type &s) throw() {
+            for(unsigned next_node(0); ; ) {
+                if(!s.paths.empty()) {
+                    path_type path(s.paths.back());
+                    s.paths.pop_back();
+                    reduce(s, path);
+
+                } else if(next_node < s.frontier.size()) {
+                    gss_node_type *node(s.frontier[next_node++]);
+                    node->is_reduced = true;
+                    find_reductions(s, node, 0);
+
+                } else {
+                    break;
+                }
+            }
+        }
+
+        enum {
+            VISIT_NONE = 0U,
+            VISIT_ACTIVE = 1U,
+            VISIT_DONE = 2U
+        };
+
+        static const unsigned long MAX_DERIVATIONS = ~0UL;
+
+        static unsigned long
+        saturating_add(const unsigned long a, const unsigned long b) throw() {
+            return (MAX_DERIVATIONS - a < b) ? MAX_DERIVATIONS : a + b;
+        }
+
+        static unsigned long
+        saturating_mul(const unsigned long a, const unsigned long b) throw() {
+            if(0 != a && MAX_DERIVATIONS / a < b) {
+                return MAX_DERIVATIONS;
+            }
+            return a * b;
+        }
+
+        /// count the derivations of a forest node. Derivations that go
+        /// through a cycle of unit productions are not counted, and a
+        /// variable that derives no tokens has exactly one derivation; the
+        /// counts are stored on the families so that extracting a tree
+        /// follows exactly the derivations that were counted.
+        static unsigned long count_derivations(
+            state_type &s,
+            forest_node_type *node
+        ) throw() {
+            if(node->symbol.is_terminal() || node->start == node->end) {
+                return 1UL;
+            } else if(VISIT_DONE == node->visit_state) {
+                return node->num_derivations;
+            } else if(VISIT_ACTIVE == node->visit_state) {
+                return 0UL;
+            }
+
+            unsigned long count(0);
+            node->visit_state = VISIT_ACTIVE;
+
+            for(forest_family_type *family(node->families);
+                0 != family;
+                family = family->next) {
+
+                const unsigned length(
+                    s.table.items.production(family->production).length()
+                );
+
+                family->num_derivations = 1UL;
+                for(unsigned i(0); i < length; ++i) {
+                    family->num_derivations = saturating_mul(
+                        family->num_derivations,
+                        count_derivations(s, s.children[family->first_child + i])
+                    );
+                }
+
+                count = saturating_add(count, family->num_derivations);
+            }
+
+            node->num_derivations = count;
+            node->visit_state = VISIT_DONE;
+            return count;
+        }
+
+        /// build the k-th derivation of a forest node
+        static parse_tree_type *build_tree(
+            state_type &s,
+            forest_node_type *node,
+            unsigned long k,
+            std::vector<alphabet_type> &lexemes
+        ) throw() {
+            if(node->symbol.is_terminal()) {
+                terminal_type T(node->symbol);
+                return new parse_tree_type(T, lexemes[node->start]);
+
+            } else if(node->start == node->end) {
+                variable_type V(node->symbol);
+                return cfg::build_null_tree<AlphaT>(V, s.null_prods);
+            }
+
+            forest_family_type *family(node->families);
+            for(; 0 != family; family = family->next) {
+                if(k < family->num_derivations) {
+                    break;
+                }
+                k -= family->num_derivations;
+            }
+
+            assert(0 != family);
+
+            parse_tree_type *tree(new parse_tree_type(
+                s.table.items.production(family->production)
+            ));
+
+            // fill in the children from right-to-left
+            for(unsigned i(s.table.items.production(family->production).length());
+                i-- > 0; ) {
+
+                forest_node_type *child(s.children[family->first_child + i]);
+                const unsigned long num_child_derivations(
+                    count_derivations(s, child)
+                );
+
+                tree->add_child(build_tree(
+                    s, child, k % num_child_derivations, lexemes
+                ));
+                k /= num_child_derivations;
+            }
+
+            return tree;
+        }
+
+        /// extract up to max_trees derivations from the parse forest. If
+        /// max_trees is 0 then all derivations are extracted, unless there
+        /// are too many to count, in which case nothing is extracted and
+        /// false is returned.
+        static bool extract_trees(
+            CFG &cfg,
+            state_type &s,
+            forest_node_type *root,
+            const unsigned long max_trees,
+            std::vector<alphabet_type> &lexemes,
+            std::vector<parse_tree_type *> &trees
+        ) throw() {
+            cfg::find_null_productions(cfg, s.null_prods);
+
+            unsigned long num_trees(count_derivations(s, root));
+
+            if(MAX_DERIVATIONS == num_trees) {
+                io::verbose("    Found too many derivations to count.\n");
+                if(0 == max_trees) {
+                    return false;
+                }
+            } else {
+                io::verbose("    Found %lu derivation(s).\n", num_trees);
+            }
+
+            if(0 != max_trees && max_trees < num_trees) {
+                num_trees = max_trees;
+            }
+
+            for(unsigned long k(0); k < num_trees; ++k) {
+                trees.push_back(build_tree(s, root, k, lexemes));
+            }
+
+            return true;
+        }
+
+    public:
+
+        /// run the parser. If trees is non-null then a parse forest is
+        /// built during parsing, and up to max_trees parse trees (all trees
+        /// if max_trees is 0) are extracted from it into trees. The caller
+        /// owns the extracted trees. If all trees are asked for but there
+        /// are too many to count, then no trees are extracted and
+        /// too_many_trees is set to true.
+        static bool run(
+            CFG &cfg,
+            io::UTF8FileTokBuffer<MAX_TOK_LENGTH> &reader,
+            std::vector<parse_tree_type *> *trees=0,
+            const unsigned long max_trees=1UL,
+            bool *too_many_trees=0
+        ) throw() {
+
+            const char *token(reader.read());
+
+            // is it worth parsing?
+            if(0 == cfg.num_productions()
+            || !cfg.has_start_variable()
+            || 0 == cfg.num_productions(cfg.get_start_variable())) {
+                if(0 == token || '\0' == *token) {
+                    io::verbose("Parsed. Accepted empty language.\n");
+                    return true;
+                } else {
+                    io::verbose("Failed to parse. Language is empty.\n");
+                    return false;
+                }
+            }
+
+            state_type s;
+            s.build_forest = (0 != trees);
+            s.stamp = 0;
+            s.offset = 0;
+
+            // build the automaton; this adds a fake start variable to the
+            // grammar, which is removed at the end
+            io::verbose("Building LALR(1) automaton...\n");
+            lalr_type::run(cfg, s.table);
+
+            const variable_type SV(
+                s.table.items.production(s.table.accept_production).variable()
+            );
+
+            const unsigned num_states(s.table.num_states());
+
+            // put back the actions that lost out in conflicts
+            s.actions.resize(num_states);
+            for(unsigned i(0); i < num_states; ++i) {
+                s.actions[i].swap(s.table.actions[i]);
+            }
+
+            for(unsigned i(0); i < s.table.conflicts.size(); ++i) {
+                s.actions[s.table.conflicts[i].state].push_back(std::make_pair(
+                    s.table.conflicts[i].terminal,
+                    s.table.conflicts[i].rejected
+                ));
+            }
+
+            for(unsigned i(0); i < num_states; ++i) {
+                std::stable_sort(
+                    s.actions[i].begin(),
+                    s.actions[i].end(),
+                    order_actions
+                );
+            }
+
+            io::verbose(
+                "    %u states, %u conflicts.\n",
+                num_states,
+                static_cast<unsigned>(s.table.conflicts.size())
+            );
+
+            std::vector<terminal_type> terminals(cfg.num_terminals() + 2U);
+            std::vector<unsigned> variable_terminals;
+            terminal_type a;
+            generator_type as(cfg.search(~a));
+            for(; as.match_next(); ) {
+                terminals[a.number()] = a;
+                if(cfg.is_variable_terminal(a)) {
+                    variable_terminals.push_back(a.number());
+                }
+            }
+
+            s.node_of_state.assign(num_states, static_cast<gss_node_type *>(0));
+            s.reduced_stamp.assign(s.table.items.num_productions(), 0U);
+
+            // copies of the lexemes, used as the leaves of parse trees
+            std::vector<alphabet_type> lexemes;
+            alphabet_type lexeme;
+
+            // leaves of the parse forest for the current token
+            std::vector<std::pair<unsigned, forest_node_type *> > leaves;
+
+            std::vector<gss_node_type *> next_frontier;
+            bool parse_result(false);
+            bool is_new(false);
+
+            forest_node_type *result(0);
+
+            // the bottom of the stack
+            get_node(s, 0U, is_new);
+
+            io::verbose("Parsing...\n");
+
+            for(;; ++(s.offset), token = reader.read()) {
+
+                s.lookaheads.clear();
+
+                if(0 == token || '\0' == *token) {
+                    io::verbose("    Looking at EOF\n");
+                    s.lookaheads.push_back(lalr_type::END_OF_INPUT);
+
+                } else {
+                    traits_type::unserialize(token, lexeme);
+
+                    if(s.build_forest) {
+                        lexemes.push_back(traits_type::copy(lexeme));
+                    }
+
+                    if(cfg.find_terminal(lexeme, a)) {
+                        s.lookaheads.push_back(a.number());
+
+                    // found a token but this grammar has no variable
+                    // terminals and so it can't be substituted for anything
+                    } else if(variable_terminals.empty()) {
+                        io::verbose(
+                            "    Unrecognized terminal '%s'.\n",
+                            token
+                        );
+                        break;
+
+                    } else {
+                        s.lookaheads = variable_terminals;
+                    }
+
+                    io::verbose("    Looking at '%s'...\n", token);
+                }
+
+                reduce_all(s);
+
+                io::verbose(
+                    "        %u stack node(s).\n",
+                    static_cast<unsigned>(s.frontier.size())
+                );
+
+                for(unsigned i(0); i < s.frontier.size(); ++i) {
+                    s.node_of_state[s.frontier[i]->state] = 0;
+                }
+
+                s.forest.clear();
+
+                // accept or shift
+                next_frontier.clear();
+                leaves.clear();
+
+                for(unsigned i(0); i < s.frontier.size(); ++i) {
+                    gss_node_type *node(s.frontier[i]);
+                    const std::vector<action_entry_type> &
+                        row(s.actions[node->state]);
+
+                    for(unsigned j(0); j < s.lookaheads.size(); ++j) {
+                        unsigned begin(0);
+                        unsigned end(0);
+                        find_actions(row, s.lookaheads[j], begin, end);
+
+                        for(; begin < end; ++begin) {
+                            const action_type &action(row[begin].second);
+
+                            if(lalr_type::ACTION_ACCEPT == action.kind) {
+                                assert(0 != node->links);
+                                result = node->links->value;
+                                parse_result = true;
+                                continue;
+
+                            } else if(lalr_type::ACTION_SHIFT != action.kind) {
+                                continue;
+                            }
+
+                            gss_node_type *target(
+                                s.node_of_state[action.target]
+                            );
+
+                            if(0 == target) {
+                                target = s.node_allocator.allocate();
+                                target->state = action.target;
+                                target->offset = s.offset + 1U;
+                                s.node_of_state[action.target] = target;
+                                next_frontier.push_back(target);
+                            }
+
+                            gss_link_type *link(s.link_allocator.allocate());
+                            link->node = node;
+                            link->next = target->links;
+                            target->links = link;
+
+                            if(!s.build_forest) {
+                                continue;
+                            }
+
+                            // share one leaf per terminal of this token
+                            unsigned k(0);
+                            for(; k < leaves.size(); ++k) {
+                                if(leaves[k].first == s.lookaheads[j]) {
+                                    break;
+                                }
+                            }
+
+                            if(k == leaves.size()) {
+                                forest_node_type *leaf(
+                                    s.forest_allocator.allocate()
+                                );
+                                leaf->symbol = terminals[s.lookaheads[j]];
+                                leaf->start = s.offset;
+                                leaf->end = s.offset + 1U;
+                                leaves.push_back(std::make_pair(
+                                    s.lookaheads[j], leaf
+                                ));
+                            }
+
+                            link->value = leaves[k].second;
+                        }
+                    }
+                }
+
+                for(unsigned i(0); i < next_frontier.size(); ++i) {
+                    s.node_of_state[next_frontier[i]->state] = 0;
+                }
+
+                s.frontier.swap(next_frontier);
+
+                if(0 == token || '\0' == *token || s.frontier.empty()) {
+                    break;
+                }
+
+                for(unsigned i(0); i < s.frontier.size(); ++i) {
+                    s.node_of_state[s.frontier[i]->state] = s.frontier[i];
+                }
+            }
+
+            if(parse_result) {
+                io::verbose("Successfully parsed.\n");
+
+                if(s.build_forest) {
+                    io::verbose("Extracting parse trees...\n");
+                    if(!extract_trees(
+                        cfg, s, result, max_trees, lexemes, *trees
+                    ) && 0 != too_many_trees) {
+                        *too_many_trees = true;
+                    }
+                }
+            } else {
+                io::verbose("Failed to parse all input.\n");
+            }
+
+            for(unsigned j(0); j < lexemes.size(); ++j) {
+                traits_type::destroy(lexemes[j]);
+            }
+
+            // done; clean up. the nodes of the GSS and of the forest are
+            // freed along with their allocators.
+            cfg.unsafe_remove_variable(SV);
+
+            io::verbose("Done.\n");
+
+            return parse_result;
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_PARSE_GLR_HPP_ */
@@ -33,6 +33,7 @@
 #include <set>
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "fltl/include/CFG.hpp"
 
@@ -73,25 +74,35 @@ namespace grail { namespace algorithm {
             variable_type tail(cfg.add_variable());
             cfg.add_production(tail, cfg.epsilon());
 
-            for(LR_productions.rewind();
-                LR_productions.match_next();
-                productions.rewind()) {
+            // collect the non-left-recursive productions up front; the
+            // generator would otherwise visit the productions that are
+            // added to A below, which themselves are not left-recursive.
+            std::vector<symbol_string_type> betas;
+            for(; productions.match_next(); ) {
+                if(!beta.is_empty() && A != beta.at(0)) {
+                    betas.push_back(beta);
+                }
+            }
+
+            bool removed_any(false);
+
+            for(LR_productions.rewind(); LR_productions.match_next(); ) {
 
                 if(alpha.is_empty()) {
                     continue;
                 }
 
                 cfg.add_production(tail, alpha + tail);
+                cfg.remove_production(LR_prod);
+                removed_any = true;
+            }
 
-                for(; productions.match_next(); ) {
-                    if(beta.is_empty() || A == beta.at(0)) {
-                        continue;
-                    }
-
-                    cfg.add_production(A, beta + tail);
-                }
+            if(!removed_any) {
+                return;
+            }
 
-                cfg.remove_production(LR_prod);
+            for(size_t i(0); i < betas.size(); ++i) {
+                cfg.add_production(A, betas[i] + tail);
             }
         }
 
@@ -84,24 +84,72 @@ namespace grail { namespace algorithm {
                 return;
             }
 
-            // find all reachable variables
-            std::vector<bool> reachable(cfg.num_variables_capacity() + 2, false);
-            reach_variable(cfg, cfg.get_start_variable(), reachable);
+            const variable_type S(cfg.get_start_variable());
 
-            // get rid of unreachable variables
+            // find all generating variables, i.e. those that have some
+            // production whose variables are all generating
+            std::vector<bool> generating(cfg.num_variables_capacity() + 2, false);
+
+            production_type P;
+            generator_type productions(cfg.search(~P));
+
+            for(bool updated(true); updated; productions.rewind()) {
+                updated = false;
+
+                for(; productions.match_next(); ) {
+                    if(generating[P.variable().number()]) {
+                        continue;
+                    }
+
+                    const unsigned len(P.length());
+                    unsigned i(0);
+                    for(; i < len; ++i) {
+                        if(P.symbol_at(i).is_variable()
+                        && !generating[variable_type(P.symbol_at(i)).number()]) {
+                            break;
+                        }
+                    }
+
+                    if(len == i) {
+                        generating[P.variable().number()] = true;
+                        updated = true;
+                    }
+                }
+            }
+
+            // the language is empty; keep only the start variable
+            if(!generating[S.number()]) {
+                for(productions.rewind(); productions.match_next(); ) {
+                    cfg.remove_production(P);
+                }
+
+                for(variables.rewind(); variables.match_next(); ) {
+                    if(S != V) {
+                        cfg.unsafe_remove_variable(V);
+                    }
+                }
+                return;
+            }
+
+            // get rid of non-generating variables; the start variable is
+            // generating, and so it is never removed
             for(variables.rewind();
                 variables.match_next(); ) {
 
-                if(!(reachable[V.number()])) {
+                if(!(generating[V.number()])) {
                     cfg.remove_variable(V);
                 }
             }
 
-            // get rid of non-generating variables
+            // find all reachable variables
+            std::vector<bool> reachable(cfg.num_variables_capacity() + 2, false);
+            reach_variable(cfg, S, reachable);
+
+            // get rid of unreachable variables
             for(variables.rewind();
                 variables.match_next(); ) {
 
-                if(0 == cfg.num_productions(V)) {
+                if(!(reachable[V.number()])) {
                     cfg.remove_variable(V);
                 }
             }
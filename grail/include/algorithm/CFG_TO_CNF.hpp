@@ -124,6 +124,60 @@ namespace grail { namespace algorithm {
             }
         }
 
+        // replace every use of a variable in vars_to_replace with the
+        // variable that it maps to, then remove the replaced variables.
+        inline static void replace_variables(
+            CFG &cfg,
+            std::map<variable_type, variable_type> &vars_to_replace
+        ) throw() {
+
+            production_type P;
+            symbol_string_type str;
+            variable_type A;
+            variable_type B;
+
+            generator_type pairs(cfg.search(~P, cfg._ --->* cfg._ + cfg._));
+            for(; pairs.match_next(); ) {
+                if(vars_to_replace.count(P.variable())) {
+                    continue;
+                }
+
+                str = P.symbols();
+
+                if(str.at(0).is_terminal() || str.at(1).is_terminal()) {
+                    continue;
+                }
+
+                A = str.at(0);
+                B = str.at(1);
+
+                const bool replace_first(0 != vars_to_replace.count(A));
+                const bool replace_second(0 != vars_to_replace.count(B));
+
+                if(!replace_first && !replace_second) {
+                    continue;
+                }
+
+                if(replace_first) {
+                    A = vars_to_replace[A];
+                }
+
+                if(replace_second) {
+                    B = vars_to_replace[B];
+                }
+
+                cfg.remove_production(P);
+                cfg.add_production(P.variable(), A + B);
+            }
+
+            typename std::map<variable_type, variable_type>::iterator
+                it(vars_to_replace.begin());
+
+            for(; it != vars_to_replace.end(); ++it) {
+                cfg.unsafe_remove_variable(it->first);
+            }
+        }
+
     public:
 
         /// convert a context-free grammar to chomsky normal form.
@@ -165,17 +219,26 @@ namespace grail { namespace algorithm {
 
             generator_type terminal_units(cfg.search(~P, (~A) --->* T));
 
+            // the start variable can't be merged with any other variable,
+            // as it can't appear on the RHS of any production. note: removing
+            // epsilon productions might have changed the start variable.
+            const variable_type start_var(cfg.get_start_variable());
+
             for(; terminal_units.match_next(); ) {
-                if(1 == cfg.num_productions(A)) {
+                if(1 == cfg.num_productions(A) && start_var != A) {
                     if(1 == terminal_rules.count(T)) {
                         vars_to_replace[A] = terminal_rules[T];
-                        cfg.unsafe_remove_variable(A);
                     } else {
                         terminal_rules[T] = A;
                     }
                 }
             }
 
+            if(!vars_to_replace.empty()) {
+                io::verbose("Merging variables that generate the same terminal...\n");
+                replace_variables(cfg, vars_to_replace);
+            }
+
             io::verbose("Updating non-unit productions with terminals...\n");
 
             clean_up_terminals(cfg, terminal_rules, vars_to_replace);
@@ -0,0 +1,570 @@
+/*
+ * CFG_TO_LALR.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CFG_TO_LALR_HPP_
+#define FLTL_CFG_TO_LALR_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/helper/BitMatrix.hpp"
+
+#include "grail/include/cfg/ItemTable.hpp"
+#include "grail/include/cfg/SetDataflow.hpp"
+#include "grail/include/cfg/compute_null_set.hpp"
+
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// build the LALR(1) parse tables of a context-free grammar. The LR(0)
+    /// automaton is built over the items of a cfg::ItemTable, and then the
+    /// lookaheads of its reductions are computed with the relations of
+    /// DeRemer and Pennello:
+    ///
+    ///     Read(p, A)   = DR(p, A) u { Read(r, C) | (p, A) reads (r, C) }
+    ///     Follow(p, A) = Read(p, A) u { Follow(q, B) | (p, A) includes (q, B) }
+    ///     LA(q, A -> w) = { Follow(p, A) | (q, A -> w) lookback (p, A) }
+    ///
+    /// Both Read and Follow are systems of set equations, and are solved
+    /// with a cfg::SetDataflow over the variable transitions of the
+    /// automaton.
+    ///
+    /// Conflicts are resolved in favour of shifting, and then in favour of
+    /// reducing by the production that comes first in the item table; every
+    /// conflict is recorded in the table.
+    ///
+    /// Note: this adds a new start variable S' --> S to the grammar. The
+    ///       end of the input is terminal number zero.
+    template <typename AlphaT>
+    class CFG_TO_LALR {
+    public:
+
+        // take off the templates!
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef cfg::ItemTable<AlphaT> item_table_type;
+        typedef typename item_table_type::item_type table_item_type;
+
+        enum {
+            END_OF_INPUT = 0U
+        };
+
+        typedef enum {
+            ACTION_ERROR,
+            ACTION_SHIFT,
+            ACTION_REDUCE,
+            ACTION_ACCEPT
+        } action_kind;
+
+        /// a parser action. the target of a shift is a state, and the
+        /// target of a reduction is a production of the item table.
+        class action_type {
+        public:
+            action_kind kind;
+            unsigned target;
+
+            action_type(void) throw()
+                : kind(ACTION_ERROR)
+                , target(0)
+            { }
+
+            action_type(action_kind kind_, unsigned target_) throw()
+                : kind(kind_)
+                , target(target_)
+            { }
+        };
+
+        /// two actions of a state that conflict on some terminal
+        class conflict_type {
+        public:
+            unsigned state;
+            unsigned terminal;
+            action_type chosen;
+            action_type rejected;
+        };
+
+        typedef std::pair<unsigned, action_type> action_entry_type;
+        typedef std::pair<unsigned, unsigned> goto_entry_type;
+
+        /// the LALR(1) tables
+        class table_type {
+        public:
+
+            item_table_type items;
+
+            /// the production S' --> S of the new start variable
+            unsigned accept_production;
+
+            /// the kernel items of each state
+            std::vector<std::vector<unsigned> > kernels;
+
+            /// the non-error actions of each state, sorted by terminal
+            std::vector<std::vector<action_entry_type> > actions;
+
+            /// the gotos of each state, sorted by variable
+            std::vector<std::vector<goto_entry_type> > gotos;
+
+            std::vector<conflict_type> conflicts;
+
+            inline unsigned num_states(void) const throw() {
+                return static_cast<unsigned>(kernels.size());
+            }
+        };
+
+    private:
+
+        /// a transition of the LR(0) automaton on a symbol. symbols are
+        /// keyed so that terminals and variables with the same number
+        /// don't collide.
+        class transition_type {
+        public:
+            unsigned symbol;
+            unsigned target;
+
+            /// index of a variable transition
+            unsigned index;
+
+            bool operator<(const transition_type &that) const throw() {
+                return symbol < that.symbol;
+            }
+        };
+
+        inline static unsigned terminal_key(unsigned t) throw() {
+            return t << 1U;
+        }
+
+        inline static unsigned variable_key(unsigned v) throw() {
+            return (v << 1U) | 1U;
+        }
+
+        inline static unsigned item_key(const table_item_type &item) throw() {
+            if(item_table_type::ITEM_PREDICT == item.kind) {
+                return variable_key(item.number);
+            }
+            return terminal_key(item.number);
+        }
+
+        /// find the transition of a state on a symbol
+        static const transition_type *find_transition(
+            const std::vector<transition_type> &trans,
+            unsigned key
+        ) throw() {
+            transition_type probe;
+            probe.symbol = key;
+
+            typename std::vector<transition_type>::const_iterator it(
+                std::lower_bound(trans.begin(), trans.end(), probe)
+            );
+
+            if(it == trans.end() || it->symbol != key) {
+                return 0;
+            }
+
+            return &(*it);
+        }
+
+    public:
+
+        /// compute the closure of a set of kernel items. seen_items and
+        /// seen_vars should be zero-filled and sized to the number of
+        /// items and variables of the table, and stamp should be non-zero
+        /// and unique to this call.
+        static void closure(
+            const item_table_type &items,
+            const std::vector<unsigned> &kernel,
+            std::vector<unsigned> &closed,
+            std::vector<unsigned> &seen_items,
+            std::vector<unsigned> &seen_vars,
+            unsigned stamp
+        ) throw() {
+            closed.assign(kernel.begin(), kernel.end());
+
+            for(unsigned i(0); i < closed.size(); ++i) {
+                seen_items[closed[i]] = stamp;
+            }
+
+            for(unsigned i(0); i < closed.size(); ++i) {
+                const table_item_type &item(items.item(closed[i]));
+
+                if(item_table_type::ITEM_PREDICT != item.kind
+                || stamp == seen_vars[item.number]) {
+                    continue;
+                }
+
+                seen_vars[item.number] = stamp;
+
+                for(unsigned p(items.productions_begin(item.number));
+                    p < items.productions_end(item.number);
+                    ++p) {
+
+                    const unsigned first(items.first_item(p));
+                    if(stamp != seen_items[first]) {
+                        seen_items[first] = stamp;
+                        closed.push_back(first);
+                    }
+                }
+            }
+        }
+
+        static void run(CFG &cfg, table_type &table) throw() {
+
+            // augment the grammar
+            const variable_type old_start(cfg.get_start_variable());
+            const variable_type new_start(cfg.add_variable());
+            cfg.add_production(new_start, old_start);
+
+            std::vector<bool> nullable;
+            cfg::compute_null_set(cfg, nullable);
+
+            item_table_type &items(table.items);
+            items.build(cfg);
+
+            table.accept_production = items.productions_begin(
+                new_start.number()
+            );
+
+            const unsigned num_items(items.num_items());
+            const unsigned num_vars(cfg.num_variables_capacity() + 2U);
+            const unsigned num_terms(cfg.num_terminals() + 2U);
+
+            // can the symbols after the dot of each item derive epsilon?
+            std::vector<bool> nullable_suffix(num_items, false);
+            for(unsigned i(num_items); i-- > 0; ) {
+                const table_item_type &item(items.item(i));
+                if(item_table_type::ITEM_COMPLETE == item.kind) {
+                    nullable_suffix[i] = true;
+                } else if(item_table_type::ITEM_PREDICT == item.kind) {
+                    nullable_suffix[i] = nullable[item.number]
+                                      && nullable_suffix[i + 1U];
+                }
+            }
+
+            io::verbose("Building LR(0) automaton...\n");
+
+            std::vector<std::vector<unsigned> > &kernels(table.kernels);
+            std::map<std::vector<unsigned>, unsigned> state_ids;
+
+            // transitions of each state on terminals and on variables, and
+            // the productions reduced in each state
+            std::vector<std::vector<transition_type> > term_trans;
+            std::vector<std::vector<transition_type> > var_trans;
+            std::vector<std::vector<unsigned> > reductions;
+            std::vector<unsigned> accept_states;
+
+            // the source state and variable of each variable transition
+            std::vector<unsigned> trans_source;
+            std::vector<unsigned> trans_target;
+            std::vector<unsigned> trans_variable;
+
+            std::vector<unsigned> seen_items(num_items, 0U);
+            std::vector<unsigned> seen_vars(num_vars, 0U);
+            std::vector<unsigned> closed;
+            std::vector<std::pair<unsigned, unsigned> > moves;
+            std::vector<unsigned> next_kernel;
+
+            kernels.push_back(
+                std::vector<unsigned>(1U, items.first_item(table.accept_production))
+            );
+            state_ids[kernels.back()] = 0U;
+
+            for(unsigned s(0); s < kernels.size(); ++s) {
+
+                const std::vector<unsigned> kernel(kernels[s]);
+                closure(items, kernel, closed, seen_items, seen_vars, s + 1U);
+
+                term_trans.push_back(std::vector<transition_type>());
+                var_trans.push_back(std::vector<transition_type>());
+                reductions.push_back(std::vector<unsigned>());
+
+                // move the dot of every item over the next symbol, and
+                // group the moved items by that symbol
+                moves.clear();
+                for(unsigned i(0); i < closed.size(); ++i) {
+                    const table_item_type &item(items.item(closed[i]));
+
+                    if(item_table_type::ITEM_COMPLETE == item.kind) {
+                        if(table.accept_production == item.production) {
+                            accept_states.push_back(s);
+                        } else {
+                            reductions[s].push_back(item.production);
+                        }
+                        continue;
+                    }
+
+                    moves.push_back(std::make_pair(item_key(item), closed[i] + 1U));
+                }
+
+                std::sort(moves.begin(), moves.end());
+                std::sort(reductions[s].begin(), reductions[s].end());
+
+                for(unsigned i(0); i < moves.size(); ) {
+                    const unsigned key(moves[i].first);
+
+                    next_kernel.clear();
+                    for(; i < moves.size() && key == moves[i].first; ++i) {
+                        next_kernel.push_back(moves[i].second);
+                    }
+
+                    unsigned target(static_cast<unsigned>(kernels.size()));
+                    typename std::map<std::vector<unsigned>, unsigned>::iterator
+                        it(state_ids.find(next_kernel));
+
+                    if(it == state_ids.end()) {
+                        state_ids[next_kernel] = target;
+                        kernels.push_back(next_kernel);
+                    } else {
+                        target = it->second;
+                    }
+
+                    transition_type trans;
+                    trans.symbol = key;
+                    trans.target = target;
+                    trans.index = 0;
+
+                    if(0U == (key & 1U)) {
+                        term_trans[s].push_back(trans);
+                    } else {
+                        trans.index = static_cast<unsigned>(trans_source.size());
+                        trans_source.push_back(s);
+                        trans_target.push_back(target);
+                        trans_variable.push_back(key >> 1U);
+                        var_trans[s].push_back(trans);
+                    }
+                }
+            }
+
+            state_ids.clear();
+
+            const unsigned num_states(table.num_states());
+            const unsigned num_trans(static_cast<unsigned>(trans_source.size()));
+
+            io::verbose("Computing LALR(1) lookaheads...\n");
+
+            // Read sets; a variable transition directly reads the
+            // terminals that can be shifted after it, and reads what the
+            // transitions on nullable variables after it read
+            cfg::SetDataflow read(num_trans, num_terms);
+            for(unsigned x(0); x < num_trans; ++x) {
+                const unsigned r(trans_target[x]);
+
+                for(unsigned i(0); i < term_trans[r].size(); ++i) {
+                    read.add_element(x, term_trans[r][i].symbol >> 1U);
+                }
+
+                if(0U == trans_source[x]
+                && old_start.number() == trans_variable[x]) {
+                    read.add_element(x, END_OF_INPUT);
+                }
+
+                for(unsigned i(0); i < var_trans[r].size(); ++i) {
+                    const transition_type &next(var_trans[r][i]);
+                    if(nullable[next.symbol >> 1U]) {
+                        read.add_dependency(x, next.index);
+                    }
+                }
+            }
+
+            read.solve();
+
+            // Follow sets, and the lookback relation between the
+            // reductions of each state and variable transitions
+            cfg::SetDataflow follow(num_trans, num_terms);
+
+            std::vector<unsigned> first_reduction(num_states + 1U, 0U);
+            for(unsigned s(0); s < num_states; ++s) {
+                first_reduction[s + 1U] = first_reduction[s]
+                                        + static_cast<unsigned>(reductions[s].size());
+            }
+
+            std::vector<std::pair<unsigned, unsigned> > lookbacks;
+
+            for(unsigned x(0); x < num_trans; ++x) {
+                follow.add_elements(x, read.solution(), x);
+
+                const unsigned B(trans_variable[x]);
+
+                for(unsigned p(items.productions_begin(B));
+                    p < items.productions_end(B);
+                    ++p) {
+
+                    // walk the production from the source of the
+                    // transition
+                    unsigned q(trans_source[x]);
+                    unsigned it(items.first_item(p));
+
+                    for(; ; ++it) {
+                        const table_item_type &item(items.item(it));
+                        if(item_table_type::ITEM_COMPLETE == item.kind) {
+                            break;
+                        }
+
+                        const std::vector<transition_type> &trans(
+                            item_table_type::ITEM_PREDICT == item.kind
+                                ? var_trans[q]
+                                : term_trans[q]
+                        );
+
+                        const transition_type *t(
+                            find_transition(trans, item_key(item))
+                        );
+                        assert(0 != t);
+
+                        // (q, A) includes (p', B)
+                        if(item_table_type::ITEM_PREDICT == item.kind
+                        && nullable_suffix[it + 1U]) {
+                            follow.add_dependency(t->index, x);
+                        }
+
+                        q = t->target;
+                    }
+
+                    const std::vector<unsigned> &reduced(reductions[q]);
+                    const unsigned r(static_cast<unsigned>(
+                        std::lower_bound(reduced.begin(), reduced.end(), p)
+                        - reduced.begin()
+                    ));
+
+                    assert(r < reduced.size() && p == reduced[r]);
+                    lookbacks.push_back(std::make_pair(first_reduction[q] + r, x));
+                }
+            }
+
+            follow.solve();
+
+            fltl::helper::BitMatrix lookahead(
+                first_reduction[num_states],
+                num_terms
+            );
+
+            for(unsigned i(0); i < lookbacks.size(); ++i) {
+                lookahead.union_rows(
+                    lookbacks[i].first,
+                    follow.solution(),
+                    lookbacks[i].second
+                );
+            }
+
+            io::verbose("Filling in the parse table...\n");
+
+            table.actions.assign(num_states, std::vector<action_entry_type>());
+            table.gotos.assign(num_states, std::vector<goto_entry_type>());
+            table.conflicts.clear();
+
+            std::vector<action_type> row(num_terms);
+            std::vector<unsigned> used;
+            unsigned next_accept(0);
+
+            for(unsigned s(0); s < num_states; ++s) {
+                used.clear();
+
+                for(unsigned i(0); i < term_trans[s].size(); ++i) {
+                    const unsigned t(term_trans[s][i].symbol >> 1U);
+                    row[t] = action_type(ACTION_SHIFT, term_trans[s][i].target);
+                    used.push_back(t);
+                }
+
+                if(next_accept < accept_states.size()
+                && s == accept_states[next_accept]) {
+                    ++next_accept;
+                    add_action(
+                        table, s, END_OF_INPUT,
+                        action_type(ACTION_ACCEPT, 0), row, used
+                    );
+                }
+
+                for(unsigned r(0); r < reductions[s].size(); ++r) {
+                    const unsigned la(first_reduction[s] + r);
+                    const action_type reduce(ACTION_REDUCE, reductions[s][r]);
+
+                    for(unsigned t(lookahead.next(la, 0U));
+                        t < num_terms;
+                        t = lookahead.next(la, t + 1U)) {
+                        add_action(table, s, t, reduce, row, used);
+                    }
+                }
+
+                std::sort(used.begin(), used.end());
+                for(unsigned i(0); i < used.size(); ++i) {
+                    table.actions[s].push_back(
+                        std::make_pair(used[i], row[used[i]])
+                    );
+                    row[used[i]] = action_type();
+                }
+
+                for(unsigned i(0); i < var_trans[s].size(); ++i) {
+                    table.gotos[s].push_back(std::make_pair(
+                        var_trans[s][i].symbol >> 1U,
+                        var_trans[s][i].target
+                    ));
+                }
+            }
+        }
+
+    private:
+
+        /// add an action to a row of the action table, resolving any
+        /// conflict with the action that is already there
+        static void add_action(
+            table_type &table,
+            unsigned state,
+            unsigned terminal,
+            const action_type &action,
+            std::vector<action_type> &row,
+            std::vector<unsigned> &used
+        ) throw() {
+            action_type &cell(row[terminal]);
+
+            if(ACTION_ERROR == cell.kind) {
+                cell = action;
+                used.push_back(terminal);
+                return;
+            }
+
+            conflict_type conflict;
+            conflict.state = state;
+            conflict.terminal = terminal;
+            conflict.chosen = cell;
+            conflict.rejected = action;
+
+            // reduce/reduce; prefer the earlier production
+            if(ACTION_REDUCE == cell.kind
+            && ACTION_REDUCE == action.kind
+            && action.target < cell.target) {
+                conflict.chosen = action;
+                conflict.rejected = cell;
+                cell = action;
+            }
+
+            table.conflicts.push_back(conflict);
+        }
+    };
+}}
+
+#endif /* FLTL_CFG_TO_LALR_HPP_ */
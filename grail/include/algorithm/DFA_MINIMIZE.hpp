@@ -0,0 +1,491 @@
+/*
+ * DFA_MINIMIZE.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_DFA_MINIMIZE_HPP_
+#define FLTL_DFA_MINIMIZE_HPP_
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/NFA.hpp"
+
+#include "grail/include/algorithm/NFA_TO_DFA.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// minimize a (possibly partial) DFA using the partition refinement
+    /// algorithm of Valmari and Lehtinen, which runs in O(m log n) time for
+    /// a DFA with n states and m transitions. states that are unreachable
+    /// or that can't reach an accepting state are removed first.
+    ///
+    /// accepting states of different tokens are never merged, so a DFA
+    /// that recognizes several named tokens (see NFA_TO_DFA) stays able to
+    /// tell them apart.
+    template <typename AlphaT>
+    class DFA_MINIMIZE {
+    private:
+
+        typedef fltl::NFA<AlphaT> NFA;
+
+        FLTL_NFA_USE_TYPES(NFA);
+
+        /// a refinable partition of the integers [0, n). the elements of
+        /// set s are elements[first[s]] up to elements[past[s]], and the
+        /// marked elements of a set are kept at the front of its range.
+        class partition_type {
+        public:
+
+            unsigned num_sets;
+            std::vector<unsigned> elements;
+            std::vector<unsigned> location;
+            std::vector<unsigned> set_of;
+            std::vector<unsigned> first;
+            std::vector<unsigned> past;
+
+            /// shared by both partitions; see DFA_MINIMIZE::run
+            std::vector<unsigned> *marked;
+            std::vector<unsigned> *touched;
+            unsigned *num_touched;
+
+            void init(unsigned n) throw() {
+                num_sets = 0U == n ? 0U : 1U;
+                elements.resize(n);
+                location.resize(n);
+                set_of.assign(n, 0U);
+                first.assign(n + 1U, 0U);
+                past.assign(n + 1U, 0U);
+
+                for(unsigned i(0); i < n; ++i) {
+                    elements[i] = i;
+                    location[i] = i;
+                }
+
+                past[0] = n;
+            }
+
+            void mark(unsigned e) throw() {
+                const unsigned s(set_of[e]);
+                const unsigned i(location[e]);
+                const unsigned j(first[s] + (*marked)[s]);
+
+                elements[i] = elements[j];
+                location[elements[i]] = i;
+                elements[j] = e;
+                location[e] = j;
+
+                if(0U == (*marked)[s]++) {
+                    (*touched)[(*num_touched)++] = s;
+                }
+            }
+
+            /// split every touched set into its marked and unmarked
+            /// elements; the smaller part becomes the new set.
+            void split(void) throw() {
+                for(; 0U < *num_touched; ) {
+                    const unsigned s((*touched)[--(*num_touched)]);
+                    const unsigned j(first[s] + (*marked)[s]);
+
+                    if(j == past[s]) {
+                        (*marked)[s] = 0U;
+                        continue;
+                    }
+
+                    if((*marked)[s] <= (past[s] - j)) {
+                        first[num_sets] = first[s];
+                        past[num_sets] = first[s] = j;
+                    } else {
+                        past[num_sets] = past[s];
+                        first[num_sets] = past[s] = j;
+                    }
+
+                    for(unsigned i(first[num_sets]); i < past[num_sets]; ++i) {
+                        set_of[elements[i]] = num_sets;
+                    }
+
+                    (*marked)[s] = 0U;
+                    (*marked)[num_sets++] = 0U;
+                }
+            }
+        };
+
+        /// the transitions of the DFA, as parallel arrays
+        struct transitions_type {
+        public:
+            std::vector<unsigned> tail;
+            std::vector<unsigned> label;
+            std::vector<unsigned> head;
+            unsigned size;
+        };
+
+        /// order transitions by their label
+        struct label_order {
+        public:
+            const std::vector<unsigned> *label;
+
+            bool operator()(unsigned a, unsigned b) const throw() {
+                return (*label)[a] < (*label)[b];
+            }
+        };
+
+        /// order states by the names of their tokens
+        struct token_order {
+        public:
+            const std::vector<const char *> *name;
+
+            static int compare(const char *a, const char *b) throw() {
+                const char *a_end(NFA_TO_DFA<AlphaT>::token_end(a));
+                const char *b_end(NFA_TO_DFA<AlphaT>::token_end(b));
+                const size_t a_len(static_cast<size_t>(a_end - a));
+                const size_t b_len(static_cast<size_t>(b_end - b));
+                const int cmp(strncmp(a, b, std::min(a_len, b_len)));
+
+                if(0 != cmp) {
+                    return cmp;
+                }
+
+                return a_len < b_len ? -1 : (a_len > b_len ? 1 : 0);
+            }
+
+            bool operator()(unsigned a, unsigned b) const throw() {
+                return compare((*name)[a], (*name)[b]) < 0;
+            }
+        };
+
+        /// index the transitions with tails (or heads) `key` by state: the
+        /// transitions of state q are adjacent[offset[q]] up to
+        /// adjacent[offset[q + 1]].
+        static void make_adjacent(
+            const std::vector<unsigned> &key,
+            unsigned num_transitions,
+            unsigned num_states,
+            std::vector<unsigned> &adjacent,
+            std::vector<unsigned> &offset
+        ) throw() {
+            offset.assign(num_states + 1U, 0U);
+            adjacent.resize(num_transitions);
+
+            for(unsigned t(0); t < num_transitions; ++t) {
+                ++(offset[key[t]]);
+            }
+
+            for(unsigned q(0); q < num_states; ++q) {
+                offset[q + 1U] += offset[q];
+            }
+
+            for(unsigned t(num_transitions); t-- > 0U; ) {
+                adjacent[--(offset[key[t]])] = t;
+            }
+        }
+
+        /// move a state into the prefix of reached states of the first
+        /// block of `blocks`
+        static void reach(
+            partition_type &blocks,
+            unsigned q,
+            unsigned &num_reached
+        ) throw() {
+            const unsigned i(blocks.location[q]);
+            if(i >= num_reached) {
+                blocks.elements[i] = blocks.elements[num_reached];
+                blocks.location[blocks.elements[i]] = i;
+                blocks.elements[num_reached] = q;
+                blocks.location[q] = num_reached++;
+            }
+        }
+
+        /// remove the states that aren't reachable from the already
+        /// reached states, following transitions from `from` to `to`, and
+        /// remove their transitions.
+        static void remove_unreachable(
+            partition_type &blocks,
+            transitions_type &trans,
+            std::vector<unsigned> &from,
+            std::vector<unsigned> &to,
+            unsigned num_states,
+            unsigned &num_reached
+        ) throw() {
+            std::vector<unsigned> adjacent;
+            std::vector<unsigned> offset;
+            make_adjacent(from, trans.size, num_states, adjacent, offset);
+
+            for(unsigned i(0); i < num_reached; ++i) {
+                const unsigned q(blocks.elements[i]);
+                for(unsigned j(offset[q]); j < offset[q + 1U]; ++j) {
+                    reach(blocks, to[adjacent[j]], num_reached);
+                }
+            }
+
+            unsigned j(0);
+            for(unsigned t(0); t < trans.size; ++t) {
+                if(blocks.location[from[t]] < num_reached) {
+                    trans.head[j] = trans.head[t];
+                    trans.label[j] = trans.label[t];
+                    trans.tail[j] = trans.tail[t];
+                    ++j;
+                }
+            }
+
+            trans.size = j;
+            blocks.past[0] = num_reached;
+            num_reached = 0U;
+        }
+
+    public:
+
+        /// returns true if no state has an epsilon transition or two
+        /// transitions on the same symbol
+        static bool is_deterministic(const NFA &dfa) throw() {
+            std::vector<std::pair<unsigned, unsigned> > moves;
+
+            transition_type trans;
+            generator_type transitions(dfa.search(~trans));
+            for(; transitions.match_next(); ) {
+                if(dfa.epsilon() == trans.read()) {
+                    return false;
+                }
+
+                moves.push_back(std::make_pair(
+                    trans.source().number(),
+                    trans.read().number()
+                ));
+            }
+
+            std::sort(moves.begin(), moves.end());
+            return moves.end() == std::adjacent_find(
+                moves.begin(),
+                moves.end()
+            );
+        }
+
+        /// build the minimal DFA equivalent to `dfa` in `min`, which is
+        /// assumed to be empty.
+        static void run(const NFA &dfa, NFA &min) throw() {
+            assert(is_deterministic(dfa));
+
+            const unsigned num_states(dfa.num_states_capacity());
+
+            transitions_type trans;
+            std::vector<bool> is_accept(num_states, false);
+            std::vector<const char *> names(num_states, "");
+            std::vector<symbol_type> min_symbols(dfa.num_symbols() + 1U);
+
+            state_type state;
+            generator_type states(dfa.search(~state));
+            for(; states.match_next(); ) {
+                if(dfa.is_accept_state(state)) {
+                    is_accept[state.number()] = true;
+                    names[state.number()] = dfa.get_name(state);
+                }
+            }
+
+            symbol_type sym;
+            generator_type symbols(dfa.search(~sym));
+            for(; symbols.match_next(); ) {
+                if(dfa.is_in_input_alphabet(sym)) {
+                    min_symbols[sym.number()] = min.get_symbol(
+                        dfa.get_alpha(sym)
+                    );
+                }
+            }
+
+            transition_type t;
+            generator_type transitions(dfa.search(~t));
+            for(; transitions.match_next(); ) {
+                trans.tail.push_back(t.source().number());
+                trans.label.push_back(t.read().number());
+                trans.head.push_back(t.sink().number());
+            }
+
+            trans.size = static_cast<unsigned>(trans.tail.size());
+
+            std::vector<unsigned> marked(
+                std::max(num_states, trans.size) + 1U, 0U
+            );
+            std::vector<unsigned> touched(marked.size(), 0U);
+            unsigned num_touched(0);
+
+            partition_type blocks;
+            partition_type cords;
+
+            blocks.marked = cords.marked = &marked;
+            blocks.touched = cords.touched = &touched;
+            blocks.num_touched = cords.num_touched = &num_touched;
+
+            // remove the states that can't be reached from the start state,
+            // then the states that can't reach an accepting state. after
+            // this, the accepting states are the first num_accept elements
+            // of the first block.
+            blocks.init(num_states);
+
+            unsigned num_reached(0);
+            const unsigned start(dfa.get_start_state().number());
+            reach(blocks, start, num_reached);
+            remove_unreachable(
+                blocks, trans, trans.tail, trans.head, num_states, num_reached
+            );
+
+            for(unsigned q(0); q < num_states; ++q) {
+                if(is_accept[q] && blocks.location[q] < blocks.past[0]) {
+                    reach(blocks, q, num_reached);
+                }
+            }
+
+            const unsigned num_accept(num_reached);
+            remove_unreachable(
+                blocks, trans, trans.head, trans.tail, num_states, num_reached
+            );
+
+            // the language is empty
+            if(0U == num_accept) {
+                return;
+            }
+
+            // split the accepting states from the rest, and then split the
+            // accepting states by their tokens
+            marked[0] = num_accept;
+            touched[num_touched++] = 0U;
+            blocks.split();
+
+            std::vector<unsigned> accepting(
+                blocks.elements.begin(),
+                blocks.elements.begin() + num_accept
+            );
+
+            token_order by_token;
+            by_token.name = &names;
+            std::sort(accepting.begin(), accepting.end(), by_token);
+
+            for(unsigned i(0), j(0); i < num_accept; i = j) {
+                for(j = i; j < num_accept
+                        && 0 == token_order::compare(
+                            names[accepting[i]], names[accepting[j]]
+                        );
+                    ++j) {
+                    blocks.mark(accepting[j]);
+                }
+                blocks.split();
+            }
+
+            // make the initial partition of the transitions by label
+            cords.init(trans.size);
+
+            if(0U < trans.size) {
+                label_order by_label;
+                by_label.label = &trans.label;
+                std::sort(
+                    cords.elements.begin(),
+                    cords.elements.begin() + trans.size,
+                    by_label
+                );
+
+                cords.num_sets = 0U;
+                marked[0] = 0U;
+
+                unsigned label(trans.label[cords.elements[0]]);
+                for(unsigned i(0); i < trans.size; ++i) {
+                    const unsigned e(cords.elements[i]);
+                    if(trans.label[e] != label) {
+                        label = trans.label[e];
+                        cords.past[cords.num_sets++] = i;
+                        cords.first[cords.num_sets] = i;
+                        marked[cords.num_sets] = 0U;
+                    }
+
+                    cords.set_of[e] = cords.num_sets;
+                    cords.location[e] = i;
+                }
+
+                cords.past[cords.num_sets++] = trans.size;
+            }
+
+            // split the blocks by the cords, and the cords by the blocks,
+            // until neither changes
+            std::vector<unsigned> incoming;
+            std::vector<unsigned> offset;
+            make_adjacent(trans.head, trans.size, num_states, incoming, offset);
+
+            for(unsigned b(1U), c(0U); c < cords.num_sets; ) {
+                for(unsigned i(cords.first[c]); i < cords.past[c]; ++i) {
+                    blocks.mark(trans.tail[cords.elements[i]]);
+                }
+
+                blocks.split();
+                ++c;
+
+                for(; b < blocks.num_sets; ++b) {
+                    for(unsigned i(blocks.first[b]); i < blocks.past[b]; ++i) {
+                        const unsigned q(blocks.elements[i]);
+                        for(unsigned j(offset[q]); j < offset[q + 1U]; ++j) {
+                            cords.mark(incoming[j]);
+                        }
+                    }
+
+                    cords.split();
+                }
+            }
+
+            // build the minimal DFA. the block containing the start state
+            // becomes the start state of `min`.
+            const unsigned start_block(blocks.set_of[start]);
+            std::vector<state_type> min_states(blocks.num_sets);
+            helper::CStringMap<unsigned> num_named;
+
+            for(unsigned b(0); b < blocks.num_sets; ++b) {
+                if(b == start_block) {
+                    min_states[b] = min.get_start_state();
+                } else {
+                    min_states[b] = min.add_state();
+                }
+
+                // the accepting states are the first elements of the
+                // first block
+                if(blocks.first[b] < num_accept) {
+                    min.add_accept_state(min_states[b]);
+
+                    const char *name(names[blocks.elements[blocks.first[b]]]);
+                    if('\0' != name[0]) {
+                        NFA_TO_DFA<AlphaT>::name_state(
+                            min, min_states[b], name, num_named
+                        );
+                    }
+                }
+            }
+
+            // only keep the transitions of one state of each block
+            for(unsigned i(0); i < trans.size; ++i) {
+                const unsigned q(trans.tail[i]);
+                if(blocks.location[q] == blocks.first[blocks.set_of[q]]) {
+                    min.add_transition(
+                        min_states[blocks.set_of[q]],
+                        min_symbols[trans.label[i]],
+                        min_states[blocks.set_of[trans.head[i]]]
+                    );
+                }
+            }
+        }
+    };
+
+}}
+
+#endif /* FLTL_DFA_MINIMIZE_HPP_ */
@@ -0,0 +1,122 @@
+/*
+ * NFA_EXPAND_BYTES.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_NFA_EXPAND_BYTES_HPP_
+#define FLTL_NFA_EXPAND_BYTES_HPP_
+
+#include <vector>
+
+#include "fltl/include/NFA.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// copy an automaton such that each transition of the copy reads a
+    /// single byte. transitions on longer symbols become chains of
+    /// transitions through new states, and transitions on empty symbols
+    /// become epsilon transitions. the escape sequences of the text format
+    /// are decoded, so the symbol "\n" reads a single new line.
+    ///
+    /// each state of the original automaton keeps its number in the copy,
+    /// and named accepting states keep their names.
+    template <typename AlphaT>
+    class NFA_EXPAND_BYTES {
+    private:
+
+        typedef fltl::NFA<AlphaT> NFA;
+
+        FLTL_NFA_USE_TYPES(NFA);
+
+    public:
+
+        /// decode the escape sequences in the text of a symbol
+        static void decode(const char *str, std::vector<char> &bytes) throw() {
+            bytes.clear();
+            for(; '\0' != *str; ++str) {
+                if('\\' != *str || '\0' == str[1]) {
+                    bytes.push_back(*str);
+                    continue;
+                }
+
+                switch(*++str) {
+                case 's': bytes.push_back(' '); break;
+                case 't': bytes.push_back('\t'); break;
+                case 'n': bytes.push_back('\n'); break;
+                case 'r': bytes.push_back('\r'); break;
+                default: bytes.push_back(*str); break;
+                }
+            }
+        }
+
+        static void run(const NFA &nfa, NFA &out) throw() {
+            std::vector<state_type> states(nfa.num_states_capacity());
+            for(unsigned i(0); i < states.size(); ++i) {
+                states[i] = 0U == i ? out.get_start_state() : out.add_state();
+            }
+
+            out.set_start_state(states[nfa.get_start_state().number()]);
+
+            state_type state;
+            generator_type all_states(nfa.search(~state));
+            for(; all_states.match_next(); ) {
+                if(nfa.is_accept_state(state)) {
+                    out.add_accept_state(states[state.number()]);
+                    if('\0' != nfa.get_name(state)[0]) {
+                        out.set_name(states[state.number()], nfa.get_name(state));
+                    }
+                }
+            }
+
+            std::vector<char> bytes;
+            char byte[2] = {'\0', '\0'};
+
+            transition_type trans;
+            generator_type transitions(nfa.search(~trans));
+            for(; transitions.match_next(); ) {
+                state_type source(states[trans.source().number()]);
+                const state_type sink(states[trans.sink().number()]);
+
+                bytes.clear();
+                if(nfa.epsilon() != trans.read()) {
+                    const char *str(0);
+                    traits_type::unserialize(nfa.get_alpha(trans.read()), str);
+                    decode(str, bytes);
+                }
+
+                if(bytes.empty()) {
+                    out.add_transition(source, out.epsilon(), sink);
+                    continue;
+                }
+
+                for(unsigned i(0); i < bytes.size(); ++i) {
+                    const state_type next(
+                        (i + 1U) == bytes.size() ? sink : out.add_state()
+                    );
+                    byte[0] = bytes[i];
+                    out.add_transition(source, out.get_symbol(byte), next);
+                    source = next;
+                }
+            }
+        }
+    };
+}}
+
+#endif /* FLTL_NFA_EXPAND_BYTES_HPP_ */
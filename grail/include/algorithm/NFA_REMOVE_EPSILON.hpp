@@ -29,12 +29,26 @@
 #ifndef FLTL_NFA_REMOVE_EPSILON_HPP_
 #define FLTL_NFA_REMOVE_EPSILON_HPP_
 
-#include <set>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "fltl/include/NFA.hpp"
 
+#include "fltl/include/helper/BitMatrix.hpp"
+
 namespace grail { namespace algorithm {
 
+    /// remove the epsilon transitions of an NFA without changing its
+    /// language. each state gets the non-epsilon transitions of every state
+    /// in its epsilon closure, and accepts if its closure has an accepting
+    /// state.
+    ///
+    /// the strongly connected components of the epsilon transitions are
+    /// found first, as every state of a component has the same closure.
+    /// the closures of the components are then computed once each, as rows
+    /// of a bit matrix, in reverse topological order, so that the closure
+    /// of a component is the union of the closures of its successors.
     template <typename AlphaT>
     class NFA_REMOVE_EPSILON {
     private:
@@ -43,76 +57,246 @@ namespace grail { namespace algorithm {
 
         FLTL_NFA_USE_TYPES(NFA);
 
+        typedef std::vector<std::vector<unsigned> > adjacency_type;
+
+        /// find the strongly connected components of the epsilon
+        /// transitions using Tarjan's algorithm. components are numbered in
+        /// the order in which they are completed, which is a reverse
+        /// topological order.
+        static unsigned find_components(
+            const adjacency_type &epsilons,
+            std::vector<unsigned> &component
+        ) throw() {
+            const unsigned num_states(static_cast<unsigned>(epsilons.size()));
+            const unsigned UNVISITED(~0U);
+
+            std::vector<unsigned> index(num_states, UNVISITED);
+            std::vector<unsigned> low(num_states, 0U);
+            std::vector<bool> on_stack(num_states, false);
+            std::vector<unsigned> stack;
+            std::vector<std::pair<unsigned, unsigned> > calls;
+
+            unsigned next_index(0);
+            unsigned num_components(0);
+
+            component.assign(num_states, 0U);
+
+            for(unsigned root(0); root < num_states; ++root) {
+                if(UNVISITED != index[root]) {
+                    continue;
+                }
+
+                calls.push_back(std::make_pair(root, 0U));
+                index[root] = low[root] = next_index++;
+                stack.push_back(root);
+                on_stack[root] = true;
+
+                for(; !calls.empty(); ) {
+                    const unsigned v(calls.back().first);
+                    const unsigned i(calls.back().second);
+
+                    // visit the next successor of v
+                    if(i < epsilons[v].size()) {
+                        const unsigned w(epsilons[v][i]);
+                        ++(calls.back().second);
+
+                        if(UNVISITED == index[w]) {
+                            index[w] = low[w] = next_index++;
+                            stack.push_back(w);
+                            on_stack[w] = true;
+                            calls.push_back(std::make_pair(w, 0U));
+
+                        } else if(on_stack[w] && index[w] < low[v]) {
+                            low[v] = index[w];
+                        }
+
+                        continue;
+                    }
+
+                    calls.pop_back();
+
+                    if(!calls.empty()) {
+                        const unsigned u(calls.back().first);
+                        if(low[v] < low[u]) {
+                            low[u] = low[v];
+                        }
+                    }
+
+                    if(low[v] != index[v]) {
+                        continue;
+                    }
+
+                    // v is the root of a component
+                    for(unsigned w(v + 1U); w != v; ) {
+                        w = stack.back();
+                        stack.pop_back();
+                        on_stack[w] = false;
+                        component[w] = num_components;
+                    }
+
+                    ++num_components;
+                }
+            }
+
+            return num_components;
+        }
+
     public:
 
         static void run(NFA &nfa) throw() {
 
-            std::set<state_type> reached_states;
-
-            symbol_type read;
+            const unsigned num_states(nfa.num_states_capacity());
             const symbol_type epsilon(nfa.epsilon());
 
-            // all epsilon transitions leaving state A and
-            // going to state B, store the actual transition
-            // to epsilon_transition
-            transition_type epsilon_transition;
-            state_type A;
-            state_type B;
-            generator_type all_states(nfa.search(~A));
-            generator_type epsilon_transitions(nfa.search(
-                ~epsilon_transition,
-                A,
-                epsilon,
-                ~B
-            ));
-
-            // all transitions leaving state B
-            transition_type reachable_transition;
-            generator_type reachable_transitions(nfa.search(
-                ~reachable_transition,
-                B,
-                nfa._,
-                nfa._
-            ));
-
-            for(bool updated(false); all_states.match_next(); ) {
-                reached_states.clear();
-                reached_states.insert(A);
-
-                for(updated = true; updated; ) {
-
-                    updated = false;
-
-                    // follow along an epsilon transition
-                    for(epsilon_transitions.rewind();
-                        epsilon_transitions.match_next(); ) {
-
-                        // remove the transition
-                        nfa.remove_transition(epsilon_transition);
-
-                        // we've already reached this state by following
-                        // an epsilon transition
-                        if(0 != reached_states.count(B)) {
-                            continue;
-                        }
+            std::vector<state_type> states(num_states);
+            std::vector<bool> is_accept(num_states, false);
+
+            state_type state;
+            generator_type all_states(nfa.search(~state));
+            for(; all_states.match_next(); ) {
+                states[state.number()] = state;
+                is_accept[state.number()] = nfa.is_accept_state(state);
+            }
 
-                        reached_states.insert(B);
-                        for(reachable_transitions.rewind();
-                            reachable_transitions.match_next(); ) {
+            // split the transitions into epsilon transitions and the
+            // (symbol, sink) pairs of the other transitions
+            adjacency_type epsilons(num_states);
+            std::vector<std::vector<std::pair<symbol_type, unsigned> > >
+                moves(num_states);
+            std::vector<transition_type> epsilon_transitions;
 
-                            read = reachable_transition.read();
-                            nfa.add_transition(
-                                A,
-                                read,
-                                reachable_transition.sink()
-                            );
+            transition_type trans;
+            generator_type transitions(nfa.search(~trans));
+            for(; transitions.match_next(); ) {
+                const unsigned source(trans.source().number());
+                const unsigned sink(trans.sink().number());
+
+                if(epsilon == trans.read()) {
+                    epsilon_transitions.push_back(trans);
+                    if(source != sink) {
+                        epsilons[source].push_back(sink);
+                    }
+                } else {
+                    moves[source].push_back(std::make_pair(trans.read(), sink));
+                }
+            }
 
-                            if(epsilon == read) {
-                                updated = true;
-                            }
+            if(epsilon_transitions.empty()) {
+                return;
+            }
+
+            std::vector<unsigned> component;
+            const unsigned num_components(find_components(epsilons, component));
+
+            std::vector<std::vector<unsigned> > members(num_components);
+            std::vector<bool> component_accepts(num_components, false);
+
+            for(unsigned i(0); i < num_states; ++i) {
+                members[component[i]].push_back(i);
+                if(is_accept[i]) {
+                    component_accepts[component[i]] = true;
+                }
+            }
+
+            // only components that are touched by an epsilon transition get
+            // a row and a column in the closure matrix
+            std::vector<unsigned> row_of(num_components, ~0U);
+            std::vector<unsigned> component_of_row;
+
+            for(unsigned i(0); i < num_states; ++i) {
+                for(unsigned j(0); j < epsilons[i].size(); ++j) {
+                    const unsigned from(component[i]);
+                    const unsigned to(component[epsilons[i][j]]);
+
+                    if(~0U == row_of[from]) {
+                        row_of[from] = static_cast<unsigned>(component_of_row.size());
+                        component_of_row.push_back(from);
+                    }
+
+                    if(~0U == row_of[to]) {
+                        row_of[to] = static_cast<unsigned>(component_of_row.size());
+                        component_of_row.push_back(to);
+                    }
+                }
+            }
+
+            const unsigned num_rows(static_cast<unsigned>(component_of_row.size()));
+            fltl::helper::BitMatrix closure(num_rows, num_rows);
+
+            // components are numbered such that every successor of a
+            // component has a smaller number
+            std::vector<std::pair<symbol_type, unsigned> > closure_moves;
+
+            for(unsigned c(0); c < num_components; ++c) {
+                const unsigned row(row_of[c]);
+                if(~0U == row) {
+                    continue;
+                }
+
+                closure.set(row, row);
+
+                for(unsigned i(0); i < members[c].size(); ++i) {
+                    const unsigned v(members[c][i]);
+                    for(unsigned j(0); j < epsilons[v].size(); ++j) {
+                        const unsigned d(component[epsilons[v][j]]);
+                        if(d != c) {
+                            closure.union_rows(row, row_of[d]);
                         }
                     }
                 }
+
+                // gather the non-epsilon transitions of the closure once,
+                // then give them to every state of the component
+                bool accepts(false);
+                closure_moves.clear();
+
+                for(unsigned col(0); col < num_rows; ++col) {
+                    if(!closure.test(row, col)) {
+                        continue;
+                    }
+
+                    const unsigned d(component_of_row[col]);
+                    accepts = accepts || component_accepts[d];
+
+                    for(unsigned i(0); i < members[d].size(); ++i) {
+                        const unsigned u(members[d][i]);
+                        closure_moves.insert(
+                            closure_moves.end(),
+                            moves[u].begin(),
+                            moves[u].end()
+                        );
+                    }
+                }
+
+                // transitions are kept sorted, so adding them from the
+                // greatest to the least puts each one at the front of the
+                // transitions of its state
+                std::sort(closure_moves.begin(), closure_moves.end());
+                closure_moves.erase(
+                    std::unique(closure_moves.begin(), closure_moves.end()),
+                    closure_moves.end()
+                );
+
+                for(unsigned i(0); i < members[c].size(); ++i) {
+                    const state_type A(states[members[c][i]]);
+
+                    for(unsigned j(static_cast<unsigned>(closure_moves.size()));
+                        j-- > 0; ) {
+                        nfa.add_transition(
+                            A,
+                            closure_moves[j].first,
+                            states[closure_moves[j].second]
+                        );
+                    }
+
+                    if(accepts) {
+                        nfa.add_accept_state(A);
+                    }
+                }
+            }
+
+            for(unsigned i(0); i < epsilon_transitions.size(); ++i) {
+                nfa.remove_transition(epsilon_transitions[i]);
             }
         }
     };
@@ -0,0 +1,385 @@
+/*
+ * NFA_TO_DFA.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_NFA_TO_DFA_HPP_
+#define FLTL_NFA_TO_DFA_HPP_
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/NFA.hpp"
+
+#include "grail/include/helper/CStringMap.hpp"
+
+namespace grail { namespace algorithm {
+
+    /// convert an NFA into an equivalent DFA using the subset construction.
+    /// each state of the DFA represents an epsilon-closed set of NFA
+    /// states; these sets are interned in a hash table so that looking up
+    /// the DFA state of a set is one hash and one comparison in the common
+    /// case.
+    ///
+    /// a DFA state accepts if any of its NFA states accept. it accepts the
+    /// token of its lowest-numbered, named, accepting NFA state, so that
+    /// the names of accepting states can be used as the names of the
+    /// tokens recognized by a DFA, with earlier states taking priority, as
+    /// in lex.
+    template <typename AlphaT>
+    class NFA_TO_DFA {
+    private:
+
+        typedef fltl::NFA<AlphaT> NFA;
+
+        FLTL_NFA_USE_TYPES(NFA);
+
+        /// the (symbol, sink) pairs of the non-epsilon transitions of
+        /// state s are moves[move_begin[s]] up to moves[move_begin[s + 1]],
+        /// and the sinks of the epsilon transitions of s are stored
+        /// similarly in epsilon_sinks.
+        struct adjacency_type {
+        public:
+            std::vector<unsigned> epsilon_begin;
+            std::vector<unsigned> epsilon_sinks;
+            std::vector<unsigned> move_begin;
+            std::vector<std::pair<unsigned, unsigned> > moves;
+        };
+
+        /// open-addressed hash table of sorted sets of NFA states. the
+        /// sets are stored back to back in a single array.
+        struct set_table_type {
+        public:
+            std::vector<unsigned> members;
+            std::vector<unsigned> set_begin;
+            std::vector<uint32_t> hashes;
+            std::vector<unsigned> slots;
+
+            set_table_type(void) throw()
+                : members()
+                , set_begin(1U, 0U)
+                , hashes()
+                , slots(16U, 0U)
+            { }
+
+            unsigned num_sets(void) const throw() {
+                return static_cast<unsigned>(hashes.size());
+            }
+
+            unsigned begin(unsigned set) const throw() {
+                return set_begin[set];
+            }
+
+            unsigned end(unsigned set) const throw() {
+                return set_begin[set + 1U];
+            }
+        };
+
+        static uint32_t hash(const std::vector<unsigned> &set) throw() {
+            uint32_t h(2166136261U);
+            for(unsigned i(0); i < set.size(); ++i) {
+                h = (h ^ set[i]) * 16777619U;
+            }
+            return h;
+        }
+
+        static bool equal(
+            const set_table_type &table,
+            unsigned id,
+            const std::vector<unsigned> &set
+        ) throw() {
+            const unsigned begin(table.begin(id));
+            if((table.end(id) - begin) != set.size()) {
+                return false;
+            }
+
+            for(unsigned i(0); i < set.size(); ++i) {
+                if(table.members[begin + i] != set[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /// find the id of a set of states, adding the set to the table if
+        /// it isn't already there.
+        static unsigned find_or_insert(
+            set_table_type &table,
+            const std::vector<unsigned> &set,
+            bool &is_new
+        ) throw() {
+            const uint32_t h(hash(set));
+            unsigned mask(static_cast<unsigned>(table.slots.size()) - 1U);
+            unsigned i(h & mask);
+
+            for(; 0U != table.slots[i]; i = (i + 1U) & mask) {
+                const unsigned id(table.slots[i] - 1U);
+                if(h == table.hashes[id] && equal(table, id, set)) {
+                    is_new = false;
+                    return id;
+                }
+            }
+
+            const unsigned id(table.num_sets());
+            table.members.insert(table.members.end(), set.begin(), set.end());
+            table.set_begin.push_back(static_cast<unsigned>(table.members.size()));
+            table.hashes.push_back(h);
+            table.slots[i] = id + 1U;
+            is_new = true;
+
+            // keep the load factor below 1/2
+            if((2U * table.num_sets()) > table.slots.size()) {
+                table.slots.assign(2U * table.slots.size(), 0U);
+                mask = static_cast<unsigned>(table.slots.size()) - 1U;
+
+                for(unsigned j(0); j < table.num_sets(); ++j) {
+                    unsigned k(table.hashes[j] & mask);
+                    for(; 0U != table.slots[k]; k = (k + 1U) & mask) { }
+                    table.slots[k] = j + 1U;
+                }
+            }
+
+            return id;
+        }
+
+        static void index(const NFA &nfa, adjacency_type &adj) throw() {
+            const unsigned num_states(nfa.num_states_capacity());
+
+            std::vector<std::vector<unsigned> > epsilon(num_states);
+            std::vector<std::vector<std::pair<unsigned, unsigned> > >
+                moves(num_states);
+
+            transition_type trans;
+            generator_type transitions(nfa.search(~trans));
+            for(; transitions.match_next(); ) {
+                const unsigned source(trans.source().number());
+                const unsigned sink(trans.sink().number());
+
+                if(nfa.epsilon() == trans.read()) {
+                    epsilon[source].push_back(sink);
+                } else {
+                    moves[source].push_back(
+                        std::make_pair(trans.read().number(), sink)
+                    );
+                }
+            }
+
+            adj.epsilon_begin.assign(1U, 0U);
+            adj.move_begin.assign(1U, 0U);
+
+            for(unsigned s(0); s < num_states; ++s) {
+                adj.epsilon_sinks.insert(
+                    adj.epsilon_sinks.end(),
+                    epsilon[s].begin(),
+                    epsilon[s].end()
+                );
+                adj.moves.insert(
+                    adj.moves.end(),
+                    moves[s].begin(),
+                    moves[s].end()
+                );
+                adj.epsilon_begin.push_back(
+                    static_cast<unsigned>(adj.epsilon_sinks.size())
+                );
+                adj.move_begin.push_back(
+                    static_cast<unsigned>(adj.moves.size())
+                );
+            }
+        }
+
+        /// extend a set of states to its epsilon closure, and sort it
+        static void close(
+            const adjacency_type &adj,
+            std::vector<unsigned> &set,
+            std::vector<unsigned> &seen,
+            unsigned stamp
+        ) throw() {
+            for(unsigned i(0); i < set.size(); ++i) {
+                seen[set[i]] = stamp;
+            }
+
+            for(unsigned i(0); i < set.size(); ++i) {
+                const unsigned s(set[i]);
+                for(unsigned j(adj.epsilon_begin[s]);
+                    j < adj.epsilon_begin[s + 1U];
+                    ++j) {
+
+                    const unsigned sink(adj.epsilon_sinks[j]);
+                    if(stamp != seen[sink]) {
+                        seen[sink] = stamp;
+                        set.push_back(sink);
+                    }
+                }
+            }
+
+            std::sort(set.begin(), set.end());
+        }
+
+    public:
+
+        /// an accepting state accepts the token named by the part of the
+        /// state's name before its first ':'. state names identify states
+        /// in the text format, so when several states of a DFA accept the
+        /// same token, they are named TOKEN, TOKEN:1, TOKEN:2, etc.
+        static const char *token_end(const char *name) throw() {
+            const char *colon(strchr(name, ':'));
+            return 0 == colon ? name + strlen(name) : colon;
+        }
+
+        /// name a state of a DFA after the token of `name`, such that no
+        /// other state in the DFA has the same name.
+        static void name_state(
+            NFA &dfa,
+            state_type state,
+            const char *name,
+            helper::CStringMap<unsigned> &num_named
+        ) throw() {
+            const char *end(token_end(name));
+            const int len(static_cast<int>(end - name));
+            unsigned &count(num_named.get(name, end));
+            std::vector<char> buffer(static_cast<unsigned>(len) + 16U);
+
+            if(0U == count) {
+                sprintf(&(buffer[0]), "%.*s", len, name);
+            } else {
+                sprintf(&(buffer[0]), "%.*s:%u", len, name, count);
+            }
+
+            ++count;
+            dfa.set_name(state, &(buffer[0]));
+        }
+
+        /// build a DFA for the language of `nfa` in `dfa`, which is
+        /// assumed to be empty.
+        static void run(const NFA &nfa, NFA &dfa) throw() {
+            const unsigned num_states(nfa.num_states_capacity());
+
+            adjacency_type adj;
+            index(nfa, adj);
+
+            // the accepting NFA states and their names, and the DFA
+            // symbols of the NFA input symbols
+            std::vector<bool> is_accept(num_states, false);
+            std::vector<const char *> names(num_states, 0);
+            std::vector<symbol_type> dfa_symbols(nfa.num_symbols() + 1U);
+
+            state_type state;
+            generator_type states(nfa.search(~state));
+            for(; states.match_next(); ) {
+                if(nfa.is_accept_state(state)) {
+                    is_accept[state.number()] = true;
+                    names[state.number()] = nfa.get_name(state);
+                }
+            }
+
+            symbol_type sym;
+            generator_type symbols(nfa.search(~sym));
+            for(; symbols.match_next(); ) {
+                if(nfa.is_in_input_alphabet(sym)) {
+                    dfa_symbols[sym.number()] = dfa.get_symbol(
+                        nfa.get_alpha(sym)
+                    );
+                }
+            }
+
+            set_table_type table;
+            helper::CStringMap<unsigned> num_named;
+            std::vector<state_type> dfa_states;
+            std::vector<unsigned> seen(num_states, 0U);
+            std::vector<unsigned> set;
+            std::vector<std::pair<unsigned, unsigned> > moves;
+            unsigned stamp(0);
+            bool is_new(false);
+
+            set.push_back(nfa.get_start_state().number());
+            close(adj, set, seen, ++stamp);
+            find_or_insert(table, set, is_new);
+            dfa_states.push_back(dfa.get_start_state());
+
+            // the sets are numbered in the order that they are discovered,
+            // so the table doubles as the work list
+            for(unsigned id(0); id < table.num_sets(); ++id) {
+                const state_type from(dfa_states[id]);
+                const unsigned begin(table.begin(id));
+                const unsigned end(table.end(id));
+
+                // accept and name the state
+                for(unsigned i(begin); i < end; ++i) {
+                    const unsigned s(table.members[i]);
+                    if(!is_accept[s]) {
+                        continue;
+                    }
+
+                    dfa.add_accept_state(from);
+
+                    if('\0' != names[s][0]) {
+                        name_state(dfa, from, names[s], num_named);
+                        break;
+                    }
+                }
+
+                // group the moves out of the set by their symbol
+                moves.clear();
+                for(unsigned i(begin); i < end; ++i) {
+                    const unsigned s(table.members[i]);
+                    moves.insert(
+                        moves.end(),
+                        adj.moves.begin() + adj.move_begin[s],
+                        adj.moves.begin() + adj.move_begin[s + 1U]
+                    );
+                }
+
+                std::sort(moves.begin(), moves.end());
+
+                for(unsigned i(0), j(0); i < moves.size(); i = j) {
+                    set.clear();
+                    ++stamp;
+                    for(j = i; j < moves.size() && moves[j].first == moves[i].first; ++j) {
+                        if(stamp != seen[moves[j].second]) {
+                            seen[moves[j].second] = stamp;
+                            set.push_back(moves[j].second);
+                        }
+                    }
+
+                    close(adj, set, seen, stamp);
+
+                    const unsigned to_id(find_or_insert(table, set, is_new));
+                    if(is_new) {
+                        dfa_states.push_back(dfa.add_state());
+                    }
+
+                    dfa.add_transition(
+                        from,
+                        dfa_symbols[moves[i].first],
+                        dfa_states[to_id]
+                    );
+                }
+            }
+        }
+    };
+
+}}
+
+#endif /* FLTL_NFA_TO_DFA_HPP_ */
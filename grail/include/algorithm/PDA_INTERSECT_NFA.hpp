@@ -29,18 +29,27 @@
 #ifndef FLTL_PDA_INTERSECT_NFA_HPP_
 #define FLTL_PDA_INTERSECT_NFA_HPP_
 
+#include <algorithm>
 #include <utility>
-#include <map>
+#include <vector>
 
 #include "fltl/include/NFA.hpp"
 #include "fltl/include/PDA.hpp"
 
 #include "grail/include/algorithm/NFA_REMOVE_EPSILON.hpp"
 
+#include "grail/include/helper/PairMap.hpp"
+
 namespace grail { namespace algorithm {
 
     /// intersect a PDA and an NFA
     /// implementation follows Hopcroft, Motwani, Ullman, p. 292
+    ///
+    /// the product is built on the fly: only pairs of states that are
+    /// reachable from the pair of start states are expanded, and of those,
+    /// only the pairs that can reach a pair of accepting states are output.
+    /// the transitions of the NFA are indexed by state and symbol, and the
+    /// pairs are numbered through an open-addressed hash table.
     template <typename AlphaT>
     class PDA_INTERSECT_NFA {
     public:
@@ -51,131 +60,270 @@ namespace grail { namespace algorithm {
         FLTL_PDA_USE_TYPES_PREFIX(PDA, pda);
         FLTL_NFA_USE_TYPES_PREFIX(NFA, nfa);
 
-        typedef std::pair<pda_state_type,nfa_state_type> state_pair_type;
-        typedef std::map<state_pair_type, pda_state_type> state_pair_map_type;
+    private:
+
+        /// a transition of the PDA, with its symbols translated into
+        /// symbols of the output PDA
+        struct move_type {
+        public:
+            unsigned read;
+            pda_symbol_type read_out;
+            pda_symbol_type pop_out;
+            pda_symbol_type push_out;
+            unsigned sink;
+        };
+
+        /// a transition of the product, between pairs
+        struct edge_type {
+        public:
+            unsigned source;
+            unsigned sink;
+            const move_type *move;
+        };
+
+        /// orders the transitions of the product by their source, then
+        /// as pda::Transition orders the transitions of a state
+        struct edge_order_type {
+        public:
+            const std::vector<unsigned> *out_state;
+
+            bool operator()(const edge_type &a, const edge_type &b) const throw() {
+                if(a.source != b.source) {
+                    return a.source < b.source;
+                } else if(a.move->read_out != b.move->read_out) {
+                    return a.move->read_out < b.move->read_out;
+                } else if(a.move->pop_out != b.move->pop_out) {
+                    return a.move->pop_out < b.move->pop_out;
+                } else if(a.move->push_out != b.move->push_out) {
+                    return a.move->push_out < b.move->push_out;
+                }
+                return (*out_state)[a.sink] < (*out_state)[b.sink];
+            }
+        };
 
-        /// get a state in the constructed automaton
-        static pda_state_type get_state(
+        /// translate a symbol of the input PDA into a symbol of the output
+        /// PDA
+        static pda_symbol_type translate(
+            const PDA &pda,
             PDA &out,
-            state_pair_map_type &map,
-            pda_state_type q,
-            nfa_state_type p
+            pda_symbol_type sym
         ) throw() {
-            const state_pair_type pp(q, p);
-            if(0 == map.count(pp)) {
-                map[pp] = out.add_state();
+            if(pda.epsilon() == sym) {
+                return out.epsilon();
+            } else if(pda.is_in_input_alphabet(sym)) {
+                return out.get_alphabet_symbol(pda.get_alpha(sym));
             }
-            return map[pp];
+            return out.get_stack_symbol(pda.get_name(sym));
         }
 
+    public:
+
         /// construct the output automaton
         static void run(const PDA &pda, NFA &nfa, PDA &out) throw() {
 
             NFA_REMOVE_EPSILON<AlphaT>::run(nfa);
 
-            state_pair_map_type state_pairs;
+            const unsigned num_pda_states(pda.num_states_capacity());
+            const unsigned num_nfa_states(nfa.num_states_capacity());
+
+            // the translations of the symbols of the PDA, and the numbers
+            // of the NFA symbols of its input symbols
+            const unsigned num_symbols(pda.num_symbols() + 1U);
+            std::vector<pda_symbol_type> symbols_out(num_symbols, out.epsilon());
+            std::vector<unsigned> nfa_symbols(num_symbols, 0U);
+
+            pda_symbol_type sym;
+            pda_generator_type pda_symbols(pda.search(~sym));
+            for(; pda_symbols.match_next(); ) {
+                symbols_out[sym.number()] = translate(pda, out, sym);
+                if(pda.is_in_input_alphabet(sym)) {
+                    nfa_symbols[sym.number()] = nfa.get_symbol(
+                        pda.get_alpha(sym)
+                    ).number();
+                }
+            }
 
-            // assign the start state
-            state_pairs[std::make_pair(
-                pda.get_start_state(),
-                nfa.get_start_state()
-            )] = out.get_start_state();
+            // index the transitions of the PDA by their sources
+            std::vector<std::vector<move_type> > pda_moves(num_pda_states);
+
+            pda_transition_type pda_trans;
+            pda_generator_type pda_transitions(pda.search(~pda_trans));
+            for(; pda_transitions.match_next(); ) {
+                move_type move;
+                move.read = nfa_symbols[pda_trans.read().number()];
+                move.read_out = symbols_out[pda_trans.read().number()];
+                move.pop_out = symbols_out[pda_trans.pop().number()];
+                move.push_out = symbols_out[pda_trans.push().number()];
+                move.sink = pda_trans.sink().number();
+
+                pda_moves[pda_trans.source().number()].push_back(move);
+            }
+
+            // index the transitions of the NFA by their sources, and then
+            // by their symbols
+            std::vector<std::vector<std::pair<unsigned, unsigned> > >
+                nfa_moves(num_nfa_states);
+
+            nfa_transition_type nfa_trans;
+            nfa_generator_type nfa_transitions(nfa.search(~nfa_trans));
+            for(; nfa_transitions.match_next(); ) {
+                nfa_moves[nfa_trans.source().number()].push_back(std::make_pair(
+                    nfa_trans.read().number(),
+                    nfa_trans.sink().number()
+                ));
+            }
+
+            for(unsigned p(0); p < num_nfa_states; ++p) {
+                std::sort(nfa_moves[p].begin(), nfa_moves[p].end());
+            }
+
+            std::vector<bool> pda_accepts(num_pda_states, false);
+            std::vector<bool> nfa_accepts(num_nfa_states, false);
 
             pda_state_type q;
-            pda_state_type r;
+            pda_generator_type pda_states(pda.search(~q));
+            for(; pda_states.match_next(); ) {
+                pda_accepts[q.number()] = pda.is_accept_state(q);
+            }
 
             nfa_state_type p;
-            nfa_state_type s;
+            nfa_generator_type nfa_states(nfa.search(~p));
+            for(; nfa_states.match_next(); ) {
+                nfa_accepts[p.number()] = nfa.is_accept_state(p);
+            }
 
-            nfa_symbol_type a_nfa;
+            // expand the pairs that are reachable from the start pair in
+            // breadth-first order; pair ids double as the queue
+            helper::PairMap pairs;
+            std::vector<edge_type> edges;
+            bool is_new(false);
+
+            pairs.find_or_insert(
+                pda.get_start_state().number(),
+                nfa.get_start_state().number(),
+                is_new
+            );
+
+            for(unsigned id(0); id < pairs.size(); ++id) {
+                const unsigned pq(pairs.first(id));
+                const unsigned pp(pairs.second(id));
+
+                for(unsigned i(0); i < pda_moves[pq].size(); ++i) {
+                    const move_type &move(pda_moves[pq][i]);
+
+                    edge_type edge;
+                    edge.source = id;
+                    edge.move = &move;
+
+                    // the PDA moves without reading, the NFA stays put
+                    if(0U == move.read) {
+                        edge.sink = pairs.find_or_insert(move.sink, pp, is_new);
+                        edges.push_back(edge);
+                        continue;
+                    }
 
-            pda_symbol_type a_pda;
-            pda_symbol_type X;
-            pda_symbol_type gamma;
+                    // both automata read the same symbol
+                    typename std::vector<
+                        std::pair<unsigned, unsigned>
+                    >::const_iterator it(std::lower_bound(
+                        nfa_moves[pp].begin(),
+                        nfa_moves[pp].end(),
+                        std::make_pair(move.read, 0U)
+                    ));
+
+                    for(; it != nfa_moves[pp].end() && move.read == it->first; ++it) {
+                        edge.sink = pairs.find_or_insert(
+                            move.sink,
+                            it->second,
+                            is_new
+                        );
+                        edges.push_back(edge);
+                    }
+                }
+            }
 
-            pda_symbol_type a_out;
-            pda_symbol_type X_out;
-            pda_symbol_type gamma_out;
+            // find the pairs that can reach an accepting pair
+            const unsigned num_pairs(pairs.size());
+            std::vector<unsigned> in_begin(num_pairs + 1U, 0U);
+            std::vector<unsigned> in_sources(edges.size());
 
-            const pda_symbol_type epsilon(pda.epsilon());
+            for(unsigned i(0); i < edges.size(); ++i) {
+                ++in_begin[edges[i].sink + 1U];
+            }
 
-            pda_generator_type pda_transitions(pda.search(
-                ~q,
-                ~a_pda,
-                ~X,
-                ~gamma,
-                ~r
-            ));
+            for(unsigned i(0); i < num_pairs; ++i) {
+                in_begin[i + 1U] += in_begin[i];
+            }
 
-            nfa_generator_type nfa_transitions(nfa.search(
-                ~p,
-                a_nfa,
-                ~s
-            ));
-            nfa_generator_type nfa_states(nfa.search(~s));
-            nfa_generator_type *gen(0);
+            std::vector<unsigned> in_next(in_begin.begin(), in_begin.end() - 1);
+            for(unsigned i(0); i < edges.size(); ++i) {
+                in_sources[in_next[edges[i].sink]++] = edges[i].source;
+            }
 
-            // add in all of the main transitions
-            for(; pda_transitions.match_next(); ) {
+            std::vector<bool> is_useful(num_pairs, false);
+            std::vector<unsigned> work;
 
-                // switch generators (because we really only care about s)
-                // depending on whether the PDA is taking an epsilon
-                // transition or not
-                if(epsilon == a_pda) {
-                    gen = &nfa_states;
-                    a_out = out.epsilon();
-                } else {
-                    gen = &nfa_transitions;
-                    a_nfa = nfa.get_symbol(pda.get_alpha(a_pda));
-                    a_out = out.get_alphabet_symbol(pda.get_alpha(a_pda));
+            for(unsigned id(0); id < num_pairs; ++id) {
+                if(pda_accepts[pairs.first(id)] && nfa_accepts[pairs.second(id)]) {
+                    is_useful[id] = true;
+                    work.push_back(id);
                 }
+            }
 
-                // translate the symbols to the new PDA
+            for(; !work.empty(); ) {
+                const unsigned id(work.back());
+                work.pop_back();
 
-                if(pda.is_in_input_alphabet(X)) {
-                    X_out = out.get_alphabet_symbol(pda.get_alpha(X));
-                } else {
-                    X_out = out.get_stack_symbol(pda.get_name(X));
+                for(unsigned i(in_begin[id]); i < in_begin[id + 1U]; ++i) {
+                    if(!is_useful[in_sources[i]]) {
+                        is_useful[in_sources[i]] = true;
+                        work.push_back(in_sources[i]);
+                    }
                 }
+            }
+
+            // output the useful pairs
+            std::vector<pda_state_type> states(num_pairs);
+            std::vector<unsigned> out_state(num_pairs, 0U);
 
-                if(pda.is_in_input_alphabet(gamma)) {
-                    gamma_out = out.get_alphabet_symbol(pda.get_alpha(gamma));
+            for(unsigned id(0); id < num_pairs; ++id) {
+                if(0U == id) {
+                    states[id] = out.get_start_state();
+                } else if(is_useful[id]) {
+                    states[id] = out.add_state();
                 } else {
-                    gamma_out = out.get_stack_symbol(pda.get_name(gamma));
+                    continue;
                 }
 
-                // go over the NFA
-                for(gen->rewind();
-                    gen->match_next(); ) {
-
-                    out.add_transition(
-                        get_state(out, state_pairs, q, p),
-                        a_out,
-                        X_out,
-                        gamma_out,
-                        get_state(out, state_pairs, r, s)
-                    );
+                out_state[id] = states[id].number();
+
+                if(pda_accepts[pairs.first(id)] && nfa_accepts[pairs.second(id)]) {
+                    out.add_accept_state(states[id]);
                 }
             }
 
-            // collect the final states
-            pda_generator_type pda_states(pda.search(~r));
-            for(; pda_states.match_next(); ) {
+            // transitions are kept sorted, so adding them from the greatest
+            // to the least puts each one at the front of the transitions of
+            // its state
+            edge_order_type order;
+            order.out_state = &out_state;
+            std::sort(edges.begin(), edges.end(), order);
 
-                if(!pda.is_accept_state(r)) {
+            for(unsigned i(static_cast<unsigned>(edges.size())); i-- > 0; ) {
+                const edge_type &edge(edges[i]);
+                if(!is_useful[edge.source] || !is_useful[edge.sink]) {
                     continue;
                 }
 
-                for(nfa_states.rewind(); nfa_states.match_next(); ) {
-                    if(!nfa.is_accept_state(s)) {
-                        continue;
-                    }
-
-                    out.add_accept_state(get_state(out, state_pairs, r, s));
-                }
+                out.add_transition(
+                    states[edge.source],
+                    edge.move->read_out,
+                    edge.move->pop_out,
+                    edge.move->push_out,
+                    states[edge.sink]
+                );
             }
         }
-
     };
 
 }}
@@ -29,13 +29,16 @@
 #ifndef FLTL_PDA_TO_CFG_HPP_
 #define FLTL_PDA_TO_CFG_HPP_
 
+#include <algorithm>
 #include <cstdio>
+#include <vector>
 
 #include "fltl/include/CFG.hpp"
 #include "fltl/include/PDA.hpp"
 
 #include "fltl/include/helper/Array.hpp"
-#include "fltl/include/helper/Table.hpp"
+
+#include "grail/include/helper/PairMap.hpp"
 
 #include "grail/include/io/verbose.hpp"
 
@@ -190,6 +193,88 @@ namespace grail { namespace algorithm {
             return final_state;
         }
 
+        /// a transition of the normalized PDA that pushes or pops sym
+        struct move_type {
+        public:
+            unsigned sym;
+            unsigned state;
+            pda_symbol_type read;
+
+            bool operator<(const move_type &that) const throw() {
+                return sym < that.sym;
+            }
+        };
+
+        typedef std::vector<std::vector<move_type> > move_index_type;
+
+        /// record that the PDA can go from p to q, starting and ending with
+        /// the same stack, if this isn't already known
+        static void add_pair(
+            helper::PairMap &balanced,
+            std::vector<std::vector<unsigned> > &succ,
+            std::vector<std::vector<unsigned> > &pred,
+            std::vector<unsigned> &work,
+            unsigned p,
+            unsigned q
+        ) throw() {
+            bool is_new(false);
+            const unsigned id(balanced.find_or_insert(p, q, is_new));
+            if(is_new) {
+                succ[p].push_back(q);
+                pred[q].push_back(p);
+                work.push_back(id);
+            }
+        }
+
+        static const cfg_symbol_string_type read_string(
+            CFG &cfg,
+            fltl::helper::Array<cfg_terminal_type> &E,
+            const pda_symbol_type &sym,
+            const pda_symbol_type &epsilon
+        ) throw() {
+            cfg_symbol_string_type str;
+            if(epsilon == sym) {
+                str = cfg.epsilon();
+            } else {
+                str = E.get(sym.number());
+            }
+            return str;
+        }
+
+        /// get the variable A_pq of the pair with id pq, creating it and
+        /// queuing it to have its productions added if it's new
+        static cfg_variable_type get_variable(
+            CFG &cfg,
+            const helper::PairMap &balanced,
+            std::vector<cfg_variable_type> &A,
+            std::vector<bool> &has_variable,
+            std::vector<unsigned> &work,
+            unsigned pq
+        ) throw() {
+            if(!has_variable[pq]) {
+                char scratch[1024] = {'\0'};
+                sprintf(
+                    scratch,
+                    "A_%u_%u",
+                    balanced.first(pq),
+                    balanced.second(pq)
+                );
+                A[pq] = cfg.get_variable(scratch);
+                has_variable[pq] = true;
+                work.push_back(pq);
+            }
+
+            return A[pq];
+        }
+
+        /// the variable A_pq generates the strings that take the PDA from
+        /// p to q while starting and ending with the same stack. rather
+        /// than making a variable for every pair of states, and the
+        /// production A_pq -> A_pr A_rq for every triple of states, the
+        /// pairs (p, q) for which such a computation exists are found by
+        /// saturation outward from the start state, and then only the
+        /// variables of those pairs that are reachable from the start
+        /// variable are made.
         static void run_pda(
             PDA &pda,
             CFG &cfg,
@@ -199,127 +284,230 @@ namespace grail { namespace algorithm {
             io::verbose("Normalizing PDA...\n");
 
             pda_state_type final_state(normalize(pda));
-            const unsigned num_states(pda.num_states());
-
-            // represents the grammar variables $A_{pq}$ where $p, q \in Q$.
-            fltl::helper::Table<
-                cfg_variable_type
-            > A(num_states, num_states);
+            const unsigned num_states(pda.num_states_capacity());
+            const pda_symbol_type epsilon(pda.epsilon());
 
-            // the various generators over states
-            pda_state_type p;
-            pda_state_type q;
-            pda_state_type r;
-            pda_state_type s;
+            // index the transitions that push t by their sources and their
+            // sinks, and the transitions that pop t by their sources and
+            // their sinks
+            move_index_type push_from(num_states);
+            move_index_type push_into(num_states);
+            move_index_type pop_from(num_states);
+            move_index_type pop_into(num_states);
 
-            pda_generator_type states_p(pda.search(~p));
-            pda_generator_type states_q(pda.search(~q));
-            pda_generator_type states_r(pda.search(~r));
+            pda_transition_type trans;
+            pda_generator_type transitions(pda.search(~trans));
+            for(; transitions.match_next(); ) {
+                const unsigned source(trans.source().number());
+                const unsigned sink(trans.sink().number());
 
-            pda_symbol_type a;
-            pda_symbol_type b;
-            pda_symbol_type t;
+                move_type move;
+                move.read = trans.read();
 
-            io::verbose("Creating mapping between states and variables...\n");
+                if(epsilon != trans.push()) {
+                    move.sym = trans.push().number();
+                    move.state = sink;
+                    push_from[source].push_back(move);
+                    move.state = source;
+                    push_into[sink].push_back(move);
 
-            // initialize the variable table
-            char scratch[1024] = {'\0'};
-            for(; states_p.match_next(); states_q.rewind()) {
-                for(; states_q.match_next(); ) {
-                    sprintf(scratch, "A_%u_%u", p.number(), q.number());
-                    A(p.number(), q.number()) = cfg.get_variable(scratch);
+                } else {
+                    move.sym = trans.pop().number();
+                    move.state = sink;
+                    pop_from[source].push_back(move);
+                    move.state = source;
+                    pop_into[sink].push_back(move);
                 }
+            }
 
-                // add in rules A_pp -> epsilon
-                cfg.add_production(
-                    A(p.number(), p.number()),
-                    cfg.epsilon()
-                );
+            for(unsigned p(0); p < num_states; ++p) {
+                std::sort(pop_from[p].begin(), pop_from[p].end());
+                std::sort(pop_into[p].begin(), pop_into[p].end());
             }
 
-            const pda_symbol_type epsilon(pda.epsilon());
-            cfg_symbol_buffer_type buffer;
+            io::verbose("Finding stack-balanced pairs of states...\n");
+
+            helper::PairMap balanced;
+            std::vector<std::vector<unsigned> > succ(num_states);
+            std::vector<std::vector<unsigned> > pred(num_states);
+            std::vector<unsigned> work;
+
+            // only the pairs (p, q) where p is a state that the PDA can be
+            // in at the bottom of some balanced computation from the start
+            // state are needed. p is needed if it's the start state, if a
+            // needed state pushes and goes to p, or if a needed state has a
+            // balanced computation that ends in p.
+            std::vector<bool> is_needed(num_states, false);
+            std::vector<unsigned> sources;
+
+            const unsigned start(pda.get_start_state().number());
+            is_needed[start] = true;
+            sources.push_back(start);
+
+            for(; !work.empty() || !sources.empty(); ) {
+
+                if(!sources.empty()) {
+                    const unsigned p(sources.back());
+                    sources.pop_back();
+
+                    add_pair(balanced, succ, pred, work, p, p);
+
+                    // p pushes t and goes to r; match against the known
+                    // pairs (r, s) where s pops t
+                    for(unsigned i(0); i < push_from[p].size(); ++i) {
+                        const move_type &push(push_from[p][i]);
+                        const unsigned r(push.state);
+
+                        if(!is_needed[r]) {
+                            is_needed[r] = true;
+                            sources.push_back(r);
+                        }
+
+                        for(unsigned j(0); j < succ[r].size(); ++j) {
+                            const unsigned s(succ[r][j]);
+                            typename std::vector<move_type>::const_iterator it(
+                                std::lower_bound(
+                                    pop_from[s].begin(),
+                                    pop_from[s].end(),
+                                    push
+                                )
+                            );
+
+                            for(; it != pop_from[s].end() && it->sym == push.sym; ++it) {
+                                add_pair(balanced, succ, pred, work, p, it->state);
+                            }
+                        }
+                    }
 
-            io::verbose("Adding productions...\n");
+                    continue;
+                }
 
-            // assume there is a path from r to s that brings the PDA from
-            // an empty stack to an empty stack.
+                const unsigned rs(work.back());
+                work.pop_back();
 
-            // if there is a transition from p to r that brings the PDA from
-            // an empty stack to a stack with t on it and reads a...
-            pda_generator_type p_to_r_push(pda.search(
-                ~p,
-                ~a,
-                epsilon,
-                ~t,
-                ~r
-            ));
+                const unsigned r(balanced.first(rs));
+                const unsigned s(balanced.second(rs));
 
-            /// ... and if there is a transition from s to q that pops t off
-            /// of the stack when reading b
-            pda_generator_type s_to_q_pop(pda.search(
-                ~s,
-                ~b,
-                t,
-                epsilon,
-                ~q
-            ));
+                if(!is_needed[s]) {
+                    is_needed[s] = true;
+                    sources.push_back(s);
+                }
 
-            io::verbose("Adding productions of the form A_pq -> a A_rs b...\n");
+                // p pushes t and goes to r, s pops t and goes to q
+                for(unsigned i(0); i < push_into[r].size(); ++i) {
+                    const move_type &push(push_into[r][i]);
+                    if(!is_needed[push.state]) {
+                        continue;
+                    }
+
+                    typename std::vector<move_type>::const_iterator it(
+                        std::lower_bound(
+                            pop_from[s].begin(),
+                            pop_from[s].end(),
+                            push
+                        )
+                    );
 
-            cfg_symbol_string_type a_str;
-            cfg_symbol_string_type b_str;
+                    for(; it != pop_from[s].end() && it->sym == push.sym; ++it) {
+                        add_pair(balanced, succ, pred, work, push.state, it->state);
+                    }
+                }
 
-            // then add A_pq -> a A_rs b
-            for(; p_to_r_push.match_next(); ) {
+                // x to r to s, and r to s to y
+                for(unsigned i(0); i < pred[r].size(); ++i) {
+                    add_pair(balanced, succ, pred, work, pred[r][i], s);
+                }
 
-                if(epsilon == a) {
-                    a_str = cfg.epsilon();
-                } else {
-                    a_str = E.get(a.number());
+                for(unsigned i(0); i < succ[s].size(); ++i) {
+                    add_pair(balanced, succ, pred, work, r, succ[s][i]);
                 }
+            }
 
-                // t becomes bound by p_to_r_push
+            io::verbose(
+                "Found %u stack-balanced pairs of states.\n",
+                balanced.size()
+            );
 
-                for(s_to_q_pop.rewind();
-                    s_to_q_pop.match_next();) {
+            io::verbose("Adding productions...\n");
 
-                    if(epsilon == b) {
-                        b_str = cfg.epsilon();
-                    } else {
-                        b_str = E.get(b.number());
-                    }
+            std::vector<cfg_variable_type> A(balanced.size());
+            std::vector<bool> has_variable(balanced.size(), false);
+            cfg_symbol_buffer_type buffer;
 
-                    cfg.add_production(
-                        A(p.number(), q.number()),
-                        buffer.clear()
-                         << a_str
-                         << A(r.number(), s.number())
-                         << b_str
-                    );
-                }
+            const unsigned accept(final_state.number());
+            unsigned pq(0);
+
+            // the language of the PDA is empty
+            if(!balanced.find(start, accept, pq)) {
+                char scratch[1024] = {'\0'};
+                sprintf(scratch, "A_%u_%u", start, accept);
+                cfg.set_start_variable(cfg.get_variable(scratch));
+                return;
             }
 
-            // set the start variable
-            cfg.set_start_variable(A(
-                pda.get_start_state().number(),
-                final_state.number()
-            ));
+            cfg.set_start_variable(
+                get_variable(cfg, balanced, A, has_variable, work, pq)
+            );
+
+            typename CFG::bulk_loader_type loader(cfg);
+
+            for(; !work.empty(); ) {
+                pq = work.back();
+                work.pop_back();
+
+                const unsigned p(balanced.first(pq));
+                const unsigned q(balanced.second(pq));
+                const cfg_variable_type A_pq(A[pq]);
+                unsigned id(0);
+
+                // A_pp -> epsilon
+                if(p == q) {
+                    loader.add_production(A_pq, cfg.epsilon());
+                }
+
+                // A_pq -> a A_rs b, where p reads a, pushes t, and goes to
+                // r, and s reads b, pops t, and goes to q
+                for(unsigned i(0); i < push_from[p].size(); ++i) {
+                    const move_type &push(push_from[p][i]);
+                    typename std::vector<move_type>::const_iterator it(
+                        std::lower_bound(
+                            pop_into[q].begin(),
+                            pop_into[q].end(),
+                            push
+                        )
+                    );
 
-            io::verbose("Adding productions of the form A_pq -> A_pr A_rq...\n");
+                    for(; it != pop_into[q].end() && it->sym == push.sym; ++it) {
+                        if(!balanced.find(push.state, it->state, id)) {
+                            continue;
+                        }
 
-            // add in rules $A_{pq} \to A_{pr} A_{rq}$ to the grammar
-            for(states_p.rewind(); states_p.match_next(); ) {
-                for(states_q.rewind(); states_q.match_next(); ) {
-                    for(states_r.rewind(); states_r.match_next(); ) {
-                        cfg.add_production(
-                            A(p.number(), q.number()),
+                        loader.add_production(
+                            A_pq,
                             buffer.clear()
-                             << A(p.number(), r.number())
-                             << A(r.number(), q.number())
+                             << read_string(cfg, E, push.read, epsilon)
+                             << get_variable(cfg, balanced, A, has_variable, work, id)
+                             << read_string(cfg, E, it->read, epsilon)
                         );
                     }
                 }
+
+                // A_pq -> A_pr A_rq
+                for(unsigned i(0); i < succ[p].size(); ++i) {
+                    const unsigned r(succ[p][i]);
+                    unsigned pr(0);
+
+                    if(!balanced.find(r, q, id) || !balanced.find(p, r, pr)) {
+                        continue;
+                    }
+
+                    loader.add_production(
+                        A_pq,
+                        buffer.clear()
+                         << get_variable(cfg, balanced, A, has_variable, work, pr)
+                         << get_variable(cfg, balanced, A, has_variable, work, id)
+                    );
+                }
             }
         }
 
@@ -358,18 +546,23 @@ namespace grail { namespace algorithm {
 
             io::verbose("Adding productions...\n");
 
+            typename CFG::bulk_loader_type loader(cfg);
+            cfg_symbol_buffer_type buffer;
+
             for(; transitions.match_next(); ) {
 
                 if(input == pda.epsilon()) {
-                    cfg.add_production(
+                    loader.add_production(
                         A.get(source.number()),
-                        A.get(sink.number())
+                        buffer.clear() << A.get(sink.number())
                     );
                 } else {
 
-                    cfg.add_production(
+                    loader.add_production(
                         A.get(source.number()),
-                        E.get(input.number()) + A.get(sink.number())
+                        buffer.clear()
+                         << E.get(input.number())
+                         << A.get(sink.number())
                     );
                 }
             }
@@ -379,9 +572,11 @@ namespace grail { namespace algorithm {
                     continue;
                 }
 
-                cfg.add_production(A.get(source.number()), cfg.epsilon());
+                loader.add_production(A.get(source.number()), cfg.epsilon());
             }
 
+            loader.commit();
+
             cfg.set_start_variable(A.get(pda.get_start_state().number()));
         }
 
@@ -0,0 +1,337 @@
+/*
+ * AnalysisCache.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_ANALYSISCACHE_HPP_
+#define FLTL_ANALYSISCACHE_HPP_
+
+#include <cassert>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "fltl/include/helper/BitMatrix.hpp"
+
+namespace grail { namespace cfg {
+
+    /// keeps the NULL set and the FIRST sets of terminals of a grammar up
+    /// to date as the grammar is edited. The cache listens to the grammar:
+    /// adding a production can only grow these sets, so additions are
+    /// applied incrementally, and only the sets that actually change are
+    /// revisited. Removals invalidate the cache, which is then rebuilt
+    /// the next time that it is queried.
+    ///
+    /// Each production keeps how far along its RHS the nullable prefix
+    /// extends. A production whose prefix stops at a variable waits on
+    /// that variable; if the variable becomes nullable, then the prefix
+    /// is extended further. A variable's FIRST set includes the FIRST sets
+    /// of the variables in the prefixes of its productions, so when a
+    /// FIRST set grows, the growth is pushed to the variables that depend
+    /// on it.
+    template <typename AlphaT>
+    class AnalysisCache : public fltl::cfg::Listener<AlphaT> {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+    private:
+
+        enum {
+            TERMINAL_TAG = 1U,
+            TAG_BITS = 1U
+        };
+
+        CFG &cfg;
+
+        /// do the sets reflect the current grammar?
+        bool is_valid;
+
+        /// the flattened productions. the RHS of production p is the
+        /// range [first_symbol[p], first_symbol[p + 1]) of symbols, where
+        /// each symbol is its number, shifted over by TAG_BITS and tagged
+        /// with whether or not it is a terminal.
+        std::vector<unsigned> head;
+        std::vector<unsigned> first_symbol;
+        std::vector<unsigned> symbols;
+
+        /// how far along the RHS of each production the nullable prefix
+        /// extends
+        std::vector<unsigned> prefix_length;
+
+        std::vector<bool> nullable;
+        fltl::helper::BitMatrix first;
+
+        /// the variables whose FIRST sets include the FIRST set of each
+        /// variable
+        std::vector<std::vector<unsigned> > dependents;
+
+        /// the productions whose nullable prefixes stop at each variable
+        std::vector<std::vector<unsigned> > waiting_on;
+
+        /// variables that have become nullable, and variables whose FIRST
+        /// sets have grown, that haven't yet been pushed to the
+        /// productions and variables that depend on them
+        std::vector<unsigned> nullable_work;
+        std::vector<unsigned> first_work;
+
+        /// recompute everything from scratch. the sets are given some
+        /// room to grow so that adding variables and terminals doesn't
+        /// always force a rebuild.
+        void rebuild(void) throw() {
+            const unsigned num_vars(2U * (cfg.num_variables_capacity() + 2U));
+            const unsigned num_terms(2U * (cfg.num_terminals() + 2U));
+
+            head.clear();
+            first_symbol.assign(1U, 0U);
+            symbols.clear();
+            prefix_length.clear();
+            nullable.assign(num_vars, false);
+            first.resize(num_vars, num_terms);
+            dependents.assign(num_vars, std::vector<unsigned>());
+            waiting_on.assign(num_vars, std::vector<unsigned>());
+            nullable_work.clear();
+            first_work.clear();
+
+            is_valid = true;
+
+            production_type prod;
+            generator_type productions(cfg.search(~prod));
+            for(; productions.match_next(); ) {
+                add(prod);
+            }
+
+            propagate();
+        }
+
+        /// flatten a production and extend its nullable prefix as far as
+        /// possible. this invalidates the cache if the production uses
+        /// symbols that don't fit in the sets.
+        void add(const production_type &prod) throw() {
+            const unsigned V(prod.variable().number());
+            if(V >= nullable.size()) {
+                is_valid = false;
+                return;
+            }
+
+            const unsigned len(prod.length());
+            const size_t old_size(symbols.size());
+
+            for(unsigned i(0); i < len; ++i) {
+                const symbol_type sym(prod.symbol_at(i));
+                const unsigned num(sym.number());
+
+                if(sym.is_variable()) {
+                    if(num >= nullable.size()) {
+                        is_valid = false;
+                    }
+                    symbols.push_back(num << TAG_BITS);
+                } else {
+                    if(num >= first.num_columns()) {
+                        is_valid = false;
+                    }
+                    symbols.push_back((num << TAG_BITS) | TERMINAL_TAG);
+                }
+            }
+
+            if(!is_valid) {
+                symbols.resize(old_size);
+                return;
+            }
+
+            const unsigned p(static_cast<unsigned>(head.size()));
+            head.push_back(V);
+            first_symbol.push_back(static_cast<unsigned>(symbols.size()));
+            prefix_length.push_back(0U);
+
+            extend(p);
+        }
+
+        /// extend the nullable prefix of a production, adding to the FIRST
+        /// set of its variable along the way
+        void extend(const unsigned p) throw() {
+            const unsigned A(head[p]);
+            const unsigned begin(first_symbol[p]);
+            const unsigned len(first_symbol[p + 1U] - begin);
+
+            for(; prefix_length[p] < len; ++(prefix_length[p])) {
+                const unsigned sym(symbols[begin + prefix_length[p]]);
+
+                // can't move past a terminal
+                if(0 != (sym & TERMINAL_TAG)) {
+                    if(first.set(A, sym >> TAG_BITS)) {
+                        first_work.push_back(A);
+                    }
+                    return;
+                }
+
+                const unsigned W(sym >> TAG_BITS);
+                if(W != A) {
+                    dependents[W].push_back(A);
+                    if(first.union_rows(A, W)) {
+                        first_work.push_back(A);
+                    }
+                }
+
+                // can't move past W until it becomes nullable
+                if(!nullable[W]) {
+                    waiting_on[W].push_back(p);
+                    return;
+                }
+            }
+
+            // the whole RHS is nullable
+            if(!nullable[A]) {
+                nullable[A] = true;
+                nullable_work.push_back(A);
+            }
+        }
+
+        /// push newly nullable variables and grown FIRST sets to the
+        /// productions and variables that depend on them
+        void propagate(void) throw() {
+            std::vector<unsigned> waiting;
+
+            for(; !nullable_work.empty() || !first_work.empty(); ) {
+
+                for(; !nullable_work.empty(); ) {
+                    const unsigned W(nullable_work.back());
+                    nullable_work.pop_back();
+
+                    waiting.clear();
+                    waiting.swap(waiting_on[W]);
+
+                    for(unsigned i(0); i < waiting.size(); ++i) {
+                        const unsigned p(waiting[i]);
+                        ++(prefix_length[p]);
+                        extend(p);
+                    }
+                }
+
+                for(; !first_work.empty(); ) {
+                    const unsigned W(first_work.back());
+                    first_work.pop_back();
+
+                    const std::vector<unsigned> &deps(dependents[W]);
+                    for(unsigned i(0); i < deps.size(); ++i) {
+                        if(first.union_rows(deps[i], W)) {
+                            first_work.push_back(deps[i]);
+                        }
+                    }
+                }
+            }
+        }
+
+        inline void update(void) throw() {
+            if(!is_valid) {
+                rebuild();
+            }
+        }
+
+    public:
+
+        /// attach a cache to a grammar
+        AnalysisCache(CFG &cfg_) throw()
+            : fltl::cfg::Listener<AlphaT>()
+            , cfg(cfg_)
+            , is_valid(false)
+        {
+            cfg.add_listener(this);
+        }
+
+        virtual ~AnalysisCache(void) throw() { }
+
+        virtual void on_add_production(const production_type &prod) throw() {
+            if(is_valid) {
+                add(prod);
+                propagate();
+            }
+        }
+
+        virtual void on_remove_production(const production_type &) throw() {
+            is_valid = false;
+        }
+
+        virtual void on_remove_variable(const variable_type) throw() {
+            is_valid = false;
+        }
+
+        /// can a variable derive epsilon?
+        bool is_nullable(const variable_type V) throw() {
+            update();
+            return V.number() < nullable.size() && nullable[V.number()];
+        }
+
+        /// is a terminal in the FIRST set of a variable?
+        bool is_first(const variable_type V, const terminal_type T) throw() {
+            update();
+            return V.number() < first.num_rows()
+                && T.number() < first.num_columns()
+                && first.test(V.number(), T.number());
+        }
+
+        /// get the NULL set, in the same form as compute_null_set
+        void get_null_set(std::vector<bool> &out) throw() {
+            update();
+
+            const unsigned num_vars(cfg.num_variables_capacity() + 2U);
+            out.assign(num_vars, false);
+
+            for(unsigned V(0); V < num_vars && V < nullable.size(); ++V) {
+                out[V] = nullable[V];
+            }
+        }
+
+        /// get the FIRST sets of terminals, in the same form as
+        /// compute_first_terminals
+        void get_first_terminals(std::vector<std::vector<bool> *> &out) throw() {
+            update();
+
+            const unsigned num_terms(cfg.num_terminals() + 2U);
+            const unsigned max_term(
+                num_terms < first.num_columns() ? num_terms : first.num_columns()
+            );
+
+            out.assign(cfg.num_variables_capacity() + 2U, 0);
+
+            variable_type V;
+            generator_type variables(cfg.search(~V));
+            for(; variables.match_next(); ) {
+                const unsigned v(V.number());
+                std::vector<bool> *set(new std::vector<bool>(num_terms, false));
+                out[v] = set;
+
+                if(v >= first.num_rows()) {
+                    continue;
+                }
+
+                for(unsigned t(first.next(v, 0U));
+                    t < max_term;
+                    t = first.next(v, t + 1U)) {
+                    (*set)[t] = true;
+                }
+            }
+        }
+    };
+}}
+
+#endif /* FLTL_ANALYSISCACHE_HPP_ */
@@ -0,0 +1,213 @@
+/*
+ * ItemTable.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_ITEMTABLE_HPP_
+#define FLTL_ITEMTABLE_HPP_
+
+#include <cassert>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+namespace grail { namespace cfg {
+
+    /// a compiled form of a grammar for item-based parsers. Every dotted
+    /// production A --> a * b is given a slot in a flat array of items,
+    /// and the slots of a production are contiguous, so that moving the
+    /// dot over one symbol is the same as moving to the next slot. Each
+    /// slot is tagged with what a parser should do with it. The
+    /// productions of each variable are also contiguous, so that the
+    /// productions of a variable can be found by range.
+    template <typename AlphaT>
+    class ItemTable {
+    public:
+
+        typedef fltl::CFG<AlphaT> CFG;
+
+        FLTL_CFG_USE_TYPES(CFG);
+
+        typedef enum {
+            ITEM_PREDICT,
+            ITEM_SCAN,
+            ITEM_COMPLETE
+        } item_kind;
+
+        /// a dotted production
+        class item_type {
+        public:
+
+            item_kind kind;
+
+            /// position of the dot in the production
+            unsigned dot;
+
+            /// offset of the production in the table
+            unsigned production;
+
+            /// the symbol after the dot for predict and scan items, or the
+            /// variable of the production for complete items
+            symbol_type symbol;
+
+            /// number of symbol
+            unsigned number;
+
+            /// is the symbol after the dot a variable terminal?
+            bool is_variable_terminal;
+
+            item_type(void)
+                : kind(ITEM_COMPLETE)
+                , dot(0)
+                , production(0)
+                , symbol()
+                , number(0)
+                , is_variable_terminal(false)
+            { }
+        };
+
+    private:
+
+        std::vector<item_type> items;
+        std::vector<production_type> productions;
+
+        /// offset of the first item of each production
+        std::vector<unsigned> production_items;
+
+        /// the productions of the variable with number V are in the range
+        /// [variable_productions[V], variable_productions[V + 1])
+        std::vector<unsigned> variable_productions;
+
+    public:
+
+        ItemTable(void) throw()
+            : items()
+            , productions()
+            , production_items()
+            , variable_productions()
+        { }
+
+        /// compile the productions of a grammar into the table
+        void build(CFG &cfg) throw() {
+            const unsigned num_vars(cfg.num_variables_capacity() + 2U);
+
+            production_type prod;
+            generator_type all_productions(cfg.search(~prod));
+
+            items.clear();
+            productions.clear();
+            variable_productions.assign(num_vars + 1U, 0U);
+
+            // count the productions of each variable, then turn the counts
+            // into the end of the range of each variable
+            for(; all_productions.match_next(); ) {
+                ++(variable_productions[prod.variable().number() + 1U]);
+                productions.push_back(prod);
+            }
+
+            production_items.assign(productions.size(), 0U);
+
+            for(unsigned V(1U); V <= num_vars; ++V) {
+                variable_productions[V] += variable_productions[V - 1U];
+            }
+
+            // place the productions, moving the start of each range
+            // forward, then restore the starts
+            for(all_productions.rewind(); all_productions.match_next(); ) {
+                productions[variable_productions[prod.variable().number()]++] = prod;
+            }
+
+            for(unsigned V(num_vars); 0U < V; --V) {
+                variable_productions[V] = variable_productions[V - 1U];
+            }
+            variable_productions[0] = 0U;
+
+            // lay out the dotted items
+            item_type item;
+            for(unsigned p(0); p < productions.size(); ++p) {
+                const production_type &P(productions[p]);
+                const unsigned len(P.length());
+
+                production_items[p] = static_cast<unsigned>(items.size());
+                item.production = p;
+
+                for(unsigned dot(0); dot < len; ++dot) {
+                    item.dot = dot;
+                    item.symbol = P.symbol_at(dot);
+                    item.number = item.symbol.number();
+
+                    if(item.symbol.is_variable()) {
+                        item.kind = ITEM_PREDICT;
+                        item.is_variable_terminal = false;
+                    } else {
+                        item.kind = ITEM_SCAN;
+                        item.is_variable_terminal = cfg.is_variable_terminal(
+                            terminal_type(item.symbol)
+                        );
+                    }
+
+                    items.push_back(item);
+                }
+
+                item.kind = ITEM_COMPLETE;
+                item.dot = len;
+                item.symbol = P.variable();
+                item.number = item.symbol.number();
+                item.is_variable_terminal = false;
+                items.push_back(item);
+            }
+        }
+
+        inline const item_type &item(const unsigned i) const throw() {
+            assert(i < items.size());
+            return items[i];
+        }
+
+        inline unsigned num_items(void) const throw() {
+            return static_cast<unsigned>(items.size());
+        }
+
+        inline unsigned num_productions(void) const throw() {
+            return static_cast<unsigned>(productions.size());
+        }
+
+        inline production_type &production(const unsigned p) throw() {
+            assert(p < productions.size());
+            return productions[p];
+        }
+
+        /// the item with the dot at the beginning of a production
+        inline unsigned first_item(const unsigned p) const throw() {
+            assert(p < production_items.size());
+            return production_items[p];
+        }
+
+        /// the range of productions of a variable
+        inline unsigned productions_begin(const unsigned V) const throw() {
+            return variable_productions[V];
+        }
+
+        inline unsigned productions_end(const unsigned V) const throw() {
+            return variable_productions[V + 1U];
+        }
+    };
+}}
+
+#endif /* FLTL_ITEMTABLE_HPP_ */
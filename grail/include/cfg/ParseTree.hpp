@@ -46,6 +46,7 @@ namespace grail { namespace cfg {
         typedef typename CFG::symbol_type symbol_type;
         typedef typename CFG::production_type production_type;
         typedef typename CFG::alphabet_type alphabet_type;
+        typedef typename CFG::traits_type traits_type;
 
         typedef ParseTree<AlphaT> self_type;
 
@@ -78,16 +79,23 @@ namespace grail { namespace cfg {
             }
         }
 
-        ParseTree(terminal_type term, const alphabet_type *alpha_)
+        /// leaf of the tree; the leaf holds its own copy of the lexeme that
+        /// was matched against the terminal
+        ParseTree(terminal_type term, const alphabet_type &alpha_) throw()
             : symbol(term)
             , num_children(-1)
             , parent(0)
         {
-            data.alpha = alpha_;
+            data.alpha = new alphabet_type(traits_type::copy(alpha_));
         }
 
         ~ParseTree(void) throw() {
             if(-1 == num_children) {
+                if(0 != data.alpha) {
+                    alphabet_type *alpha(const_cast<alphabet_type *>(data.alpha));
+                    traits_type::destroy(*alpha);
+                    delete alpha;
+                }
                 data.alpha = 0;
             } else if(0 < num_children) {
                 for(int i(0); i < num_children; ++i) {
@@ -117,6 +125,17 @@ namespace grail { namespace cfg {
             assert(false);
         }
 
+        // detach the child in a given slot so that it outlives this tree
+        self_type *remove_child(const int i) throw() {
+            assert(0 <= i && i < num_children);
+            self_type *child(data.slots[i]);
+            data.slots[i] = 0;
+            if(0 != child) {
+                child->parent = 0;
+            }
+            return child;
+        }
+
         // can a child be added?
         bool can_add_child(void) const throw() {
             if(0 == num_children) {
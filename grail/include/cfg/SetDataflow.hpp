@@ -0,0 +1,243 @@
+/*
+ * SetDataflow.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_SETDATAFLOW_HPP_
+#define FLTL_SETDATAFLOW_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "fltl/include/helper/BitMatrix.hpp"
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace grail { namespace cfg {
+
+    /// solves a system of set equations of the form
+    ///
+    ///     X[v] = B[v] u X[w_1] u ... u X[w_n]
+    ///
+    /// where B[v] is a set of base elements of the node v, and there is a
+    /// dependency edge from v to each w_i. This is the shape of the FIRST
+    /// set analyses of a grammar, where the nodes are variables.
+    ///
+    /// Instead of iterating over every equation until nothing changes, the
+    /// dependency graph is split into its strongly connected components.
+    /// Every node of a component has the same solution, and Tarjan's
+    /// algorithm finishes a component only after every component that it
+    /// depends on, so each component is solved exactly once by unioning
+    /// word-packed bitsets.
+    class SetDataflow : private fltl::trait::Uncopyable {
+    private:
+
+        enum {
+            UNVISITED = ~0U
+        };
+
+        fltl::helper::BitMatrix sets;
+
+        /// dependency edges, in the order they were added
+        std::vector<unsigned> edge_source;
+        std::vector<unsigned> edge_target;
+
+        /// a node being visited by tarjan's algorithm, along with the next
+        /// of its edges to follow
+        class Frame {
+        public:
+            unsigned node;
+            unsigned next_edge;
+        };
+
+    public:
+
+        SetDataflow(unsigned num_nodes, unsigned num_elements) throw()
+            : fltl::trait::Uncopyable()
+            , sets(num_nodes, num_elements)
+            , edge_source()
+            , edge_target()
+        { }
+
+        /// add an element to the base set of a node
+        inline void add_element(unsigned node, unsigned element) throw() {
+            sets.set(node, element);
+        }
+
+        /// add a row of a matrix, e.g. the solution of another system, to
+        /// the base set of a node
+        inline void add_elements(
+            unsigned node,
+            const fltl::helper::BitMatrix &elements,
+            unsigned row
+        ) throw() {
+            sets.union_rows(node, elements, row);
+        }
+
+        /// make the set of a node include the set of another node
+        inline void add_dependency(unsigned node, unsigned on) throw() {
+            if(node != on) {
+                edge_source.push_back(node);
+                edge_target.push_back(on);
+            }
+        }
+
+        /// solve the equations. after this, the row of each node in
+        /// solution() is that node's set.
+        void solve(void) throw() {
+            const unsigned num_nodes(sets.num_rows());
+            const unsigned num_edges(
+                static_cast<unsigned>(edge_source.size())
+            );
+
+            // group the edges by source node
+            std::vector<unsigned> first_edge(num_nodes + 1U, 0U);
+            std::vector<unsigned> targets(num_edges, 0U);
+
+            for(unsigned e(0); e < num_edges; ++e) {
+                ++(first_edge[edge_source[e] + 1U]);
+            }
+
+            for(unsigned v(0); v < num_nodes; ++v) {
+                first_edge[v + 1U] += first_edge[v];
+            }
+
+            std::vector<unsigned> next_slot(first_edge);
+            for(unsigned e(0); e < num_edges; ++e) {
+                targets[next_slot[edge_source[e]]++] = edge_target[e];
+            }
+
+            // component of each node, or UNVISITED if the node's component
+            // hasn't been finished
+            std::vector<unsigned> component(num_nodes, UNVISITED);
+            std::vector<unsigned> index(num_nodes, UNVISITED);
+            std::vector<unsigned> low_link(num_nodes, 0U);
+            std::vector<unsigned> stack;
+            std::vector<Frame> frames;
+
+            unsigned next_index(0);
+            unsigned next_component(0);
+
+            for(unsigned root(0); root < num_nodes; ++root) {
+                if(UNVISITED != index[root]) {
+                    continue;
+                }
+
+                Frame root_frame;
+                root_frame.node = root;
+                root_frame.next_edge = first_edge[root];
+                frames.push_back(root_frame);
+
+                index[root] = low_link[root] = next_index++;
+                stack.push_back(root);
+
+                for(; !frames.empty(); ) {
+                    Frame &frame(frames.back());
+                    const unsigned v(frame.node);
+
+                    // visit the next dependency
+                    if(frame.next_edge < first_edge[v + 1U]) {
+                        const unsigned w(targets[frame.next_edge++]);
+
+                        if(UNVISITED == index[w]) {
+                            Frame next_frame;
+                            next_frame.node = w;
+                            next_frame.next_edge = first_edge[w];
+
+                            index[w] = low_link[w] = next_index++;
+                            stack.push_back(w);
+                            frames.push_back(next_frame);
+
+                        // w is on the stack
+                        } else if(UNVISITED == component[w]) {
+                            low_link[v] = std::min(low_link[v], index[w]);
+                        }
+
+                        continue;
+                    }
+
+                    frames.pop_back();
+
+                    if(!frames.empty()) {
+                        const unsigned u(frames.back().node);
+                        low_link[u] = std::min(low_link[u], low_link[v]);
+                    }
+
+                    if(low_link[v] != index[v]) {
+                        continue;
+                    }
+
+                    // v is the root of a component; the component is
+                    // everything above v on the stack
+                    const unsigned c(next_component++);
+                    size_t base(stack.size());
+                    do {
+                        --base;
+                        component[stack[base]] = c;
+                    } while(stack[base] != v);
+
+                    // union the base sets of the component into v, then
+                    // the solutions of the components it depends on, all
+                    // of which are finished
+                    for(size_t i(base); i < stack.size(); ++i) {
+                        const unsigned m(stack[i]);
+                        sets.union_rows(v, m);
+
+                        for(unsigned e(first_edge[m]);
+                            e < first_edge[m + 1U];
+                            ++e) {
+
+                            const unsigned w(targets[e]);
+                            if(c != component[w]) {
+                                sets.union_rows(v, w);
+                            }
+                        }
+                    }
+
+                    for(size_t i(base); i < stack.size(); ++i) {
+                        sets.copy_row(stack[i], v);
+                    }
+
+                    stack.resize(base);
+                }
+            }
+        }
+
+        /// the solution; row v is the set of node v
+        inline const fltl::helper::BitMatrix &solution(void) const throw() {
+            return sets;
+        }
+
+        /// copy the set of a node into a vector of bools, which should
+        /// have at least as many elements as there are columns in the
+        /// solution
+        void get(unsigned node, std::vector<bool> &set) const throw() {
+            assert(set.size() >= sets.num_columns());
+            for(unsigned i(sets.next(node, 0U));
+                i < sets.num_columns();
+                i = sets.next(node, i + 1U)) {
+                set[i] = true;
+            }
+        }
+    };
+}}
+
+#endif /* FLTL_SETDATAFLOW_HPP_ */
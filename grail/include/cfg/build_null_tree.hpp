@@ -0,0 +1,106 @@
+/*
+ * build_null_tree.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_BUILD_NULL_TREE_HPP_
+#define FLTL_BUILD_NULL_TREE_HPP_
+
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/cfg/ParseTree.hpp"
+
+namespace grail { namespace cfg {
+
+    /// find, for each nullable variable, a production that derives
+    /// epsilon without (indirectly) using that variable again. These
+    /// are used to expand the empty derivations of a parse forest.
+    template <typename AlphaT>
+    void find_null_productions(
+        fltl::CFG<AlphaT> &cfg,
+        std::vector<typename fltl::CFG<AlphaT>::production_type> &null_prods
+    ) throw() {
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        production_type prod;
+        variable_type V;
+        generator_type productions(cfg.search(~prod));
+
+        null_prods.assign(
+            cfg.num_variables_capacity() + 2,
+            production_type()
+        );
+
+        for(bool updated(true); updated; productions.rewind()) {
+            updated = false;
+
+            for(; productions.match_next(); ) {
+                V = prod.variable();
+                if(null_prods[V.number()].is_valid()) {
+                    continue;
+                }
+
+                const unsigned len(prod.length());
+                unsigned i(0);
+                for(; i < len; ++i) {
+                    if(prod.symbol_at(i).is_terminal()) {
+                        break;
+                    }
+
+                    V = prod.symbol_at(i);
+                    if(!null_prods[V.number()].is_valid()) {
+                        break;
+                    }
+                }
+
+                if(len == i) {
+                    null_prods[prod.variable().number()] = prod;
+                    updated = true;
+                }
+            }
+        }
+    }
+
+    /// build the tree for an empty derivation of a variable
+    template <typename AlphaT>
+    ParseTree<AlphaT> *build_null_tree(
+        const typename fltl::CFG<AlphaT>::variable_type &var,
+        std::vector<typename fltl::CFG<AlphaT>::production_type> &null_prods
+    ) throw() {
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        production_type &prod(null_prods[var.number()]);
+        ParseTree<AlphaT> *tree(new ParseTree<AlphaT>(prod));
+
+        variable_type V;
+        for(unsigned i(prod.length()); 0 != i--; ) {
+            V = prod.symbol_at(i);
+            tree->add_child(build_null_tree<AlphaT>(V, null_prods));
+        }
+
+        return tree;
+    }
+}}
+
+#endif /* FLTL_BUILD_NULL_TREE_HPP_ */
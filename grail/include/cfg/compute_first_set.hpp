@@ -34,44 +34,14 @@
 
 #include "fltl/include/CFG.hpp"
 
-namespace grail { namespace cfg {
-
-    namespace detail {
-
-        template <typename T>
-        inline bool insert(std::vector<bool> *vec, T term) throw() {
-            std::vector<bool>::reference bit(vec->operator[](term.number()));
-            if(!bit) {
-                bit = true;
-                return true;
-            } else {
-                return false;
-            }
-        }
-
-        bool union_into(std::vector<bool> *dest, const std::vector<bool> *sub) throw() {
-            if(0 == dest || 0 == sub) {
-                return false;
-            }
-
-            assert(dest->size() == sub->size());
+#include "grail/include/cfg/SetDataflow.hpp"
 
-            bool updated(false);
-
-            for(size_t i(0), len(dest->size()); i < len; ++i) {
-                std::vector<bool>::reference ith(dest->operator[](i));
-                if(sub->operator[](i) && !ith) {
-                    ith = true;
-                    updated = true;
-                }
-            }
-
-            return updated;
-        }
-
-    }
+namespace grail { namespace cfg {
 
     /// compute the first sets of termianls for the variables of a CFG.
+    /// a variable's set includes the terminals that start its productions
+    /// after any nullable prefix, and the sets of the variables in that
+    /// prefix and the variable that follows it.
     template <typename AlphaT>
     void compute_first_terminals(
         const fltl::CFG<AlphaT> &cfg,
@@ -81,85 +51,49 @@ namespace grail { namespace cfg {
 
         FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
 
-        typedef std::vector<bool> terminal_set_type;
-
-        first.assign(cfg.num_variables_capacity() + 2, 0);
+        const unsigned num_vars(cfg.num_variables_capacity() + 2);
+        const unsigned num_terms(cfg.num_terminals() + 2);
 
-        // allocate the sets
-        variable_type V;
-        generator_type variables(cfg.search(~V));
-        for(; variables.match_next(); ) {
-            first[V.number()] = new std::vector<bool>(
-                cfg.num_terminals() + 2, false
-            );
-        }
+        first.assign(num_vars, 0);
 
-        // base case, all productions with a terminal as the first symbol on
-        // their RHS
-        terminal_type T;
-        generator_type first_subsets(cfg.search((~V) --->* ~T + cfg.__));
-        bool updated(false);
-        for(; first_subsets.match_next(); ) {
-            detail::insert(first[V.number()], T);
-            updated = true;
-        }
+        SetDataflow flow(num_vars, num_terms);
 
-        // induction step. note: base case won't necessarily yield anything
-        // if every production has a form like "A -> alpha t beta" where
-        // alpha is a sequence of one or more nullable variables and t is a
-        // terminal.
-        variable_type A;
-        variable_type reached;
         production_type prod;
-        generator_type next_subsets(cfg.search(~prod, V --->* ~A + cfg.__));
-        terminal_set_type *curr_set(0);
-        terminal_set_type *reached_set(0);
-
-        updated = true;
-        for(; updated; ) {
-            updated = false;
-
-            for(variables.rewind(); variables.match_next(); ) {
-
-                curr_set = first[V.number()];
-
-                for(next_subsets.rewind(); next_subsets.match_next(); ) {
-
-                    for(unsigned i(0), len(prod.symbols().length());
-                        i < len;
-                        ++i) {
-
-                        // found a terminal, add it in; can't move past it
-                        if(prod.symbol_at(i).is_terminal()) {
-
-                            updated = detail::insert(
-                                curr_set,
-                                terminal_type(prod.symbol_at(i))
-                            ) || updated;
+        symbol_string_type str;
+        variable_type V, W;
+        generator_type productions(cfg.search(~prod));
 
-                            break;
+        for(; productions.match_next(); ) {
+            str = prod.symbols();
+            V = prod.variable();
 
-                        // found a variable, union in, try to move past
-                        } else {
-                            reached = prod.symbol_at(i);
-                            reached_set = first[reached.number()];
+            for(unsigned i(0), len(str.length()); i < len; ++i) {
 
-                            assert(0 != reached_set);
+                // found a terminal, add it in; can't move past it
+                if(str.at(i).is_terminal()) {
+                    terminal_type T(str.at(i));
+                    flow.add_element(V.number(), T.number());
+                    break;
+                }
 
-                            updated = detail::union_into(
-                                curr_set,
-                                reached_set
-                            ) || updated;
+                // found a variable, depend on it, try to move past
+                W = str.at(i);
+                flow.add_dependency(V.number(), W.number());
 
-                            // can't move past
-                            if(!nullable[reached.number()]) {
-                                break;
-                            }
-                        }
-                    }
+                if(!nullable[W.number()]) {
+                    break;
                 }
             }
         }
+
+        flow.solve();
+
+        // allocate and fill in the sets
+        generator_type variables(cfg.search(~V));
+        for(; variables.match_next(); ) {
+            first[V.number()] = new std::vector<bool>(num_terms, false);
+            flow.get(V.number(), *(first[V.number()]));
+        }
     }
 
 
@@ -173,57 +107,47 @@ namespace grail { namespace cfg {
 
         FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
 
-        typedef std::vector<bool> terminal_set_type;
-
         const unsigned num_vars(cfg.num_variables_capacity() + 2);
 
         first.assign(num_vars, 0);
 
-        // allocate the sets
-        variable_type V, W;
-        generator_type variables(cfg.search(~V));
-        for(; variables.match_next(); ) {
-            first[V.number()] = new std::vector<bool>(num_vars, false);
-        }
-
-        production_type production;
-        generator_type productions(cfg.search(~production));
-
-        terminal_set_type *source_set(0);
-        terminal_set_type *reached_set(0);
+        SetDataflow flow(num_vars, num_vars);
 
+        production_type prod;
         symbol_string_type str;
+        variable_type V, W;
+        generator_type productions(cfg.search(~prod));
 
-        bool updated(true);
-        for(; updated; ) {
-            updated = false;
-
-            for(productions.rewind(); productions.match_next(); ) {
-
-                str = production.symbols();
-                V = production.variable();
-                source_set = first[V.number()];
-
-                for(unsigned i(0); i < str.length(); ++i) {
+        for(; productions.match_next(); ) {
+            str = prod.symbols();
+            V = prod.variable();
 
-                    // can't walk past a terminal
-                    if(str.at(i).is_terminal()) {
-                        break;
-                    }
+            for(unsigned i(0), len(str.length()); i < len; ++i) {
 
-                    W = str.at(i);
-                    reached_set = first[W.number()];
+                // can't walk past a terminal
+                if(str.at(i).is_terminal()) {
+                    break;
+                }
 
-                    updated = detail::insert(source_set, W) || updated;
-                    updated = detail::union_into(source_set, reached_set) || updated;
+                W = str.at(i);
+                flow.add_element(V.number(), W.number());
+                flow.add_dependency(V.number(), W.number());
 
-                    // can't walk past a non-nullable non-terminal
-                    if(!(nullable[W.number()])) {
-                        break;
-                    }
+                // can't walk past a non-nullable non-terminal
+                if(!(nullable[W.number()])) {
+                    break;
                 }
             }
         }
+
+        flow.solve();
+
+        // allocate and fill in the sets
+        generator_type variables(cfg.search(~V));
+        for(; variables.match_next(); ) {
+            first[V.number()] = new std::vector<bool>(num_vars, false);
+            flow.get(V.number(), *(first[V.number()]));
+        }
     }
 
 }}
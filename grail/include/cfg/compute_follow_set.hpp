@@ -14,9 +14,13 @@
 
 #include "fltl/include/CFG.hpp"
 
+#include "fltl/include/helper/BitMatrix.hpp"
+
 namespace grail { namespace cfg {
 
-    /// compute the follow sets for a CFG.
+    /// compute the follow sets for a CFG. the follow sets only depend on
+    /// the first sets, so one pass over the occurrences of each variable,
+    /// unioning packed copies of the first sets, is enough.
     template <typename AlphaT>
     void compute_follow_set(
         const fltl::CFG<AlphaT> &cfg,
@@ -26,53 +30,101 @@ namespace grail { namespace cfg {
     ) throw() {
         FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
 
-        follow.assign(cfg.num_variables_capacity() + 2, 0);
+        const unsigned num_vars(cfg.num_variables_capacity() + 2U);
+        const unsigned num_terms(cfg.num_terminals() + 2U);
+
+        follow.assign(num_vars, 0);
+
+        // pack the first sets
+        fltl::helper::BitMatrix first_sets(num_vars, num_terms);
+        for(unsigned v(0); v < num_vars && v < first.size(); ++v) {
+            if(0 == first[v]) {
+                continue;
+            }
+
+            const std::vector<bool> &set(*(first[v]));
+            assert(set.size() == num_terms);
+
+            for(unsigned t(0); t < num_terms; ++t) {
+                if(set[t]) {
+                    first_sets.set(v, t);
+                }
+            }
+        }
+
+        fltl::helper::BitMatrix follow_sets(num_vars, num_terms);
 
         variable_type V;
         variable_type A;
+        production_type prod;
         symbol_string_type s;
 
-        generator_type variables(cfg.search(~V));
-        generator_type syms_following_V(cfg.search((~A) --->* cfg.__ + V + ~s));
+        generator_type productions(cfg.search(~prod));
 
-        // initialize each follow bitset as the empty set of the appropriate
-        // size.
-        for(; variables.match_next(); ) {
-            follow[V.number()] = new std::vector<bool>(cfg.num_terminals() + 2U, false);
-        }
+        // the last production in which each variable was seen
+        std::vector<unsigned> seen_in(num_vars, 0U);
+        unsigned num_prods(0);
+
+        for(; productions.match_next(); ) {
+            s = prod.symbols();
+            A = prod.variable();
+
+            const unsigned len(s.length());
+            ++num_prods;
 
-        for(bool updated(true); updated; ) {
-            updated = false;
+            // look at what follows the first occurrence of each variable
+            for(unsigned j(0); j < len; ++j) {
+                if(s.at(j).is_terminal()) {
+                    continue;
+                }
 
-            for(variables.rewind(); variables.match_next(); ) {
+                V = s.at(j);
 
-                for(syms_following_V.rewind(); syms_following_V.match_next(); ) {
-                    for(unsigned i(0); i < s.length(); ++i) {
-                        if(s.at(i).is_terminal()) {
-                            terminal_type u(s.at(i));
-                            (*(follow[V.number()]))[u.number()] = true;
-                            goto next_production;
-                        }
+                if(num_prods == seen_in[V.number()]) {
+                    continue;
+                }
 
-                        variable_type U(s.at(i));
+                seen_in[V.number()] = num_prods;
 
-                        if(U == V) {
-                            continue;
-                        }
+                for(unsigned i(j + 1U); i < len; ++i) {
+                    if(s.at(i).is_terminal()) {
+                        terminal_type u(s.at(i));
+                        follow_sets.set(V.number(), u.number());
+                        goto next_occurrence;
+                    }
 
-                        updated = detail::union_into(follow[V.number()], first[U.number()]) || updated;
+                    variable_type U(s.at(i));
 
-                        if(!nullable[U.number()]) {
-                            goto next_production;
-                        }
+                    if(U == V) {
+                        continue;
                     }
 
-                    // reached the end of the production
-                    updated = detail::union_into(follow[V.number()], first[A.number()]) || updated;
+                    follow_sets.union_rows(V.number(), first_sets, U.number());
 
-                next_production:
-                    continue;
+                    if(!nullable[U.number()]) {
+                        goto next_occurrence;
+                    }
                 }
+
+                // reached the end of the production
+                follow_sets.union_rows(V.number(), first_sets, A.number());
+
+            next_occurrence:
+                continue;
+            }
+        }
+
+        // initialize each follow bitset as the empty set of the appropriate
+        // size, then fill it in.
+        generator_type variables(cfg.search(~V));
+        for(; variables.match_next(); ) {
+            std::vector<bool> *set(new std::vector<bool>(num_terms, false));
+            follow[V.number()] = set;
+
+            for(unsigned t(follow_sets.next(V.number(), 0U));
+                t < num_terms;
+                t = follow_sets.next(V.number(), t + 1U)) {
+                (*set)[t] = true;
             }
         }
     }
@@ -35,7 +35,11 @@
 
 namespace grail { namespace cfg {
 
-    /// compute all nullable variables
+    /// compute all nullable variables. each production that contains no
+    /// terminals keeps a count of the variables on its RHS that aren't yet
+    /// known to be nullable; when a variable is found to be nullable, only
+    /// the productions that it occurs in are updated, and a production
+    /// whose count drops to zero makes its variable nullable.
     template <typename AlphaT>
     void compute_null_set(
         const fltl::CFG<AlphaT> &cfg,
@@ -44,53 +48,96 @@ namespace grail { namespace cfg {
 
         FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
 
+        const unsigned num_vars(cfg.num_variables_capacity() + 2);
+
+        nullable.assign(num_vars, false);
+
+        // the variable of each production, and the number of symbols on
+        // its RHS that aren't known to be nullable
+        std::vector<unsigned> head;
+        std::vector<unsigned> remaining;
+
+        // (variable, production) pairs for every occurrence of a variable
+        // in a production with no terminals
+        std::vector<unsigned> occurrence_var;
+        std::vector<unsigned> occurrence_prod;
+
+        std::vector<unsigned> work;
+
+        production_type prod;
+        symbol_string_type str;
         variable_type V;
-        variable_type Q;
+        generator_type productions(cfg.search(~prod));
+
+        for(; productions.match_next(); ) {
+            str = prod.symbols();
+
+            const unsigned len(str.length());
+            unsigned i(0);
+            for(; i < len && !str.at(i).is_terminal(); ++i) { }
+
+            // a terminal can never derive epsilon
+            if(i < len) {
+                continue;
+            }
+
+            V = prod.variable();
+
+            // base case: directly nullable productions
+            if(0 == len) {
+                if(!nullable[V.number()]) {
+                    nullable[V.number()] = true;
+                    work.push_back(V.number());
+                }
+                continue;
+            }
 
-        nullable.assign(cfg.num_variables_capacity() + 2, false);
+            const unsigned p(static_cast<unsigned>(head.size()));
+            head.push_back(V.number());
+            remaining.push_back(len);
 
-        // base case: directly nullable productions
-        generator_type null_prods(cfg.search((~V) --->* cfg.epsilon()));
-        for(; null_prods.match_next(); ) {
-            nullable[V.number()] = true;
+            for(i = 0; i < len; ++i) {
+                V = str.at(i);
+                occurrence_var.push_back(V.number());
+                occurrence_prod.push_back(p);
+            }
         }
 
-        if(nullable.empty()) {
-            return;
+        // group the occurrences by variable
+        std::vector<unsigned> first_occurrence(num_vars + 1U, 0U);
+        std::vector<unsigned> occurs_in(occurrence_var.size(), 0U);
+
+        for(size_t o(0); o < occurrence_var.size(); ++o) {
+            ++(first_occurrence[occurrence_var[o] + 1U]);
         }
 
-        bool found_nullable(true);
-        symbol_string_type str;
-        variable_type S;
-        generator_type productions(cfg.search((~V) --->* ~Q + ~str));
-        unsigned i(0);
-
-        // inductive step, build up the set of nullable variables
-        // incrementally
-        for(; found_nullable; productions.rewind()) {
-            found_nullable = false;
-            for(; productions.match_next(); ) {
-
-                // either this isn't a nullable production, or we know
-                // that this variable is nullable
-                if(nullable[V.number()] || !nullable[Q.number()]) {
-                    continue;
-                }
+        for(unsigned v(0); v < num_vars; ++v) {
+            first_occurrence[v + 1U] += first_occurrence[v];
+        }
+
+        std::vector<unsigned> next_slot(first_occurrence);
+        for(size_t o(0); o < occurrence_var.size(); ++o) {
+            occurs_in[next_slot[occurrence_var[o]]++] = occurrence_prod[o];
+        }
 
-                for(i = 0; i < str.length(); ++i) {
-                    if(str.at(i).is_terminal()) {
-                        break;
-                    }
+        // inductive step, propagate nullability to the productions that
+        // each newly nullable variable occurs in
+        for(; !work.empty(); ) {
+            const unsigned v(work.back());
+            work.pop_back();
 
-                    S = str.at(i);
-                    if(!nullable[S.number()]) {
-                        break;
-                    }
+            for(unsigned o(first_occurrence[v]);
+                o < first_occurrence[v + 1U];
+                ++o) {
+
+                const unsigned p(occurs_in[o]);
+                if(0 != --(remaining[p])) {
+                    continue;
                 }
 
-                if(str.length() == i) {
-                    nullable[V.number()] = true;
-                    found_nullable = true;
+                if(!nullable[head[p]]) {
+                    nullable[head[p]] = true;
+                    work.push_back(head[p]);
                 }
             }
         }
@@ -31,6 +31,8 @@
 
 #include <set>
 #include <vector>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 
 #include "fltl/include/CFG.hpp"
@@ -38,7 +40,9 @@
 #include "fltl/include/helper/Array.hpp"
 
 #include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/fread_cfg.hpp"
+#include "grail/include/io/fprint_parse_tree.hpp"
 #include "grail/include/io/verbose.hpp"
 #include "grail/include/io/UTF8FileTokBuffer.hpp"
 
@@ -46,7 +50,9 @@
 #include "grail/include/cfg/compute_first_set.hpp"
 #include "grail/include/cfg/ParseTree.hpp"
 
+#include "grail/include/algorithm/CFG_PARSE_CYK.hpp"
 #include "grail/include/algorithm/CFG_PARSE_EARLEY.hpp"
+#include "grail/include/algorithm/CFG_PARSE_GLR.hpp"
 
 namespace grail { namespace cli {
 
@@ -56,13 +62,20 @@ namespace grail { namespace cli {
 
         typedef fltl::CFG<AlphaT> CFG;
         typedef typename CFG::terminal_type terminal_type;
+        typedef cfg::ParseTree<AlphaT> parse_tree_type;
 
         static const char * const TOOL_NAME;
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
 
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             opt.declare("predict", io::opt::OPTIONAL, io::opt::NO_VAL);
             opt.declare("delim", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("tree", io::opt::OPTIONAL, io::opt::NO_VAL);
+            opt.declare("forest", io::opt::OPTIONAL, io::opt::NO_VAL);
+            opt.declare("max-trees", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("engine", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
 
             io::option_type in(opt.declare(
                 "stdin",
@@ -87,17 +100,37 @@ namespace grail { namespace cli {
                 "  %s:\n"
                 "    Parses a token stream according to a context-free grammar (CFG).\n\n"
                 "  basic use options for %s:\n"
+                "    --engine=<name>                parse using the engine <name>, which is\n"
+                "                                   one of 'earley' (default), 'glr', or\n"
+                "                                   'cyk'. The GLR engine runs the LALR(1)\n"
+                "                                   automaton of the grammar, and is much\n"
+                "                                   faster on grammars that are nearly\n"
+                "                                   LALR(1). The CYK engine only recognizes\n"
+                "                                   short inputs, and so can't be used with\n"
+                "                                   --tree, --forest, or --max-trees.\n"
                 "    --predict                      compute the FIRST sets of all\n"
-                "                                   variables. This computation can\n"
-                "                                   take a long time for larger\n"
-                "                                   grammars, but can also speed up\n"
-                "                                   parsing.\n"
+                "                                   variables, which can speed up\n"
+                "                                   parsing with the Earley engine.\n"
                 "    --stdin                        Take the input tokens from standard input.\n"
                 "                                   Each token should be separated by a new\n"
                 "                                   line. Typing a new line followed by Ctrl-D\n"
                 "                                   or Ctrl-Z will close stdin.\n"
                 "    --delim                        Change the delimiter of tokens from newlines\n"
                 "                                   to any character present in delim.\n"
+                "    --tree                         Output one parse tree of the tokens.\n"
+                "    --forest                       Output every parse tree of the tokens.\n"
+                "                                   Derivations that loop through cycles\n"
+                "                                   of unit productions are not output.\n"
+                "                                   If there are too many trees to count\n"
+                "                                   then nothing is output; use --max-trees\n"
+                "                                   instead.\n"
+                "    --max-trees=<n>                Output at most <n> parse trees of the\n"
+                "                                   tokens.\n"
+                "    --format=<fmt>                 Output parse trees in the format <fmt>,\n"
+                "                                   which is one of 'lisp' (default),\n"
+                "                                   'tree', or 'dot'.\n"
+                "    --in-format=<fmt>              read <file0> in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file0>                        read in a CFG from <file>.\n"
                 "    <file1>                        read in a newline-separated list of tokens\n"
                 "                                   from <file1> if --stdin is not used.\n\n",
@@ -144,8 +177,34 @@ namespace grail { namespace cli {
             return ret;
         }
 
+        /// print out and free the extracted parse trees
+        static void print_trees(
+            CFG &cfg,
+            std::vector<parse_tree_type *> &trees,
+            const char *format
+        ) throw() {
+            for(unsigned i(0); i < trees.size(); ++i) {
+                if(0 == strcmp("tree", format)) {
+                    io::fprint(stdout, cfg, trees[i], io::tree_language());
+                } else if(0 == strcmp("dot", format)) {
+                    io::fprint(stdout, cfg, trees[i], io::dot_language());
+                } else {
+                    io::fprint(stdout, cfg, trees[i], io::lisp_language());
+                }
+
+                delete (trees[i]);
+                trees[i] = 0;
+            }
+        }
+
         static int main(io::CommandLineOptions &options) throw() {
 
+            io::format::type in_format;
+
+            if(!io::get_format(options, "in-format", in_format)) {
+                return 1;
+            }
+
             // run the tool
             io::option_type file[2];
             const char *file_name[2] = {0};
@@ -191,23 +250,47 @@ namespace grail { namespace cli {
             CFG cfg;
             int ret(0);
 
-            if(io::fread(fp[0], cfg, file_name[0])) {
+            if(io::fread(fp[0], cfg, file_name[0], in_format)) {
 
                 std::vector<bool> is_nullable;
                 std::vector<std::vector<bool> *> first_terminals;
 
-                // fill the first and nullable sets
-                io::verbose("Computing NULL set of variables...\n");
-                cfg::compute_null_set(cfg, is_nullable);
+                // figure out which parser to use
+                bool use_glr(false);
+                bool use_cyk(false);
 
-                bool use_first_sets(false);
-                if(options["predict"].is_valid()) {
-                    io::verbose("Computing FIRST set of variables...\n");
-                    use_first_sets = true;
-                    cfg::compute_first_terminals(cfg, is_nullable, first_terminals);
+                io::option_type engine_opt(options["engine"]);
+                if(engine_opt.is_valid()) {
+                    use_glr = (0 == strcmp("glr", engine_opt.value()));
+                    use_cyk = (0 == strcmp("cyk", engine_opt.value()));
+                    if(!use_glr && !use_cyk
+                    && 0 != strcmp("earley", engine_opt.value())) {
+                        options.error(
+                            "Unknown parsing engine '%s'. The supported "
+                            "engines are 'earley', 'glr', and 'cyk'.",
+                            engine_opt.value()
+                        );
+                        options.note("Engine specified here:", engine_opt);
+                    }
                 }
 
-                io::verbose("Parsing...\n");
+                bool use_first_sets(false);
+
+                // fill the first and nullable sets; the GLR parser only
+                // needs the NULL set to build its automaton, which it does
+                // itself
+                if(!use_glr && !use_cyk) {
+                    io::verbose("Computing NULL set of variables...\n");
+                    cfg::compute_null_set(cfg, is_nullable);
+
+                    if(options["predict"].is_valid()) {
+                        io::verbose("Computing FIRST set of variables...\n");
+                        use_first_sets = true;
+                        cfg::compute_first_terminals(cfg, is_nullable, first_terminals);
+                    }
+
+                    io::verbose("Parsing...\n");
+                }
 
                 const char *delim_chars("\r\n");
 
@@ -216,22 +299,110 @@ namespace grail { namespace cli {
                     delim_chars = interpret_delim(options, delim);
                 }
 
+                // figure out if and how we should output parse trees
+                const bool all_trees(options["forest"].is_valid());
+                unsigned long max_trees(all_trees ? 0UL : 1UL);
+
+                io::option_type max_trees_opt(options["max-trees"]);
+                if(max_trees_opt.is_valid()) {
+                    const char *max_trees_str(max_trees_opt.value());
+                    char *max_trees_end(0);
+                    max_trees = strtoul(max_trees_str, &max_trees_end, 10);
+
+                    if(0UL == max_trees
+                    || '\0' != *max_trees_end
+                    || !isdigit(static_cast<unsigned char>(*max_trees_str))) {
+                        options.error(
+                            "The maximum number of parse trees must be a "
+                            "positive integer."
+                        );
+                        options.note("Maximum specified here:", max_trees_opt);
+                    }
+                }
+
+                const bool want_trees(
+                    all_trees
+                    || max_trees_opt.is_valid()
+                    || options["tree"].is_valid()
+                );
+
+                if(want_trees && use_cyk) {
+                    options.error(
+                        "The CYK engine parses over the Chomsky Normal Form "
+                        "of the grammar, and so can't output parse trees of "
+                        "the grammar."
+                    );
+                    options.note("Engine specified here:", engine_opt);
+                }
+                const char *format("lisp");
+
+                io::option_type format_opt(options["format"]);
+                if(format_opt.is_valid()) {
+                    format = format_opt.value();
+                    if(0 != strcmp("lisp", format)
+                    && 0 != strcmp("tree", format)
+                    && 0 != strcmp("dot", format)) {
+                        options.error(
+                            "Unknown parse tree format '%s'. The supported "
+                            "formats are 'lisp', 'tree', and 'dot'.",
+                            format
+                        );
+                        options.note("Format specified here:", format_opt);
+                    }
+                }
+
                 if(!options.has_error()) {
 
                     io::UTF8FileTokBuffer<1024U> reader(fp[1], delim_chars);
                     reader.reset();
 
-                    if(algorithm::CFG_PARSE_EARLEY<AlphaT, 1024U>::run(
-                        cfg,
-                        is_nullable,
-                        use_first_sets,
-                        first_terminals,
-                        reader
-                    )) {
-                        printf("Yes.\n");
+                    std::vector<parse_tree_type *> trees;
+
+                    bool accepted(false);
+                    bool too_many_trees(false);
+
+                    if(use_cyk) {
+                        accepted = algorithm::CFG_PARSE_CYK<AlphaT, 1024U>::run(
+                            cfg,
+                            reader
+                        );
+                    } else if(use_glr) {
+                        accepted = algorithm::CFG_PARSE_GLR<AlphaT, 1024U>::run(
+                            cfg,
+                            reader,
+                            want_trees ? &trees : 0,
+                            max_trees,
+                            &too_many_trees
+                        );
                     } else {
+                        accepted = algorithm::CFG_PARSE_EARLEY<AlphaT, 1024U>::run(
+                            cfg,
+                            is_nullable,
+                            use_first_sets,
+                            first_terminals,
+                            reader,
+                            want_trees ? &trees : 0,
+                            max_trees,
+                            &too_many_trees
+                        );
+                    }
+
+                    if(!accepted) {
                         printf("No.\n");
+                    } else if(too_many_trees) {
+                        printf("Yes.\n");
+                        options.error(
+                            "The tokens have too many parse trees to output "
+                            "all of them. Use --max-trees=<n> to output at "
+                            "most <n> of them."
+                        );
+                        ret = 1;
+                    } else {
+                        printf("Yes.\n");
+                        print_trees(cfg, trees, format);
                     }
+                } else {
+                    ret = 1;
                 }
 
                 // clean up the custom delimiter string
@@ -39,6 +39,7 @@
 
 #include "grail/include/io/fread_cfg.hpp"
 #include "grail/include/io/fprint_nfa.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/verbose.hpp"
 
 #include "grail/include/cli/NFA_TO_DOT.hpp"
@@ -55,12 +56,19 @@ namespace grail { namespace cli {
         static const char * const TOOL_NAME;
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("out-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             opt.declare("partition", io::opt::OPTIONAL, io::opt::NO_VAL);
             opt.declare("dot", io::opt::OPTIONAL, io::opt::NO_VAL);
             opt.declare("label-states", io::opt::OPTIONAL, io::opt::NO_VAL);
             if(!in_help) {
-                opt.declare_min_num_positional(1);
-                opt.declare_max_num_positional(1);
+                if(in.is_valid()) {
+                    opt.declare_max_num_positional(0);
+                } else {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                }
             }
         }
 
@@ -71,6 +79,13 @@ namespace grail { namespace cli {
                 "    Computes the language of a top-down parsing stack for the inputted Context-\n"
                 "    free Grammar (CFG).\n\n"
                 "  basic use options for %s:\n"
+                "    --stdin                        Read a CFG from stdin. Typing a new\n"
+                "                                   line followed by Ctrl-D or Ctrl-Z will\n"
+                "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    --out-format=<fmt>             write the output in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file>                         read in a CFG from <file>.\n"
                 "    --partition                    parition the set of states in terms of (L,R)\n"
                 "                                   pairs where L --> * R * in the grammar, \n"
@@ -270,14 +285,32 @@ namespace grail { namespace cli {
 
         static int main(io::CommandLineOptions &options) throw() {
 
+            io::format::type in_format;
+            io::format::type out_format;
+
+            if(!io::get_format(options, "in-format", in_format)
+            || !io::get_format(options, "out-format", out_format)) {
+                return 1;
+            }
+
             // run the tool
-            io::option_type file(options[0U]);
+            io::option_type file;
             io::option_type partition(options["partition"]);
             io::option_type dot(options["dot"]);
             io::option_type label_states(options["label-states"]);
 
-            const char *file_name(file.value());
-            FILE *fp(fopen(file_name, "r"));
+            const char *file_name(0);
+            FILE *fp(0);
+
+            if(options["stdin"].is_valid()) {
+                file = options["stdin"];
+                fp = stdin;
+                file_name = "<stdin>";
+            } else {
+                file = options[0U];
+                file_name = file.value();
+                fp = fopen(file_name, "r");
+            }
 
             if(0 == fp) {
                 options.error(
@@ -293,7 +326,7 @@ namespace grail { namespace cli {
             nfa_nfa_type nfa;
 
             // can't bring in the cfg :(
-            if(!io::fread(fp, cfg, file_name)) {
+            if(!io::fread(fp, cfg, file_name, in_format)) {
                 options.error(
                     "Unable to read file containing context-free "
                     "grammar."
@@ -311,7 +344,7 @@ namespace grail { namespace cli {
             if(dot.is_valid()) {
                 NFA_TO_DOT<AlphaT>::print(stdout, nfa);
             } else {
-                io::fprint(stdout, nfa);
+                io::fwrite(stdout, nfa, out_format);
             }
 
             return 0;
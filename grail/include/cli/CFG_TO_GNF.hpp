@@ -34,6 +34,7 @@
 #include "grail/include/algorithm/CFG_TO_GNF.hpp"
 
 #include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/fread_cfg.hpp"
 #include "grail/include/io/fprint_cfg.hpp"
 
@@ -47,6 +48,8 @@ namespace grail { namespace cli {
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
             io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("out-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             if(!in_help) {
                 if(in.is_valid()) {
                     opt.declare_max_num_positional(0);
@@ -68,6 +71,10 @@ namespace grail { namespace cli {
                 "    --stdin                        Read a CFG from stdin. Typing a new\n"
                 "                                   line followed by Ctrl-D or Ctrl-Z will\n"
                 "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    --out-format=<fmt>             write the output in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file>                         read in a CFG from <file>.\n\n",
                 TOOL_NAME, TOOL_NAME
             );
@@ -77,6 +84,14 @@ namespace grail { namespace cli {
 
             using fltl::CFG;
 
+            io::format::type in_format;
+            io::format::type out_format;
+
+            if(!io::get_format(options, "in-format", in_format)
+            || !io::get_format(options, "out-format", out_format)) {
+                return 1;
+            }
+
             // run the tool
             io::option_type file;
             const char *file_name(0);
@@ -107,9 +122,9 @@ namespace grail { namespace cli {
             CFG<AlphaT> cfg;
             int ret(0);
 
-            if(io::fread(fp, cfg, file_name)) {
+            if(io::fread(fp, cfg, file_name, in_format)) {
                 algorithm::CFG_TO_GNF<AlphaT>::run(cfg);
-                io::fprint(stdout, cfg);
+                io::fwrite(stdout, cfg, out_format);
             } else {
                 ret = 1;
             }
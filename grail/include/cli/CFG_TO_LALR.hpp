@@ -0,0 +1,520 @@
+/*
+ * CFG_TO_LALR.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef Grail_Plus_CFG_TO_LALR_HPP_
+#define Grail_Plus_CFG_TO_LALR_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/algorithm/CFG_TO_LALR.hpp"
+
+#include "grail/include/helper/PackedTable.hpp"
+
+#include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
+#include "grail/include/io/fread_cfg.hpp"
+#include "grail/include/io/error.hpp"
+
+namespace grail { namespace cli {
+
+    template <typename AlphaT>
+    class CFG_TO_LALR {
+    public:
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        typedef algorithm::CFG_TO_LALR<AlphaT> lalr_type;
+        typedef typename lalr_type::table_type table_type;
+        typedef typename lalr_type::action_type action_type;
+        typedef typename lalr_type::conflict_type conflict_type;
+        typedef typename lalr_type::item_table_type item_table_type;
+        typedef typename item_table_type::item_type table_item_type;
+
+        typedef helper::packed_row_type row_type;
+
+        static const char * const TOOL_NAME;
+
+        static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            if(!in_help) {
+                if(in.is_valid()) {
+                    opt.declare_max_num_positional(0);
+                } else {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                }
+            }
+        }
+
+        static void help(void) throw() {
+            //  "  | |                              |                                             |"
+            printf(
+                "  %s:\n"
+                "    Computes the LALR(1) parser tables for a Context-free Grammar (CFG) and\n"
+                "    outputs a C++ program capable of parsing the language generated by the\n"
+                "    grammar, or potentially a subset of the language because of shift/reduce\n"
+                "    and reduce/reduce conflicts. Shift/reduce conflicts are resolved in favour\n"
+                "    of shifting.\n\n"
+                "  basic use options for %s:\n"
+                "    --stdin                        Read a CFG from stdin. Typing a new\n"
+                "                                   line followed by Ctrl-D or Ctrl-Z will\n"
+                "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    <file>                         read in a CFG from <file>.\n\n",
+                TOOL_NAME, TOOL_NAME
+            );
+        }
+
+        static const char *terminal_rep(
+            cfg_type &cfg,
+            const std::vector<terminal_type> &terminals,
+            unsigned t
+        ) throw() {
+            if(lalr_type::END_OF_INPUT == t) {
+                return "<end of input>";
+            }
+
+            terminal_type a(terminals[t]);
+            if(cfg.is_variable_terminal(a)) {
+                return cfg.get_name(a);
+            } else {
+                return cfg.get_alpha(a);
+            }
+        }
+
+        /// print out an item, e.g. A -> b . C d
+        static void print_item(
+            FILE *fp,
+            cfg_type &cfg,
+            table_type &table,
+            const std::vector<terminal_type> &terminals,
+            unsigned it
+        ) throw() {
+            const table_item_type &item(table.items.item(it));
+            production_type &prod(table.items.production(item.production));
+            symbol_string_type w(prod.symbols());
+
+            fprintf(fp, "%s ->", cfg.get_name(prod.variable()));
+
+            for(unsigned i(0); i <= w.length(); ++i) {
+                if(i == item.dot) {
+                    fprintf(fp, " .");
+                }
+
+                if(i == w.length()) {
+                    break;
+
+                } else if(w.at(i).is_variable()) {
+                    variable_type V(w.at(i));
+                    fprintf(fp, " %s", cfg.get_name(V));
+
+                } else {
+                    terminal_type a(w.at(i));
+                    fprintf(fp, " %s", terminal_rep(cfg, terminals, a.number()));
+                }
+            }
+        }
+
+        static void print_action(
+            cfg_type &cfg,
+            table_type &table,
+            const std::vector<terminal_type> &terminals,
+            unsigned t,
+            const action_type &action
+        ) throw() {
+            switch(action.kind) {
+            case lalr_type::ACTION_SHIFT:
+                fprintf(stderr,
+                    "shift '%s' and go to state %u.\n",
+                    terminal_rep(cfg, terminals, t),
+                    action.target
+                );
+                break;
+            case lalr_type::ACTION_REDUCE:
+                fprintf(stderr, "reduce ");
+                io::fprint(stderr, cfg, table.items.production(action.target));
+                break;
+            case lalr_type::ACTION_ACCEPT:
+                fprintf(stderr, "accept the input.\n");
+                break;
+            default:
+                fprintf(stderr, "error.\n");
+                break;
+            }
+        }
+
+        // try to make a meaningful report on how the issue came about.
+        static void report_issue(
+            cfg_type &cfg,
+            table_type &table,
+            const std::vector<terminal_type> &terminals,
+            const conflict_type &conflict,
+            const action_type &action,
+            const std::vector<unsigned> &closed
+        ) throw() {
+            const char *term(terminal_rep(cfg, terminals, conflict.terminal));
+
+            if(lalr_type::ACTION_ACCEPT == action.kind) {
+                fprintf(stderr,
+                    "The input can end after the start variable '%s'.\n",
+                    cfg.get_name(variable_type(table.items.production(
+                        table.accept_production
+                    ).symbol_at(0)))
+                );
+                return;
+            }
+
+            // the only item that can cause a reduction is the completed
+            // item of the production being reduced
+            if(lalr_type::ACTION_REDUCE == action.kind) {
+                fprintf(stderr, "'%s' is in the LALR(1) lookahead of the item '", term);
+                print_item(
+                    stderr, cfg, table, terminals,
+                    table.items.first_item(action.target)
+                  + table.items.production(action.target).length()
+                );
+                fprintf(stderr, "'.\n");
+                return;
+            }
+
+            for(unsigned i(0); i < closed.size(); ++i) {
+                const table_item_type &item(table.items.item(closed[i]));
+
+                if(item_table_type::ITEM_SCAN == item.kind
+                && conflict.terminal == item.number) {
+                    fprintf(stderr, "'%s' can be shifted from the item '", term);
+                    print_item(stderr, cfg, table, terminals, closed[i]);
+                    fprintf(stderr, "'.\n");
+                    return;
+                }
+            }
+
+            fprintf(stderr, "\n");
+        }
+
+        static int encode(const action_type &action) throw() {
+            switch(action.kind) {
+            case lalr_type::ACTION_SHIFT:
+                return static_cast<int>(action.target) + 1;
+            case lalr_type::ACTION_REDUCE:
+                return -(static_cast<int>(action.target) + 1);
+            case lalr_type::ACTION_ACCEPT:
+                return 0x7fffffff;
+            default:
+                return 0;
+            }
+        }
+
+        static int main(io::CommandLineOptions &options) throw() {
+
+            using fltl::CFG;
+
+            io::format::type in_format;
+
+            if(!io::get_format(options, "in-format", in_format)) {
+                return 1;
+            }
+
+            FILE *fp(0);
+            FILE *outfile(stdout);
+
+            // run the tool
+            io::option_type file;
+            const char *file_name(0);
+
+            if(options["stdin"].is_valid()) {
+                file = options["stdin"];
+                fp = stdin;
+                file_name = "<stdin>";
+            } else {
+                file = options[0U];
+                file_name = file.value();
+                fp = fopen(file_name, "r");
+            }
+
+            if(0 == fp) {
+
+                options.error(
+                    "Unable to open file containing context-free "
+                    "grammar for reading."
+                );
+                options.note("File specified here:", file);
+
+                return 1;
+            }
+
+            cfg_type cfg;
+
+            if(!io::fread(fp, cfg, file_name, in_format)) {
+                fclose(fp);
+                return 1;
+            }
+
+            fclose(fp);
+
+            if(0U == cfg.num_productions()) {
+                io::error("The grammar has no productions.");
+                return 1;
+            }
+
+            table_type table;
+            lalr_type::run(cfg, table);
+
+            // index the terminals by number
+            std::vector<terminal_type> terminals(cfg.num_terminals() + 2U);
+            terminal_type a;
+            generator_type as(cfg.search(~a));
+            for(; as.match_next(); ) {
+                terminals[a.number()] = a;
+            }
+
+            // report the conflicts
+            std::vector<unsigned> closed;
+            std::vector<unsigned> seen_items(table.items.num_items(), 0U);
+            std::vector<unsigned> seen_vars(cfg.num_variables_capacity() + 2U, 0U);
+            unsigned stamp(0);
+
+            for(unsigned i(0); i < table.conflicts.size(); ++i) {
+                const conflict_type &conflict(table.conflicts[i]);
+
+                // conflicts are grouped by state, so only compute the
+                // closure of each conflicting state once
+                if(0U == i || table.conflicts[i - 1U].state != conflict.state) {
+                    lalr_type::closure(
+                        table.items,
+                        table.kernels[conflict.state],
+                        closed,
+                        seen_items,
+                        seen_vars,
+                        ++stamp
+                    );
+                }
+
+                io::warning(
+                    "The following two actions conflict in state %u on input "
+                    "'%s'. Action #1 has been chosen.",
+                    conflict.state,
+                    terminal_rep(cfg, terminals, conflict.terminal)
+                );
+
+                fprintf(stderr, "         #0: ");
+                print_action(cfg, table, terminals, conflict.terminal, conflict.rejected);
+                fprintf(stderr, "         #1: ");
+                print_action(cfg, table, terminals, conflict.terminal, conflict.chosen);
+
+                fprintf(stderr, "\n         #0: ");
+                report_issue(
+                    cfg, table, terminals, conflict, conflict.rejected, closed
+                );
+                fprintf(stderr, "         #1: ");
+                report_issue(
+                    cfg, table, terminals, conflict, conflict.chosen, closed
+                );
+                fprintf(stderr, "\n");
+            }
+
+            const unsigned num_states(table.num_states());
+            const unsigned num_prods(table.items.num_productions());
+
+            // make the most common reduction of each state its default
+            // action, and pack the rest of the actions
+            std::vector<int> defaults(num_states, 0);
+            std::vector<row_type> action_rows(num_states);
+            std::vector<row_type> goto_rows(num_states);
+            std::vector<unsigned> counts(num_prods, 0U);
+
+            for(unsigned s(0); s < num_states; ++s) {
+                const std::vector<typename lalr_type::action_entry_type> &
+                    actions(table.actions[s]);
+
+                unsigned best(0);
+                unsigned best_count(0);
+
+                for(unsigned i(0); i < actions.size(); ++i) {
+                    if(lalr_type::ACTION_REDUCE == actions[i].second.kind) {
+                        const unsigned p(actions[i].second.target);
+                        if(++(counts[p]) > best_count) {
+                            best = p;
+                            best_count = counts[p];
+                        }
+                    }
+                }
+
+                for(unsigned i(0); i < actions.size(); ++i) {
+                    const action_type &action(actions[i].second);
+
+                    if(lalr_type::ACTION_REDUCE == action.kind) {
+                        counts[action.target] = 0U;
+
+                        if(best == action.target) {
+                            continue;
+                        }
+                    }
+
+                    action_rows[s].push_back(
+                        std::make_pair(actions[i].first, encode(action))
+                    );
+                }
+
+                if(0U < best_count) {
+                    defaults[s] = encode(action_type(lalr_type::ACTION_REDUCE, best));
+                }
+
+                for(unsigned i(0); i < table.gotos[s].size(); ++i) {
+                    goto_rows[s].push_back(std::make_pair(
+                        table.gotos[s][i].first,
+                        static_cast<int>(table.gotos[s][i].second)
+                    ));
+                }
+            }
+
+            std::vector<int> action_base, action_check, action_next;
+            std::vector<int> goto_base, goto_check, goto_next;
+
+            helper::pack_rows(action_rows, action_base, action_check, action_next);
+            helper::pack_rows(goto_rows, goto_base, goto_check, goto_next);
+
+            // output the file header
+            fprintf(outfile,
+                "// LALR(1) parser, outputted by Grail+ (http://www.grailplus.org)\n"
+                "#include <vector>\n\n"
+                "// terminal id | terminal\n"
+                "// %11u | %s\n",
+                static_cast<unsigned>(lalr_type::END_OF_INPUT),
+                terminal_rep(cfg, terminals, lalr_type::END_OF_INPUT)
+            );
+
+            // print out all of the terminal mappings
+            for(as.rewind(); as.match_next(); ) {
+                fprintf(outfile,
+                    "// %11u | %s\n",
+                    a.number(), terminal_rep(cfg, terminals, a.number())
+                );
+            }
+
+            fprintf(outfile, "\n// production id | production\n");
+
+            std::vector<int> lhs(num_prods, 0);
+            std::vector<int> length(num_prods, 0);
+
+            for(unsigned p(0); p < num_prods; ++p) {
+                production_type &prod(table.items.production(p));
+                lhs[p] = static_cast<int>(prod.variable().number());
+                length[p] = static_cast<int>(prod.length());
+
+                fprintf(outfile, "// %13u | ", p);
+                io::fprint(outfile, cfg, prod);
+            }
+
+            fprintf(outfile,
+                "\n"
+                "enum {\n"
+                "    LALR_ERROR = 0,\n"
+                "    LALR_ACCEPT = 0x7fffffff\n"
+                "};\n\n"
+                "// actions: n > 0 shifts and goes to state n - 1; n < 0 reduces by\n"
+                "// production -n - 1\n"
+            );
+
+            helper::fprint_array(outfile, "unsigned", "lalr_lhs", lhs);
+            helper::fprint_array(outfile, "unsigned", "lalr_length", length);
+            helper::fprint_array(outfile, "int", "lalr_default", defaults);
+            helper::fprint_array(outfile, "int", "lalr_action_base", action_base);
+            helper::fprint_array(outfile, "int", "lalr_action_check", action_check);
+            helper::fprint_array(outfile, "int", "lalr_action_next", action_next);
+            helper::fprint_array(outfile, "int", "lalr_goto_base", goto_base);
+            helper::fprint_array(outfile, "int", "lalr_goto_check", goto_check);
+            helper::fprint_array(outfile, "int", "lalr_goto_next", goto_next);
+
+            fprintf(outfile,
+                "static int lalr_action(unsigned state, unsigned term) throw() {\n"
+                "    const unsigned i((unsigned) lalr_action_base[state] + term);\n"
+                "    if(i < %uU && (int) state == lalr_action_check[i]) {\n"
+                "        return lalr_action_next[i];\n"
+                "    }\n"
+                "    return lalr_default[state];\n"
+                "}\n\n"
+                "static unsigned lalr_goto(unsigned state, unsigned var) throw() {\n"
+                "    const unsigned i((unsigned) lalr_goto_base[state] + var);\n"
+                "    if(i < %uU && (int) state == lalr_goto_check[i]) {\n"
+                "        return (unsigned) lalr_goto_next[i];\n"
+                "    }\n"
+                "    return 0U;\n"
+                "}\n\n",
+                static_cast<unsigned>(action_check.size()),
+                static_cast<unsigned>(goto_check.size())
+            );
+
+            fprintf(outfile,
+                "// parse some input stream. the end of the stream is treated as\n"
+                "// terminal %u.\n"
+                "template <typename token_stream_type, typename token_type>\n"
+                "bool parse(token_stream_type &stream) throw() {\n"
+                "    token_type tok;\n"
+                "    std::vector<unsigned> s;\n"
+                "    unsigned term;\n"
+                "    unsigned prod;\n"
+                "    int action;\n"
+                "    s.push_back(0U);\n"
+                "    term = (stream >> tok) ? (unsigned) tok : %uU;\n"
+                "    for(;;) {\n"
+                "        action = lalr_action(s.back(), term);\n"
+                "        if(LALR_ACCEPT == action) {\n"
+                "            return true;\n"
+                "        } else if(0 < action) {\n"
+                "            s.push_back((unsigned) (action - 1));\n"
+                "            term = (stream >> tok) ? (unsigned) tok : %uU;\n"
+                "        } else if(0 > action) {\n"
+                "            prod = (unsigned) (-action - 1);\n"
+                "            s.resize(s.size() - lalr_length[prod]);\n"
+                "            s.push_back(lalr_goto(s.back(), lalr_lhs[prod]));\n"
+                "        } else {\n"
+                "            return false;\n"
+                "        }\n"
+                "    }\n"
+                "}\n\n",
+                static_cast<unsigned>(lalr_type::END_OF_INPUT),
+                static_cast<unsigned>(lalr_type::END_OF_INPUT),
+                static_cast<unsigned>(lalr_type::END_OF_INPUT)
+            );
+
+            io::verbose(
+                "%u states, %u conflicts, %u packed action entries.\n",
+                num_states,
+                static_cast<unsigned>(table.conflicts.size()),
+                static_cast<unsigned>(action_check.size())
+            );
+
+            return 0;
+        }
+    };
+
+    template <typename AlphaT>
+    const char * const CFG_TO_LALR<AlphaT>::TOOL_NAME("cfg-to-lalr");
+}}
+
+#endif /* Grail_Plus_CFG_TO_LALR_HPP_ */
@@ -32,27 +32,20 @@
 #include <vector>
 #include <utility>
 #include <map>
-#include <inttypes.h>
 #include <stdint.h>
-#include <climits>
 
 #include "fltl/include/CFG.hpp"
 
-#include "grail/include/cfg/compute_null_set.hpp"
-#include "grail/include/cfg/compute_first_set.hpp"
+#include "grail/include/cfg/AnalysisCache.hpp"
 #include "grail/include/cfg/compute_follow_set.hpp"
 
+#include "grail/include/helper/PackedTable.hpp"
+
 #include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/fread_cfg.hpp"
 #include "grail/include/io/error.hpp"
-
-#ifndef PRIu64
-#   if UINT64_MAX > ULONG_MAX
-#       define PRIu64 "llu"
-#   else
-#       define PRIu64 "lu"
-#   endif
-#endif
+#include "grail/include/io/verbose.hpp"
 
 namespace grail { namespace cli {
 
@@ -62,13 +55,22 @@ namespace grail { namespace cli {
 
         FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
 
+        /// maps (variable, terminal) pairs to the predicted production
+        typedef std::map<std::pair<unsigned, unsigned>, production_type>
+                table_type;
+
         static const char * const TOOL_NAME;
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
-            //io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             if(!in_help) {
-                opt.declare_min_num_positional(1);
-                opt.declare_max_num_positional(1);
+                if(in.is_valid()) {
+                    opt.declare_max_num_positional(0);
+                } else {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                }
             }
         }
 
@@ -79,8 +81,14 @@ namespace grail { namespace cli {
                 "    Computes the LL1 parser table for a Context-free Grammar (CFG) and outputs\n"
                 "    a C++ program capable of parsing the language generated by the grammar, or\n"
                 "    potentially a subset of the language because of first/first and first/follow\n"
-                "    conflicts.\n\n"
+                "    conflicts. The parser's stack holds at most LL1_STACK_SIZE symbols,\n"
+                "    which can be defined before including the parser.\n\n"
                 "  basic use options for %s:\n"
+                "    --stdin                        Read a CFG from stdin. Typing a new\n"
+                "                                   line followed by Ctrl-D or Ctrl-Z will\n"
+                "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file>                         read in a CFG from <file>.\n\n",
                 TOOL_NAME, TOOL_NAME
             );
@@ -170,7 +178,7 @@ namespace grail { namespace cli {
 
         static void add_to_table(
             cfg_type &cfg,
-            std::map<std::pair<unsigned, unsigned>, production_type> &table,
+            table_type &table,
             variable_type V, terminal_type a, production_type p,
             const std::vector<bool> &nullable,
             const std::vector<std::vector<bool> *> &first,
@@ -234,13 +242,28 @@ namespace grail { namespace cli {
 
             using fltl::CFG;
 
+            io::format::type in_format;
+
+            if(!io::get_format(options, "in-format", in_format)) {
+                return 1;
+            }
+
             FILE *fp(0);
             FILE *outfile(stdout);
 
             // run the tool
-            io::option_type file(options[0U]);
-            const char *file_name(file.value());
-            fp = fopen(file_name, "r");
+            io::option_type file;
+            const char *file_name(0);
+
+            if(options["stdin"].is_valid()) {
+                file = options["stdin"];
+                fp = stdin;
+                file_name = "<stdin>";
+            } else {
+                file = options[0U];
+                file_name = file.value();
+                fp = fopen(file_name, "r");
+            }
 
             if(0 == fp) {
 
@@ -253,12 +276,14 @@ namespace grail { namespace cli {
                 return 1;
             }
 
-            char sep[] = {',', '\0', '\0'};
-
             int ret(0);
             cfg_type cfg;
 
-            std::map<std::pair<unsigned, unsigned>, production_type> table;
+            // keeps the NULL and FIRST sets of the grammar, computing both
+            // in the same pass
+            grail::cfg::AnalysisCache<AlphaT> analysis(cfg);
+
+            table_type table;
 
             std::vector<bool> nullable;
             std::vector<std::vector<bool> *> first;
@@ -278,17 +303,30 @@ namespace grail { namespace cli {
             generator_type A_related(cfg.search(~prod, A --->* ~w));
             std::vector<bool> empty_set;
 
+            // the emitted tables
+            unsigned num_vars(0);
+            std::map<uint64_t, unsigned> prod_ids;
+            std::vector<production_type> prods;
+            std::vector<int> rhs;
+            std::vector<int> rhs_begin;
+            std::vector<int> defaults;
+            std::vector<int> nullable_vars;
+            std::vector<helper::packed_row_type> rows;
+            std::vector<int> base, check, next;
+
             // can't bring in the cfg :(
-            if(!io::fread(fp, cfg, file_name)) {
+            if(!io::fread(fp, cfg, file_name, in_format)) {
                 ret = 1;
                 goto done;
             }
 
+            num_vars = cfg.num_variables_capacity() + 1U;
+
             // empty set of all terminals
             empty_set.assign(cfg.num_terminals() + 2, false);
 
-            grail::cfg::compute_null_set(cfg, nullable);
-            grail::cfg::compute_first_terminals(cfg, nullable, first);
+            analysis.get_null_set(nullable);
+            analysis.get_first_terminals(first);
             grail::cfg::compute_follow_set(cfg, nullable, first, follow);
 
             for(; As.match_next(); ) {
@@ -327,17 +365,77 @@ namespace grail { namespace cli {
                 }
             }
 
+            // give the productions dense ids, and lay out their right-hand
+            // sides in reverse so that the driver can push them in order.
+            // terminals are encoded as t << 1, and variables as (v << 1) | 1
+            for(; productions.match_next(); ) {
+                prod_ids[prod.number()] = static_cast<unsigned>(prods.size());
+                prods.push_back(prod);
+                rhs_begin.push_back(static_cast<int>(rhs.size()));
+
+                w = prod.symbols();
+                for(unsigned i(w.length()); i-- > 0U; ) {
+                    if(w.at(i).is_variable()) {
+                        A = w.at(i);
+                        rhs.push_back(static_cast<int>((A.number() << 1U) | 1U));
+                    } else {
+                        a = w.at(i);
+                        rhs.push_back(static_cast<int>(a.number() << 1U));
+                    }
+                }
+            }
+            rhs_begin.push_back(static_cast<int>(rhs.size()));
+
+            // if a variable predicts its empty production on some terminals
+            // then make that production the default prediction of the
+            // variable, so that those terminals don't need table entries.
+            // this only delays error detection until the next terminal is
+            // matched.
+            defaults.assign(num_vars, 0);
+            nullable_vars.assign(num_vars, 0);
+            rows.resize(num_vars);
+
+            for(As.rewind(); As.match_next(); ) {
+                nullable_vars[A.number()] = nullable[A.number()] ? 1 : 0;
+            }
+
+            for(typename table_type::iterator it(table.begin());
+                it != table.end();
+                ++it) {
+
+                if(0U == it->second.length()) {
+                    defaults[it->first.first] = static_cast<int>(
+                        prod_ids[it->second.number()] + 1U
+                    );
+                }
+            }
+
+            for(typename table_type::iterator it(table.begin());
+                it != table.end();
+                ++it) {
+
+                const int predict(static_cast<int>(
+                    prod_ids[it->second.number()] + 1U
+                ));
+
+                if(defaults[it->first.first] != predict) {
+                    rows[it->first.first].push_back(
+                        std::make_pair(it->first.second, predict)
+                    );
+                }
+            }
+
+            helper::pack_rows(rows, base, check, next);
+
             // output the file header
             fprintf(outfile,
                 "// LL(1) parser, outputted by Grail+ (http://www.grailplus.org)\n"
-                "#include <vector>\n"
-                "#include <cassert>\n\n"
-                "#define P(f) &p ## f\n"
-                "#define NT(v) s.push_back(stack_symbol_type::non_terminal(v))\n"
-                "#define T(t) s.push_back(stack_symbol_type::terminal(t))\n"
-                "#define A(a) s.push_back(stack_symbol_type::action(a))\n"
-                "\n"
+                "#ifndef LL1_STACK_SIZE\n"
+                "#define LL1_STACK_SIZE 1024\n"
+                "#endif\n\n"
                 "// terminal id | terminal\n"
+                "// %11u | <end of input>\n",
+                0U
             );
 
             // print out all of the terminal mappings
@@ -348,149 +446,102 @@ namespace grail { namespace cli {
                 );
             }
 
+            fprintf(outfile, "\n// production id | production\n");
+
+            for(unsigned p(0); p < prods.size(); ++p) {
+                fprintf(outfile, "// %13u | ", p);
+                io::fprint(outfile, cfg, prods[p]);
+            }
+
             fprintf(outfile,
                 "\n"
-                "typedef bool (action_type)(void);\n"
-                "struct stack_symbol_type {\n"
-                "    union {\n"
-                "        unsigned t;\n"
-                "        unsigned nt;\n"
-                "        action_type *a;\n"
-                "    } u;\n"
-                "    enum stack_symbol_kind {\n"
-                "        TERMINAL,\n"
-                "        ACTION,\n"
-                "        NON_TERMINAL\n"
-                "    };\n"
-                "    stack_symbol_kind k;\n"
-                "    static stack_symbol_type terminal(unsigned t) throw() {\n"
-                "        stack_symbol_type ss;\n"
-                "        ss.k = TERMINAL;\n"
-                "        ss.u.t = t;\n"
-                "        return ss;\n"
-                "    }\n"
-                "    static stack_symbol_type non_terminal(unsigned nt) throw() {\n"
-                "        stack_symbol_type ss;\n"
-                "        ss.k = NON_TERMINAL;\n"
-                "        ss.u.nt = nt;\n"
-                "        return ss;\n"
-                "    }\n"
-                "    static stack_symbol_type action(action_type *a) throw() {\n"
-                "        stack_symbol_type ss;\n"
-                "        ss.k = ACTION;\n"
-                "        ss.u.a = a;\n"
-                "        return ss;\n"
-                "    }\n"
-                "};\n\n"
-                "typedef std::vector<stack_symbol_type> stack_type;\n"
-                "typedef bool (transition_type)(stack_type &);\n"
-                ""
-                "static bool perror(stack_type &) throw() {\n"
-                "    return false;\n"
-                "}\n\n"
+                "// stack symbols: t << 1 is terminal t, (v << 1) | 1 is variable v.\n"
+                "// the right-hand side of production p is ll1_rhs[ll1_rhs_begin[p]]\n"
+                "// up to ll1_rhs[ll1_rhs_begin[p + 1]], in reverse.\n"
             );
 
-            // output all productions
-            for(generator_type prods(cfg.search(~prod));
-                prods.match_next(); ) {
-
-                w = prod.symbols();
-
-                fprintf(outfile, "// ");
-                io::fprint(outfile, cfg, prod);
-                fprintf(outfile,
-                    "static bool p%" PRIu64 "(stack_type &s) throw() {\n",
-                    prod.number()
-                );
-
-                // in case we're adding nothing to the stack
-                if(0U == w.length()) {
-                    fprintf(outfile, "    (void) s;\n");
-                } else {
-                    fprintf(outfile,
-                        "    s.reserve(s.size() + %uU);\n",
-                        w.length()
-                    );
-                }
+            helper::fprint_array(outfile, "unsigned", "ll1_rhs", rhs);
+            helper::fprint_array(outfile, "unsigned", "ll1_rhs_begin", rhs_begin);
 
-                // add stuff to the stack in the reverse order that we're matching
-                // so that the first thing to be matched is at the top of the
-                // stack
-                for(unsigned i(w.length()); i-- > 0U; ) {
-                    if(w.at(i).is_variable()) {
-                        A = w.at(i);
-                        fprintf(outfile,
-                            "    NT(%u); // %s\n",
-                            A.number(),
-                            cfg.get_name(A)
-                        );
-                    } else {
-                        a = w.at(i);
-                        fprintf(outfile,
-                            "    T(%u); // %s\n",
-                            a.number(),
-                            terminal_rep(cfg, a)
-                        );
-                    }
-                }
+            fprintf(outfile,
+                "// predictions: n > 0 predicts production n - 1\n"
+            );
 
-                fprintf(outfile,
-                    "    return true;\n"
-                    "}\n\n"
-                );
-            }
+            helper::fprint_array(outfile, "int", "ll1_default", defaults);
+            helper::fprint_array(outfile, "int", "ll1_base", base);
+            helper::fprint_array(outfile, "int", "ll1_check", check);
+            helper::fprint_array(outfile, "int", "ll1_next", next);
+            helper::fprint_array(outfile, "bool", "ll1_nullable", nullable_vars);
 
             fprintf(outfile,
-                "static transition_type *trans[%u][%u] = {\n",
-                cfg.num_variables_capacity(),
-                cfg.num_terminals() + 1U
+                "static unsigned ll1_predict(unsigned var, unsigned term) throw() {\n"
+                "    const unsigned i((unsigned) ll1_base[var] + term);\n"
+                "    if(i < %uU && (int) var == ll1_check[i]) {\n"
+                "        return (unsigned) ll1_next[i];\n"
+                "    }\n"
+                "    return (unsigned) ll1_default[var];\n"
+                "}\n\n",
+                static_cast<unsigned>(check.size())
             );
 
-            // transition table
-            for(unsigned v(0); v < cfg.num_variables_capacity(); ++v) {
-                fprintf(outfile, "    {");
-                for(unsigned t(1), j(1); t < cfg.num_terminals() + 1U; ++t, j = 0) {
-                    std::pair<unsigned, unsigned> cell(v, t);
-                    if(table.count(cell)) {
-                        fprintf(outfile, "%sP(%5" PRIu64 ")", &(sep[j]), table[cell].number());
-                    } else {
-                        fprintf(outfile, "%sP(error)", &(sep[j]));
-                    }
-                }
-                fprintf(outfile, "},\n");
-            }
-            fprintf(outfile, "};\n\n");
-
             fprintf(outfile,
-                "// parse some input stream\n"
+                "// parse some input stream. the end of the stream is treated as\n"
+                "// terminal 0. parsing fails if the stack needs more than\n"
+                "// LL1_STACK_SIZE symbols.\n"
                 "template <typename token_stream_type, typename token_type>\n"
                 "bool parse(token_stream_type &stream) throw() {\n"
                 "    token_type tok;\n"
-                "    stack_symbol_type sym;\n"
-                "    stack_type s;\n"
+                "    unsigned s[LL1_STACK_SIZE];\n"
+                "    unsigned top(0U);\n"
+                "    unsigned sym;\n"
                 "    unsigned term;\n"
-                "    NT(%u);\n"
-                "    for(; stream.good(); ) {\n"
-                "        assert(!s.empty());\n"
-                "        stream >> tok;\n"
-                "        term = (unsigned) tok;\n"
-                "        sym = s.back();\n"
-                "        s.pop_back();\n"
-                "        if(stack_symbol_type::TERMINAL == sym.k) {\n"
-                "            if(term != sym.u.t) {\n"
+                "    unsigned prod;\n"
+                "    unsigned i;\n"
+                "    unsigned end;\n"
+                "    s[top++] = %uU;\n"
+                "    term = (stream >> tok) ? (unsigned) tok : 0U;\n"
+                "    for(; 0U != term; ) {\n"
+                "        if(0U == top) {\n"
+                "            return false;\n"
+                "        }\n"
+                "        sym = s[--top];\n"
+                "        if(0U == (sym & 1U)) {\n"
+                "            if((sym >> 1) != term) {\n"
                 "                return false;\n"
                 "            }\n"
-                "        } else if(stack_symbol_type::ACTION == sym.k) {\n"
-                "            if(!sym.u.a()) {\n"
+                "            term = (stream >> tok) ? (unsigned) tok : 0U;\n"
+                "        } else {\n"
+                "            prod = ll1_predict(sym >> 1, term);\n"
+                "            if(0U == prod) {\n"
                 "                return false;\n"
                 "            }\n"
-                "        } else {\n"
-                "            trans[sym.u.nt][term](s);\n"
+                "            i = ll1_rhs_begin[prod - 1U];\n"
+                "            end = ll1_rhs_begin[prod];\n"
+                "            if((LL1_STACK_SIZE - top) < (end - i)) {\n"
+                "                return false;\n"
+                "            }\n"
+                "            for(; i < end; ++i) {\n"
+                "                s[top++] = ll1_rhs[i];\n"
+                "            }\n"
+                "        }\n"
+                "    }\n"
+                "    // whatever is left on the stack must derive the empty string\n"
+                "    for(; 0U < top; ) {\n"
+                "        sym = s[--top];\n"
+                "        if(0U == (sym & 1U) || !ll1_nullable[sym >> 1]) {\n"
+                "            return false;\n"
                 "        }\n"
                 "    }\n"
                 "    return true;\n"
                 "}\n\n",
-                cfg.get_start_variable().number()
+                (cfg.get_start_variable().number() << 1U) | 1U
+            );
+
+            io::verbose(
+                "%u productions, %u table entries, %u packed entries.\n",
+                static_cast<unsigned>(prods.size()),
+                static_cast<unsigned>(table.size()),
+                static_cast<unsigned>(check.size())
             );
 
         done:
@@ -0,0 +1,297 @@
+/*
+ * DFA_TO_SCANNER.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef Grail_Plus_DFA_TO_SCANNER_HPP_
+#define Grail_Plus_DFA_TO_SCANNER_HPP_
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "fltl/include/CompiledDFA.hpp"
+#include "fltl/include/NFA.hpp"
+
+#include "grail/include/algorithm/NFA_EXPAND_BYTES.hpp"
+#include "grail/include/algorithm/NFA_TO_DFA.hpp"
+#include "grail/include/algorithm/DFA_MINIMIZE.hpp"
+
+#include "grail/include/helper/CStringMap.hpp"
+#include "grail/include/helper/PackedTable.hpp"
+
+#include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
+#include "grail/include/io/fread_nfa.hpp"
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace cli {
+
+    template <typename AlphaT>
+    class DFA_TO_SCANNER {
+    public:
+
+        FLTL_NFA_USE_TYPES(fltl::NFA<AlphaT>);
+
+        static const char * const TOOL_NAME;
+
+        enum {
+            NUM_BYTES = 256
+        };
+
+        static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            if(!in_help) {
+                if(in.is_valid()) {
+                    opt.declare_max_num_positional(0);
+                } else {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                }
+            }
+        }
+
+        static void help(void) throw() {
+            //  "  | |                              |                                             |"
+            printf(
+                "  %s:\n"
+                "    Outputs a C++ scanner that finds the longest prefix of its input that is\n"
+                "    accepted by a finite automaton. The automaton can be non-deterministic, and\n"
+                "    its symbols can be strings of any length; it is converted into a minimal\n"
+                "    DFA over bytes. Each named accepting state names a token, and the scanner\n"
+                "    reports which token it found. The part of a state's name before its first\n"
+                "    ':' names the token, so '@ID' and '@ID:2' both accept the token 'ID'.\n"
+                "    Bytes that the DFA can't tell apart share a column of the scanner's\n"
+                "    transition table.\n\n"
+                "  basic use options for %s:\n"
+                "    --stdin                        Read an NFA from stdin. Typing a new\n"
+                "                                   line followed by Ctrl-D or Ctrl-Z will\n"
+                "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    <file>                         read in an NFA from <file>.\n\n",
+                TOOL_NAME, TOOL_NAME
+            );
+        }
+
+        static int main(io::CommandLineOptions &options) throw() {
+
+            io::format::type in_format;
+
+            if(!io::get_format(options, "in-format", in_format)) {
+                return 1;
+            }
+
+            // run the tool
+            io::option_type file;
+            const char *file_name(0);
+
+            FILE *fp(0);
+
+            // take input from stdin or from a file?
+            if(options["stdin"].is_valid()) {
+                file = options["stdin"];
+                fp = stdin;
+                file_name = "<stdin>";
+            } else {
+                file = options[0U];
+                file_name = file.value();
+                fp = fopen(file_name, "r");
+            }
+
+            // couldn't open the file
+            if(0 == fp) {
+                options.error(
+                    "Unable to open file containing finite automaton for "
+                    "reading."
+                );
+                options.note("File specified here:", file);
+                return 1;
+            }
+
+            nfa_type nfa;
+
+            if(!io::fread(fp, nfa, file_name, in_format)) {
+                fclose(fp);
+                return 1;
+            }
+
+            fclose(fp);
+
+            nfa_type bytes;
+            nfa_type dfa;
+            nfa_type min;
+
+            io::verbose("Converting %u NFA states to bytes...\n", nfa.num_states());
+            algorithm::NFA_EXPAND_BYTES<AlphaT>::run(nfa, bytes);
+
+            io::verbose("Converting %u NFA states to a DFA...\n", bytes.num_states());
+            algorithm::NFA_TO_DFA<AlphaT>::run(bytes, dfa);
+
+            io::verbose("Minimizing %u DFA states...\n", dfa.num_states());
+            algorithm::DFA_MINIMIZE<AlphaT>::run(dfa, min);
+
+            const unsigned num_states(min.num_states());
+
+            // name the tokens
+            std::vector<unsigned> tokens(num_states, 0U);
+            std::vector<std::pair<const char *, const char *> > token_names;
+            helper::CStringMap<unsigned> token_ids;
+
+            state_type state;
+            generator_type states(min.search(~state));
+            for(; states.match_next(); ) {
+                if(!min.is_accept_state(state)) {
+                    continue;
+                }
+
+                const char *name(min.get_name(state));
+                const char *end(algorithm::NFA_TO_DFA<AlphaT>::token_end(name));
+
+                if(!token_ids.contains(name, end)) {
+                    token_names.push_back(std::make_pair(name, end));
+                    token_ids.set(name, end, static_cast<unsigned>(
+                        token_names.size()
+                    ));
+                }
+
+                tokens[state.number()] = token_ids.get(name, end);
+            }
+
+            // compress the bytes into classes and fill in the transition
+            // table
+            fltl::CompiledDFA<AlphaT> compiled;
+            if(!compiled.compile(min)) {
+                options.error("Unable to compile the minimal DFA.");
+                return 1;
+            }
+
+            const unsigned num_classes(compiled.num_classes());
+            std::vector<int> byte_class(NUM_BYTES, 0);
+            std::vector<int> next(num_states * num_classes, -1);
+
+            for(unsigned b(0); b < NUM_BYTES; ++b) {
+                byte_class[b] = static_cast<int>(
+                    compiled.class_of(static_cast<unsigned char>(b))
+                );
+            }
+
+            for(unsigned s(0); s < num_states; ++s) {
+                for(unsigned c(0); c < num_classes; ++c) {
+                    next[s * num_classes + c] = compiled.next_state(s, c);
+                }
+            }
+
+            std::vector<int> accept(tokens.begin(), tokens.end());
+
+            // output the scanner
+            fprintf(stdout,
+                "// scanner, outputted by Grail+ (http://www.grailplus.org)\n\n"
+                "// token id | token\n"
+            );
+
+            for(unsigned i(0); i < token_names.size(); ++i) {
+                if(token_names[i].first == token_names[i].second) {
+                    fprintf(stdout, "// %8u | <unnamed>\n", i + 1U);
+                } else {
+                    fprintf(stdout,
+                        "// %8u | %.*s\n",
+                        i + 1U,
+                        static_cast<int>(
+                            token_names[i].second - token_names[i].first
+                        ),
+                        token_names[i].first
+                    );
+                }
+            }
+
+            fprintf(stdout,
+                "\n"
+                "enum {\n"
+                "    SCAN_NUM_CLASSES = %u,\n"
+                "    SCAN_START = %u\n"
+                "};\n\n"
+                "// the equivalence class of each byte\n",
+                num_classes,
+                min.get_start_state().number()
+            );
+
+            helper::fprint_array(stdout, "unsigned char", "scan_class", byte_class);
+
+            fprintf(stdout,
+                "// the next state is scan_next[state * SCAN_NUM_CLASSES + class],\n"
+                "// or -1 if there is no next state\n"
+            );
+
+            helper::fprint_array(
+                stdout,
+                num_states < 0x8000U ? "short" : "int",
+                "scan_next",
+                next
+            );
+
+            fprintf(stdout, "// the token accepted by each state, or 0\n");
+            helper::fprint_array(stdout, "unsigned", "scan_accept", accept);
+
+            fprintf(stdout,
+                "// find the longest non-empty prefix of [begin, end) that is a\n"
+                "// token. returns the id of the token and sets token_end to the end\n"
+                "// of the token, or returns 0 if no prefix is a token.\n"
+                "static unsigned scan(\n"
+                "    const char *begin,\n"
+                "    const char *end,\n"
+                "    const char *&token_end\n"
+                ") throw() {\n"
+                "    int state(SCAN_START);\n"
+                "    unsigned token(0U);\n"
+                "    for(const char *curr(begin); curr < end; ) {\n"
+                "        state = scan_next[\n"
+                "            state * SCAN_NUM_CLASSES +\n"
+                "            scan_class[(unsigned char) *curr++]\n"
+                "        ];\n"
+                "        if(0 > state) {\n"
+                "            break;\n"
+                "        } else if(0U != scan_accept[state]) {\n"
+                "            token = scan_accept[state];\n"
+                "            token_end = curr;\n"
+                "        }\n"
+                "    }\n"
+                "    return token;\n"
+                "}\n\n"
+            );
+
+            io::verbose(
+                "%u states, %u byte classes, %u tokens.\n",
+                num_states,
+                num_classes,
+                static_cast<unsigned>(token_names.size())
+            );
+
+            return 0;
+        }
+    };
+
+    template <typename AlphaT>
+    const char * const DFA_TO_SCANNER<AlphaT>::TOOL_NAME("dfa-to-scanner");
+}}
+
+#endif /* Grail_Plus_DFA_TO_SCANNER_HPP_ */
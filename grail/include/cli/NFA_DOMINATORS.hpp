@@ -16,6 +16,7 @@
 #include "fltl/include/NFA.hpp"
 
 #include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/fread_nfa.hpp"
 #include "grail/include/io/fprint_nfa.hpp"
 #include "grail/include/io/verbose.hpp"
@@ -33,6 +34,8 @@ namespace grail { namespace cli {
         static const char * const TOOL_NAME;
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("out-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             opt.declare("dot", io::opt::OPTIONAL, io::opt::NO_VAL);
 
             if(!in_help) {
@@ -48,6 +51,10 @@ namespace grail { namespace cli {
                 "    Computes the dominator tree of the NFA, where the nodes of the tree are\n"
                 "    states in the NFA. Currently, this ignores transition conditions altogether.\n\n"
                 "  basic use options for %s:\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    --out-format=<fmt>             write the output in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file>                         read in an NFA from <file>.\n"
                 "    --dot                          output the NFA as a DOT digraph.\n\n",
                 TOOL_NAME, TOOL_NAME
@@ -212,6 +219,14 @@ namespace grail { namespace cli {
 
         static int main(io::CommandLineOptions &options) throw() {
 
+            io::format::type in_format;
+            io::format::type out_format;
+
+            if(!io::get_format(options, "in-format", in_format)
+            || !io::get_format(options, "out-format", out_format)) {
+                return 1;
+            }
+
             // run the tool
             io::option_type file(options[0U]);
             io::option_type dot(options["dot"]);
@@ -228,7 +243,7 @@ namespace grail { namespace cli {
             }
 
             nfa_type nfa;
-            if(!io::fread(fp, nfa, file_name)) {
+            if(!io::fread(fp, nfa, file_name, in_format)) {
                 return 1;
             }
 
@@ -238,7 +253,7 @@ namespace grail { namespace cli {
             if(dot.is_valid()) {
                 NFA_TO_DOT<AlphaT>::print(stdout, nfa);
             } else {
-                io::fprint(stdout, nfa);
+                io::fwrite(stdout, nfa, out_format);
             }
 
             return 0;
@@ -0,0 +1,237 @@
+/*
+ * NFA_MATCH.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef Grail_Plus_NFA_MATCH_HPP_
+#define Grail_Plus_NFA_MATCH_HPP_
+
+#include <cstdio>
+#include <vector>
+
+#include "fltl/include/BitParallelNFA.hpp"
+#include "fltl/include/NFA.hpp"
+
+#include "grail/include/algorithm/NFA_EXPAND_BYTES.hpp"
+
+#include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
+#include "grail/include/io/fread_nfa.hpp"
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace cli {
+
+    template <typename AlphaT>
+    class NFA_MATCH {
+    public:
+
+        FLTL_NFA_USE_TYPES(fltl::NFA<AlphaT>);
+
+        static const char * const TOOL_NAME;
+
+        static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("full", io::opt::OPTIONAL, io::opt::NO_VAL);
+
+            io::option_type in(opt.declare(
+                "stdin",
+                io::opt::OPTIONAL,
+                io::opt::NO_VAL
+            ));
+
+            if(!in_help) {
+                if(in.is_valid()) {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                } else {
+                    opt.declare_min_num_positional(2);
+                    opt.declare_max_num_positional(2);
+                }
+            }
+        }
+
+        static void help(void) throw() {
+            //  "  | |                              |                                             |"
+            printf(
+                "  %s:\n"
+                "    Outputs each line of its input that contains a string accepted by a\n"
+                "    finite automaton, prefixed by the line number and by the byte offset\n"
+                "    at which the first accepted string ends, i.e. the 1-based offset of its\n"
+                "    last byte (0 if it is the empty string). The automaton is simulated\n"
+                "    with one bit per state, and so is never converted into a DFA. Its\n"
+                "    symbols can be strings of any length.\n\n"
+                "  basic use options for %s:\n"
+                "    --full                         only output lines that are accepted by\n"
+                "                                   the automaton in their entirety, prefixed\n"
+                "                                   by their line numbers.\n"
+                "    --stdin                        Take the input lines from standard input.\n"
+                "                                   Typing a new line followed by Ctrl-D or\n"
+                "                                   Ctrl-Z will close stdin.\n"
+                "    --in-format=<fmt>              read <file0> in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    <file0>                        read in an NFA from <file0>.\n"
+                "    <file1>                        read in the lines to match from <file1>\n"
+                "                                   if --stdin is not used.\n\n",
+                TOOL_NAME, TOOL_NAME
+            );
+        }
+
+        /// read a line, without its new line, into line. returns false at
+        /// the end of the file.
+        static bool read_line(FILE *fp, std::vector<char> &line) throw() {
+            line.clear();
+
+            int ch(getc(fp));
+            if(EOF == ch) {
+                return false;
+            }
+
+            for(; EOF != ch && '\n' != ch; ch = getc(fp)) {
+                line.push_back(static_cast<char>(ch));
+            }
+
+            return true;
+        }
+
+        static int main(io::CommandLineOptions &options) throw() {
+
+            io::format::type in_format;
+
+            if(!io::get_format(options, "in-format", in_format)) {
+                return 1;
+            }
+
+            // run the tool
+            io::option_type file[2];
+            const char *file_name[2] = {0};
+            FILE *fp[2] = {0};
+
+            file[0] = options[0U];
+            file_name[0] = file[0].value();
+            fp[0] = fopen(file_name[0], "r");
+
+            if(0 == fp[0]) {
+                options.error(
+                    "Unable to open file containing finite automaton for "
+                    "reading."
+                );
+                options.note("File specified here:", file[0]);
+
+                return 1;
+            }
+
+            file[1] = options["stdin"];
+            if(file[1].is_valid()) {
+                fp[1] = stdin;
+                file_name[1] = "<stdin>";
+            } else {
+                file[1] = options[1U];
+                file_name[1] = file[1].value();
+                fp[1] = fopen(file_name[1], "r");
+            }
+
+            if(0 == fp[1]) {
+                options.error(
+                    "Unable to open file containing lines to be matched."
+                );
+                options.note("File specified here:", file[1]);
+
+                fclose(fp[0]);
+                return 1;
+            }
+
+            nfa_type nfa;
+            int ret(0);
+
+            if(io::fread(fp[0], nfa, file_name[0], in_format)) {
+
+                nfa_type bytes;
+                fltl::BitParallelNFA<AlphaT> matcher;
+
+                algorithm::NFA_EXPAND_BYTES<AlphaT>::run(nfa, bytes);
+                matcher.compile(bytes);
+
+                io::verbose(
+                    "Simulating %u NFA states with %u positions in %u words...\n",
+                    nfa.num_states(),
+                    matcher.num_positions(),
+                    matcher.num_set_words()
+                );
+
+                const bool full(options["full"].is_valid());
+                std::vector<char> line;
+                unsigned line_number(0);
+                unsigned num_matches(0);
+
+                for(; read_line(fp[1], line); ) {
+                    ++line_number;
+
+                    const char *begin(line.empty() ? "" : &(line[0]));
+                    const char *end(begin + line.size());
+
+                    if(full) {
+                        if(!matcher.run(begin, end)) {
+                            continue;
+                        }
+
+                        fprintf(stdout, "%u:", line_number);
+
+                    } else {
+                        const char *match_end(matcher.find(begin, end));
+                        if(0 == match_end) {
+                            continue;
+                        }
+
+                        fprintf(stdout,
+                            "%u:%u:",
+                            line_number,
+                            static_cast<unsigned>(match_end - begin)
+                        );
+                    }
+
+                    ++num_matches;
+                    fwrite(begin, 1U, line.size(), stdout);
+                    fputc('\n', stdout);
+                }
+
+                io::verbose(
+                    "Matched %u of %u lines.\n",
+                    num_matches,
+                    line_number
+                );
+
+            } else {
+                ret = 1;
+            }
+
+            fclose(fp[0]);
+            if(stdin != fp[1]) {
+                fclose(fp[1]);
+            }
+
+            return ret;
+        }
+    };
+
+    template <typename AlphaT>
+    const char * const NFA_MATCH<AlphaT>::TOOL_NAME("nfa-match");
+}}
+
+#endif /* Grail_Plus_NFA_MATCH_HPP_ */
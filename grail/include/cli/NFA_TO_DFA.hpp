@@ -0,0 +1,154 @@
+/*
+ * NFA_TO_DFA.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_CLI_NFA_TO_DFA_HPP_
+#define FLTL_CLI_NFA_TO_DFA_HPP_
+
+#include <cstdio>
+
+#include "fltl/include/NFA.hpp"
+
+#include "grail/include/algorithm/NFA_TO_DFA.hpp"
+
+#include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
+#include "grail/include/io/fread_nfa.hpp"
+#include "grail/include/io/fprint_nfa.hpp"
+#include "grail/include/io/verbose.hpp"
+
+#include "grail/include/cli/NFA_TO_DOT.hpp"
+
+namespace grail { namespace cli {
+
+    template <typename AlphaT>
+    class NFA_TO_DFA {
+    public:
+
+        FLTL_NFA_USE_TYPES(fltl::NFA<AlphaT>);
+
+        static const char * const TOOL_NAME;
+
+        static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("out-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("dot", io::opt::OPTIONAL, io::opt::NO_VAL);
+            if(!in_help) {
+                if(in.is_valid()) {
+                    opt.declare_max_num_positional(0);
+                } else {
+                    opt.declare_min_num_positional(1);
+                    opt.declare_max_num_positional(1);
+                }
+            }
+        }
+
+        static void help(void) throw() {
+            //  "  | |                              |                                             |"
+            printf(
+                "  %s:\n"
+                "    Converts a non-deterministic finite automaton (NFA) into a deterministic\n"
+                "    finite automaton (DFA) using the subset construction. Each accepting state\n"
+                "    of the DFA accepts the token named by its lowest-numbered named accepting\n"
+                "    NFA state; see dfa-to-scanner.\n\n"
+                "  basic use options for %s:\n"
+                "    --stdin                        Read an NFA from stdin. Typing a new\n"
+                "                                   line followed by Ctrl-D or Ctrl-Z will\n"
+                "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    --out-format=<fmt>             write the output in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    --dot                          output the DFA as a DOT digraph.\n"
+                "    <file>                         read in an NFA from <file>.\n\n",
+                TOOL_NAME, TOOL_NAME
+            );
+        }
+
+        static int main(io::CommandLineOptions &options) throw() {
+
+            io::format::type in_format;
+            io::format::type out_format;
+
+            if(!io::get_format(options, "in-format", in_format)
+            || !io::get_format(options, "out-format", out_format)) {
+                return 1;
+            }
+
+            // run the tool
+            io::option_type file;
+            const char *file_name(0);
+
+            FILE *fp(0);
+
+            // take input from stdin or from a file?
+            if(options["stdin"].is_valid()) {
+                file = options["stdin"];
+                fp = stdin;
+                file_name = "<stdin>";
+            } else {
+                file = options[0U];
+                file_name = file.value();
+                fp = fopen(file_name, "r");
+            }
+
+            // couldn't open the file
+            if(0 == fp) {
+                options.error(
+                    "Unable to open file containing non-deterministic finite "
+                    "automaton for reading."
+                );
+                options.note("File specified here:", file);
+                return 1;
+            }
+
+            nfa_type nfa;
+            nfa_type dfa;
+            int ret(0);
+
+            if(io::fread(fp, nfa, file_name, in_format)) {
+
+                io::verbose("Converting %u NFA states...\n", nfa.num_states());
+                algorithm::NFA_TO_DFA<AlphaT>::run(nfa, dfa);
+                io::verbose("Built %u DFA states.\n", dfa.num_states());
+
+                if(options["dot"].is_valid()) {
+                    NFA_TO_DOT<AlphaT>::print(stdout, dfa);
+                } else {
+                    io::fwrite(stdout, dfa, out_format);
+                }
+
+            } else {
+                ret = 1;
+            }
+
+            fclose(fp);
+
+            return ret;
+        }
+    };
+
+    template <typename AlphaT>
+    const char * const NFA_TO_DFA<AlphaT>::TOOL_NAME("nfa-to-dfa");
+}}
+
+#endif /* FLTL_CLI_NFA_TO_DFA_HPP_ */
@@ -35,6 +35,7 @@
 #include "fltl/include/NFA.hpp"
 
 #include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/fread_nfa.hpp"
 
 namespace grail { namespace cli {
@@ -49,6 +50,7 @@ namespace grail { namespace cli {
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
             io::option_type in(opt.declare("stdin", io::opt::OPTIONAL, io::opt::NO_VAL));
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             if(!in_help) {
                 if(in.is_valid()) {
                     opt.declare_max_num_positional(0);
@@ -69,6 +71,8 @@ namespace grail { namespace cli {
                 "    --stdin                        Read a PDA from stdin. Typing a new\n"
                 "                                   line followed by Ctrl-D or Ctrl-Z will\n"
                 "                                   close stdin.\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file>                         read in an NFA from <file>.\n\n",
                 TOOL_NAME, TOOL_NAME
             );
@@ -142,6 +146,12 @@ namespace grail { namespace cli {
 
         static int main(io::CommandLineOptions &options) throw() {
 
+            io::format::type in_format;
+
+            if(!io::get_format(options, "in-format", in_format)) {
+                return 1;
+            }
+
             // run the tool
             io::option_type file;
             const char *file_name(0);
@@ -173,7 +183,7 @@ namespace grail { namespace cli {
             int ret(0);
             FILE *outfile(stdout);
 
-            if(io::fread(fp, nfa, file_name)) {
+            if(io::fread(fp, nfa, file_name, in_format)) {
 
                 print(outfile, nfa);
 
@@ -34,6 +34,7 @@
 #include "grail/include/algorithm/PDA_INTERSECT_NFA.hpp"
 
 #include "grail/include/io/CommandLineOptions.hpp"
+#include "grail/include/io/format.hpp"
 #include "grail/include/io/fread_pda.hpp"
 #include "grail/include/io/fread_nfa.hpp"
 #include "grail/include/io/fprint_pda.hpp"
@@ -47,6 +48,8 @@ namespace grail { namespace cli {
         static const char * const TOOL_NAME;
 
         static void declare(io::CommandLineOptions &opt, bool in_help) throw() {
+            opt.declare("in-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
+            opt.declare("out-format", io::opt::OPTIONAL, io::opt::REQUIRES_VAL);
             if(!in_help) {
                 opt.declare_min_num_positional(2);
                 opt.declare_max_num_positional(2);
@@ -61,6 +64,10 @@ namespace grail { namespace cli {
                 "    of the languages accepted by an input PDA and an input non-deterministic\n"
                 "    finite automaton (NFA).\n\n"
                 "  basic use options for %s:\n"
+                "    --in-format=<fmt>              read the input in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
+                "    --out-format=<fmt>             write the output in the format <fmt>, which\n"
+                "                                   is one of 'text' (default) or 'binary'.\n"
                 "    <file0>                        read in a PDA from <file0>.\n"
                 "    <file1>                        read in an NFA from <file1>.\n\n",
                 TOOL_NAME, TOOL_NAME
@@ -72,6 +79,14 @@ namespace grail { namespace cli {
             using fltl::NFA;
             using fltl::PDA;
 
+            io::format::type in_format;
+            io::format::type out_format;
+
+            if(!io::get_format(options, "in-format", in_format)
+            || !io::get_format(options, "out-format", out_format)) {
+                return 1;
+            }
+
             // run the tool
             io::option_type file[2];
             const char *file_name[2] = {0};
@@ -118,11 +133,11 @@ namespace grail { namespace cli {
             PDA<AlphaT> out;
             int ret(0);
 
-            if(io::fread(fp[0], pda, file_name[0])
-            && io::fread(fp[1], nfa, file_name[1])) {
+            if(io::fread(fp[0], pda, file_name[0], in_format)
+            && io::fread(fp[1], nfa, file_name[1], in_format)) {
 
                 algorithm::PDA_INTERSECT_NFA<AlphaT>::run(pda, nfa, out);
-                io::fprint(stdout, out);
+                io::fwrite(stdout, out, out_format);
 
             } else {
                 ret = 1;
@@ -0,0 +1,142 @@
+/*
+ * PackedTable.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef Grail_Plus_PACKEDTABLE_HPP_
+#define Grail_Plus_PACKEDTABLE_HPP_
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace grail { namespace helper {
+
+    /// a row of a sparse table to pack, as (column, value) pairs sorted by
+    /// column
+    typedef std::vector<std::pair<unsigned, int> > packed_row_type;
+
+    /// pack the rows of a sparse table into a single pair of check
+    /// and next arrays, by giving each row an offset into the arrays
+    /// such that none of its entries collide with the entries of other
+    /// rows. the entry in column c of row r is at index base[r] + c if
+    /// check[base[r] + c] == r.
+    inline void pack_rows(
+        const std::vector<packed_row_type> &rows,
+        std::vector<int> &base,
+        std::vector<int> &check,
+        std::vector<int> &next
+    ) throw() {
+        const unsigned num_rows(static_cast<unsigned>(rows.size()));
+
+        base.assign(num_rows, 0);
+        check.clear();
+        next.clear();
+
+        // place the longest rows first
+        std::vector<std::pair<unsigned, unsigned> > order;
+        for(unsigned r(0); r < num_rows; ++r) {
+            if(!rows[r].empty()) {
+                order.push_back(std::make_pair(
+                    static_cast<unsigned>(rows[r].size()), r
+                ));
+            }
+        }
+
+        std::sort(
+            order.begin(),
+            order.end(),
+            std::greater<std::pair<unsigned, unsigned> >()
+        );
+
+        unsigned first_free(0);
+
+        for(unsigned i(0); i < order.size(); ++i) {
+            const packed_row_type &row(rows[order[i].second]);
+            const unsigned min_col(row.front().first);
+
+            unsigned b(first_free > min_col ? first_free - min_col : 0U);
+            for(; ; ++b) {
+                bool fits(true);
+                for(unsigned j(0); j < row.size(); ++j) {
+                    const unsigned k(b + row[j].first);
+                    if(k < check.size() && -1 != check[k]) {
+                        fits = false;
+                        break;
+                    }
+                }
+
+                if(fits) {
+                    break;
+                }
+            }
+
+            base[order[i].second] = static_cast<int>(b);
+
+            const unsigned end(b + row.back().first + 1U);
+            if(check.size() < end) {
+                check.resize(end, -1);
+                next.resize(end, 0);
+            }
+
+            for(unsigned j(0); j < row.size(); ++j) {
+                check[b + row[j].first] = static_cast<int>(order[i].second);
+                next[b + row[j].first] = row[j].second;
+            }
+
+            for(; first_free < check.size() && -1 != check[first_free]; ) {
+                ++first_free;
+            }
+        }
+    }
+
+    /// print out an array as a C++ static constant array definition
+    inline void fprint_array(
+        FILE *fp,
+        const char *type,
+        const char *name,
+        const std::vector<int> &values
+    ) throw() {
+        fprintf(fp,
+            "static const %s %s[%u] = {",
+            type, name,
+            values.empty() ? 1U : static_cast<unsigned>(values.size())
+        );
+
+        if(values.empty()) {
+            fprintf(fp, "0");
+        }
+
+        for(unsigned i(0); i < values.size(); ++i) {
+            fprintf(fp,
+                "%s%s%d",
+                0U == i ? "" : ",",
+                0U == (i % 12U) ? "\n    " : " ",
+                values[i]
+            );
+        }
+
+        fprintf(fp, "\n};\n\n");
+    }
+}}
+
+#endif /* Grail_Plus_PACKEDTABLE_HPP_ */
@@ -0,0 +1,140 @@
+/*
+ * PairMap.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef Grail_Plus_PAIRMAP_HPP_
+#define Grail_Plus_PAIRMAP_HPP_
+
+#include <cassert>
+#include <vector>
+#include <stdint.h>
+
+namespace grail { namespace helper {
+
+    /// open-addressed hash table that numbers pairs of unsigned integers,
+    /// e.g. pairs of states, in the order in which they are inserted. the
+    /// ids are dense, so they can index vectors that hold the data of the
+    /// pairs, and iterating over the ids visits the pairs in insertion
+    /// order.
+    class PairMap {
+    private:
+
+        std::vector<uint64_t> keys;
+
+        /// each slot is 0 if empty, or 1 + the id of a pair
+        std::vector<unsigned> slots;
+
+        inline static uint64_t key_of(unsigned a, unsigned b) throw() {
+            return (static_cast<uint64_t>(a) << 32U) | b;
+        }
+
+        inline static unsigned hash(uint64_t key) throw() {
+            key *= 0x9E3779B97F4A7C15ULL;
+            return static_cast<unsigned>(key >> 32U);
+        }
+
+        void grow(void) throw() {
+            slots.assign(2U * slots.size(), 0U);
+            const unsigned mask(static_cast<unsigned>(slots.size()) - 1U);
+
+            for(unsigned j(0); j < keys.size(); ++j) {
+                unsigned k(hash(keys[j]) & mask);
+                for(; 0U != slots[k]; k = (k + 1U) & mask) { }
+                slots[k] = j + 1U;
+            }
+        }
+
+    public:
+
+        PairMap(void) throw()
+            : keys()
+            , slots(16U, 0U)
+        { }
+
+        /// look up the id of a pair. returns false if the pair has not
+        /// been inserted.
+        bool find(unsigned a, unsigned b, unsigned &id) const throw() {
+            const uint64_t key(key_of(a, b));
+            const unsigned mask(static_cast<unsigned>(slots.size()) - 1U);
+
+            for(unsigned i(hash(key) & mask);
+                0U != slots[i];
+                i = (i + 1U) & mask) {
+
+                if(key == keys[slots[i] - 1U]) {
+                    id = slots[i] - 1U;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        inline bool contains(unsigned a, unsigned b) const throw() {
+            unsigned id(0);
+            return find(a, b, id);
+        }
+
+        /// find the id of a pair, adding the pair if it isn't already
+        /// there.
+        unsigned find_or_insert(unsigned a, unsigned b, bool &is_new) throw() {
+            const uint64_t key(key_of(a, b));
+            const unsigned mask(static_cast<unsigned>(slots.size()) - 1U);
+            unsigned i(hash(key) & mask);
+
+            for(; 0U != slots[i]; i = (i + 1U) & mask) {
+                if(key == keys[slots[i] - 1U]) {
+                    is_new = false;
+                    return slots[i] - 1U;
+                }
+            }
+
+            const unsigned id(static_cast<unsigned>(keys.size()));
+            keys.push_back(key);
+            slots[i] = id + 1U;
+            is_new = true;
+
+            // keep the load factor below 1/2
+            if((2U * keys.size()) > slots.size()) {
+                grow();
+            }
+
+            return id;
+        }
+
+        /// the number of pairs
+        inline unsigned size(void) const throw() {
+            return static_cast<unsigned>(keys.size());
+        }
+
+        inline unsigned first(unsigned id) const throw() {
+            assert(id < keys.size());
+            return static_cast<unsigned>(keys[id] >> 32U);
+        }
+
+        inline unsigned second(unsigned id) const throw() {
+            assert(id < keys.size());
+            return static_cast<unsigned>(keys[id]);
+        }
+    };
+}}
+
+#endif /* Grail_Plus_PAIRMAP_HPP_ */
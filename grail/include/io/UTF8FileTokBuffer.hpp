@@ -36,7 +36,7 @@
 namespace grail { namespace io {
 
     namespace detail {
-        const char *LINE_DELIM("\n\r");
+        const char * const LINE_DELIM("\n\r");
     }
 
     template <const unsigned LINE_LENGTH>
@@ -0,0 +1,253 @@
+/*
+ * UTF8MappedBuffer.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_UTF8MAPPEDBUFFER_HPP_
+#define FLTL_UTF8MAPPEDBUFFER_HPP_
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <stdint.h>
+
+#include "grail/include/io/UTF8FileBuffer.hpp"
+
+namespace grail { namespace io {
+
+    namespace mmap {
+
+        /// map the entire contents of a regular file into memory. returns
+        /// false if the file can't be mapped, e.g. if it is a pipe.
+        bool map(FILE *fp, const char **data, size_t *size) throw();
+
+        void unmap(const char *data, size_t size) throw();
+    }
+
+    /// reads UTF-8 codepoints directly out of a memory-mapped file. this
+    /// has the same interface as UTF8FileBuffer, except that the codepoints
+    /// returned by read() point into the mapped file and so are *not* null-
+    /// terminated; use byte_length() to find their ends.
+    class UTF8MappedBuffer {
+    private:
+
+        enum {
+            // large enough to hold the longest null-terminated UTF-8
+            // character
+            MAX_CODE_POINT_SIZE = 4,
+            SCRATCH_SIZE = MAX_CODE_POINT_SIZE + 1,
+            TAB_SIZE = 4
+        };
+
+        /// the mapped file
+        const char *begin_offset;
+        const char *end_offset;
+
+        /// the next byte to decode, and the start of the most recently read
+        /// codepoint
+        const char *curr_offset;
+        const char *last_offset;
+
+        /// holds a null-terminated copy of the last codepoint for reread()
+        mutable char scratch[SCRATCH_SIZE];
+
+        /// state for line and column numbers; see UTF8FileBuffer
+        unsigned peek_column[2];
+        unsigned peek_line[2];
+        unsigned peek;
+
+        /// did we unread? note: we can only unread a single codepoint!
+        bool bactracked;
+
+        unsigned length;
+
+        size_t mapped_size;
+
+        UTF8MappedBuffer(const UTF8MappedBuffer &) throw() { assert(false); }
+        UTF8MappedBuffer &operator=(const UTF8MappedBuffer &) throw() {
+            assert(false);
+            return *this;
+        }
+
+    public:
+
+        UTF8MappedBuffer(FILE *fp) throw()
+            : begin_offset(0)
+            , end_offset(0)
+            , peek(0)
+            , mapped_size(0)
+        {
+            if(0 != fp && mmap::map(fp, &begin_offset, &mapped_size)) {
+                end_offset = begin_offset + mapped_size;
+            } else {
+                begin_offset = 0;
+                mapped_size = 0;
+            }
+
+            reset();
+        }
+
+        ~UTF8MappedBuffer(void) throw() {
+            if(0 != begin_offset) {
+                mmap::unmap(begin_offset, mapped_size);
+            }
+
+            begin_offset = 0;
+            end_offset = 0;
+            curr_offset = 0;
+            last_offset = 0;
+        }
+
+        /// was the file successfully mapped into memory?
+        bool is_mapped(void) const throw() {
+            return 0 != begin_offset;
+        }
+
+        void reset(void) throw() {
+            memset(scratch, 0, sizeof(char) * SCRATCH_SIZE);
+            memset(peek_column, 0, sizeof(unsigned) * 2);
+            memset(peek_line, 0, sizeof(unsigned) * 2);
+
+            bactracked = false;
+            curr_offset = begin_offset;
+            last_offset = begin_offset;
+            peek = 0;
+            peek_line[0] = 1;
+            peek_column[0] = 1;
+            length = 0;
+        }
+
+        /// return the last uft-8 codepoint read
+        const char *reread(void) const throw() {
+            memcpy(scratch, last_offset, length);
+            scratch[length] = '\0';
+            return &(scratch[0]);
+        }
+
+        /// try to unread a codepoint
+        void unread(void) throw() {
+            assert(!bactracked);
+
+            peek = 1 - peek;
+            bactracked = true;
+            curr_offset = last_offset;
+        }
+
+        /// return the byte length of the most recently read codepoint
+        unsigned byte_length(void) const throw() {
+            return length;
+        }
+
+        /// read out a single utf-8 codepoint
+        const char *read(void) throw() {
+            static const char END_OF_FILE[1] = {'\0'};
+
+        get_first_char:
+
+            last_offset = curr_offset;
+
+            // try to read one code point
+            unsigned i(0);
+            uint32_t state(UTF8_ACCEPT);
+
+            for(; curr_offset < end_offset; ) {
+
+                utf8::decode(
+                    &state,
+                    static_cast<uint32_t>(
+                        static_cast<unsigned char>(*curr_offset)
+                    )
+                );
+
+                if(UTF8_REJECT == state) {
+                    ++curr_offset;
+                    goto get_first_char;
+                }
+
+                ++i;
+                ++curr_offset;
+
+                if(UTF8_ACCEPT == state) {
+                    break;
+                }
+            }
+
+            length = i;
+
+            const char *codepoint(0 == i ? END_OF_FILE : last_offset);
+            const unsigned prev_peek(peek);
+            const char ch(*codepoint);
+            peek = 1 - peek;
+
+            // figure out the *next* line and column numbers, based on the
+            // current character
+            if(!bactracked) {
+                switch(ch) {
+                case '\0':
+                    peek_line[peek] = peek_line[prev_peek];
+                    peek_column[peek] = peek_column[prev_peek];
+                    break;
+                case ' ':
+                    peek_line[peek] = peek_line[prev_peek];
+                    peek_column[peek] = 1 + peek_column[prev_peek];
+                    break;
+                case '\n':
+                    peek_line[peek] = 1 + peek_line[prev_peek];
+                    peek_column[peek] = 1;
+                    break;
+                case '\t':
+                    peek_line[peek] = peek_line[prev_peek];
+                    peek_column[peek] = TAB_SIZE + peek_column[prev_peek];
+                    break;
+                default:
+                    // printable ascii or assume printable utf-8
+                    if(isprint(ch) || ch < 0) {
+                        peek_line[peek] = peek_line[prev_peek];
+                        peek_column[peek] = 1 + peek_column[prev_peek];
+
+                    // non-printable ascii
+                    } else {
+                        peek_line[peek] = peek_line[prev_peek];
+                        peek_column[peek] = peek_column[prev_peek];
+                    }
+                    break;
+                }
+            } else {
+                bactracked = false;
+            }
+
+            return codepoint;
+        }
+
+        /// return the line number of the last codepoint read
+        unsigned line(void) const throw() {
+            return peek_line[1 - peek];
+        }
+
+        /// return the column number of the last codepoint read
+        unsigned column(void) const throw() {
+            return peek_column[1 - peek];
+        }
+    };
+
+}}
+
+#endif /* FLTL_UTF8MAPPEDBUFFER_HPP_ */
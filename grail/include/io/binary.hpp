@@ -0,0 +1,149 @@
+/*
+ * binary.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_IO_BINARY_HPP_
+#define FLTL_IO_BINARY_HPP_
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+#include "fltl/include/trait/Uncopyable.hpp"
+
+namespace grail { namespace io { namespace binary {
+
+    /// the binary format is a header followed by flat arrays of 32-bit
+    /// little-endian integers and null-terminated strings. strings are
+    /// stored with their terminators so that a mapped file can hand them
+    /// out directly.
+    ///
+    /// header:
+    ///     "GRL+"  version  kind
+    enum {
+        VERSION = 1U,
+        KIND_CFG = 1U,
+        KIND_PDA = 2U
+    };
+
+    /// the symbols of CFG productions are tagged in their low bits
+    enum {
+        CFG_TERMINAL = 0U,
+        CFG_VARIABLE = 1U,
+        CFG_VARIABLE_TERMINAL = 2U,
+        CFG_TAG_BITS = 2U,
+        CFG_TAG_MASK = 3U
+    };
+
+    /// the kinds of PDA symbols
+    enum {
+        PDA_INPUT_SYMBOL = 0U,
+        PDA_STACK_SYMBOL = 1U
+    };
+
+    /// writes binary objects to a file
+    class Writer : private fltl::trait::Uncopyable {
+    private:
+
+        FILE *ff;
+        bool ok;
+
+    public:
+
+        Writer(FILE *ff_) throw();
+
+        /// write out the header for an object of kind KIND_*
+        void put_header(const uint32_t kind) throw();
+
+        void put_u32(const uint32_t val) throw();
+
+        void put_string(const char *str) throw();
+
+        /// elements of an alphabet are written as strings if they are
+        /// cstrings, and as integers otherwise
+        inline void put_alpha(const char *alpha) throw() {
+            put_string(alpha);
+        }
+
+        template <typename T>
+        inline void put_alpha(const T &alpha) throw() {
+            put_u32(static_cast<uint32_t>(alpha));
+        }
+
+        /// were all writes successful?
+        inline bool is_ok(void) const throw() {
+            return ok;
+        }
+    };
+
+    /// reads binary objects out of an in-memory image of a file. regular
+    /// files are mapped into memory; anything else, e.g. a pipe, is read
+    /// into memory in full.
+    class Reader : private fltl::trait::Uncopyable {
+    private:
+
+        const char *begin;
+        const char *curr;
+        const char *end;
+
+        /// how the image was obtained; only one of these is non-zero
+        size_t mapped_size;
+        char *owned;
+
+        /// did we read past the end of the image or find a malformed
+        /// string?
+        bool ok;
+
+    public:
+
+        Reader(FILE *ff) throw();
+        ~Reader(void) throw();
+
+        /// check the header against an expected object kind. reports an
+        /// error if the header doesn't match.
+        bool get_header(const uint32_t kind, const char *file_name) throw();
+
+        uint32_t get_u32(void) throw();
+
+        /// get a null-terminated string. the string points into the image
+        /// and lives as long as the reader.
+        const char *get_string(void) throw();
+
+        inline void get_alpha(const char *&alpha) throw() {
+            alpha = get_string();
+        }
+
+        template <typename T>
+        inline void get_alpha(T &alpha) throw() {
+            alpha = static_cast<T>(get_u32());
+        }
+
+        /// were all reads within bounds?
+        inline bool is_ok(void) const throw() {
+            return ok;
+        }
+
+        /// report that the object in the image is truncated or malformed
+        bool fail(const char *file_name) throw();
+    };
+}}}
+
+#endif /* FLTL_IO_BINARY_HPP_ */
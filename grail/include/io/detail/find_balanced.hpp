@@ -35,9 +35,9 @@ namespace grail { namespace io { namespace detail {
 
     /// try to find something that needs to be balanced; assumes non-null
     /// ascii
-    template <const unsigned BUFFER_SIZE, const bool LOOK_FOR_ERRORS>
+    template <typename BufferT, const bool LOOK_FOR_ERRORS>
     static bool find_balanced(
-        UTF8FileBuffer<BUFFER_SIZE> &buffer,
+        BufferT &buffer,
         const char open,
         const char close
     ) throw() {
@@ -37,9 +37,9 @@ namespace grail { namespace io { namespace detail {
     /// for has at least one non-null character in it. this also assumes
     /// that we're looking for ASCII, and so we can ignore the rest of
     /// the codepoint
-    template <const unsigned BUFFER_SIZE, const bool LOOK_FOR_ERRORS>
+    template <typename BufferT, const bool LOOK_FOR_ERRORS>
     static bool find_next(
-        UTF8FileBuffer<BUFFER_SIZE> &buffer,
+        BufferT &buffer,
         const char *close
     ) throw() {
         char ch('\0');
@@ -30,6 +30,7 @@
 #define FLTL_FIND_STRING_HPP_
 
 #include <cassert>
+#include <cstring>
 
 #include "grail/include/io/UTF8FileBuffer.hpp"
 
@@ -43,10 +44,11 @@ namespace grail { namespace io { namespace detail {
         STRING_FAIL
     } string_state_type;
 
-    /// fill up the buffer with a token
-    template <const unsigned BUFFER_SIZE, const bool LOOK_FOR_ERRORS>
+    /// fill up the buffer with a token. codepoints are copied by their
+    /// byte lengths because mapped buffers don't null-terminate them.
+    template <typename BufferT, const bool LOOK_FOR_ERRORS>
     static string_state_type find_string(
-        UTF8FileBuffer<BUFFER_SIZE> &buffer,
+        BufferT &buffer,
         char *scratch,
         const char * const scratch_end,
         const char delim
@@ -129,7 +131,7 @@ namespace grail { namespace io { namespace detail {
                 //       internal string is a""
                 for(; num_delims_seen < num_delims; ) {
                     codepoint = buffer.read();
-                    strcpy(scratch, codepoint);
+                    memcpy(scratch, codepoint, buffer.byte_length());
                     scratch += buffer.byte_length();
 
                     if(LOOK_FOR_ERRORS) {
@@ -157,7 +159,7 @@ namespace grail { namespace io { namespace detail {
 
             // copy the codepoint into scratch
             } else {
-                strcpy(scratch, codepoint);
+                memcpy(scratch, codepoint, buffer.byte_length());
                 scratch += buffer.byte_length();
             }
         }
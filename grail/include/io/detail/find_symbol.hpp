@@ -29,6 +29,8 @@
 #ifndef FLTL_FIND_SYMBOL_HPP_
 #define FLTL_FIND_SYMBOL_HPP_
 
+#include <cstring>
+
 #include "grail/include/io/UTF8FileBuffer.hpp"
 
 namespace grail { namespace io { namespace detail {
@@ -40,9 +42,9 @@ namespace grail { namespace io { namespace detail {
     } symbol_state_type;
 
     /// try to fill up scratch with a symbol
-    template <const unsigned BUFFER_SIZE, const bool LOOK_FOR_ERRORS>
+    template <typename BufferT, const bool LOOK_FOR_ERRORS>
     symbol_state_type find_symbol(
-        UTF8FileBuffer<BUFFER_SIZE> &buffer,
+        BufferT &buffer,
         char *scratch,
         const char * const scratch_end,
         bool (*predicate)(const char *)
@@ -53,7 +55,7 @@ namespace grail { namespace io { namespace detail {
         for(;;) {
             codepoint = buffer.read();
             if(predicate(codepoint)) {
-                strcpy(scratch, codepoint);
+                memcpy(scratch, codepoint, buffer.byte_length());
                 scratch += buffer.byte_length();
 
                 if(LOOK_FOR_ERRORS && scratch >= scratch_end) {
@@ -0,0 +1,89 @@
+/*
+ * format.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_IO_FORMAT_HPP_
+#define FLTL_IO_FORMAT_HPP_
+
+#include <cstdio>
+
+#include "grail/include/io/CommandLineOptions.hpp"
+
+#include "grail/include/io/fprint_cfg.hpp"
+#include "grail/include/io/fprint_nfa.hpp"
+#include "grail/include/io/fprint_pda.hpp"
+#include "grail/include/io/fread_cfg.hpp"
+#include "grail/include/io/fread_nfa.hpp"
+#include "grail/include/io/fread_pda.hpp"
+
+#include "grail/include/io/fread_binary_cfg.hpp"
+#include "grail/include/io/fread_binary_nfa.hpp"
+#include "grail/include/io/fread_binary_pda.hpp"
+#include "grail/include/io/fwrite_binary_cfg.hpp"
+#include "grail/include/io/fwrite_binary_nfa.hpp"
+#include "grail/include/io/fwrite_binary_pda.hpp"
+
+namespace grail { namespace io {
+
+    namespace format {
+        typedef enum {
+            TEXT,
+            BINARY
+        } type;
+    }
+
+    /// figure out the format named by a command-line option, e.g.
+    /// --in-format=binary. the format defaults to text if the option isn't
+    /// given. reports an error and returns false if the format isn't known.
+    bool get_format(
+        CommandLineOptions &options,
+        const char *opt_name,
+        format::type &fmt
+    ) throw();
+
+    /// read in a CFG, PDA, or NFA in a particular format
+    template <typename T>
+    bool fread(
+        FILE *ff,
+        T &obj,
+        const char * const file_name,
+        const format::type fmt
+    ) throw() {
+        if(format::BINARY == fmt) {
+            return fread_binary(ff, obj, file_name);
+        } else {
+            return fread(ff, obj, file_name);
+        }
+    }
+
+    /// write out a CFG, PDA, or NFA in a particular format
+    template <typename T>
+    bool fwrite(FILE *ff, T &obj, const format::type fmt) throw() {
+        if(format::BINARY == fmt) {
+            return fwrite_binary(ff, obj);
+        } else {
+            fprint(ff, obj);
+            return true;
+        }
+    }
+}}
+
+#endif /* FLTL_IO_FORMAT_HPP_ */
@@ -35,25 +35,172 @@
 
 #include "grail/include/cfg/ParseTree.hpp"
 
+#include "grail/include/io/fprint.hpp"
+
 namespace grail { namespace io {
 
     class dot_language { };
     class lisp_language { };
     class tree_language { };
 
+    namespace detail {
+
+        /// print out the label of a parse tree node. Leaves for variable
+        /// terminals are labelled with both the name of the terminal and
+        /// the lexeme that was substituted for it.
+        template <typename AlphaT>
+        int fprint_parse_tree_label(
+            FILE *ff,
+            const fltl::CFG<AlphaT> &gram,
+            const grail::cfg::ParseTree<AlphaT> *tree,
+            const char *quote
+        ) throw() {
+            int num(0);
+
+            if(-1 != tree->num_children) {
+                const typename fltl::CFG<AlphaT>::variable_type var(
+                    tree->symbol
+                );
+                return fprintf(ff, "%s", gram.get_name(var));
+            }
+
+            const typename fltl::CFG<AlphaT>::terminal_type term(
+                tree->symbol
+            );
+
+            if(gram.is_variable_terminal(term)) {
+                num += fprintf(ff, "%s ", gram.get_name(term));
+            }
+
+            num += fprintf(ff, "%s", quote);
+            num += fprint(ff, *(tree->data.alpha));
+            num += fprintf(ff, "%s", quote);
+
+            return num;
+        }
+
+        template <typename AlphaT>
+        int fprint_parse_tree_lisp(
+            FILE *ff,
+            const fltl::CFG<AlphaT> &gram,
+            const grail::cfg::ParseTree<AlphaT> *tree
+        ) throw() {
+            int num(0);
+
+            if(-1 == tree->num_children) {
+                const typename fltl::CFG<AlphaT>::terminal_type term(
+                    tree->symbol
+                );
+
+                if(gram.is_variable_terminal(term)) {
+                    num += fprintf(ff, "(");
+                    num += fprint_parse_tree_label(ff, gram, tree, "\"");
+                    num += fprintf(ff, ")");
+                } else {
+                    num += fprint_parse_tree_label(ff, gram, tree, "\"");
+                }
+
+                return num;
+            }
+
+            num += fprintf(ff, "(");
+            num += fprint_parse_tree_label(ff, gram, tree, "\"");
+
+            for(int i(0); i < tree->num_children; ++i) {
+                if(0 != tree->data.slots[i]) {
+                    num += fprintf(ff, " ");
+                    num += fprint_parse_tree_lisp(
+                        ff, gram, tree->data.slots[i]
+                    );
+                }
+            }
+
+            num += fprintf(ff, ")");
+            return num;
+        }
+
+        template <typename AlphaT>
+        int fprint_parse_tree_indented(
+            FILE *ff,
+            const fltl::CFG<AlphaT> &gram,
+            const grail::cfg::ParseTree<AlphaT> *tree,
+            const unsigned depth
+        ) throw() {
+            int num(0);
+
+            for(unsigned i(0); i < depth; ++i) {
+                num += fprintf(ff, "  ");
+            }
+
+            num += fprint_parse_tree_label(ff, gram, tree, "\"");
+
+            if(0 == tree->num_children) {
+                num += fprintf(ff, " -> epsilon");
+            }
+
+            num += fprintf(ff, "\n");
+
+            for(int i(0); i < tree->num_children; ++i) {
+                if(0 != tree->data.slots[i]) {
+                    num += fprint_parse_tree_indented(
+                        ff, gram, tree->data.slots[i], depth + 1U
+                    );
+                }
+            }
+
+            return num;
+        }
+
+        /// print out the nodes and edges of a tree; returns the id of the
+        /// last node printed
+        template <typename AlphaT>
+        unsigned fprint_parse_tree_dot(
+            FILE *ff,
+            const fltl::CFG<AlphaT> &gram,
+            const grail::cfg::ParseTree<AlphaT> *tree,
+            const unsigned id,
+            int &num
+        ) throw() {
+            unsigned next_id(id);
+
+            num += fprintf(ff, "    n%u [label=\"", id);
+            num += fprint_parse_tree_label(ff, gram, tree, "'");
+            num += fprintf(
+                ff,
+                "\"%s];\n",
+                (-1 == tree->num_children ? " shape=box" : "")
+            );
+
+            for(int i(0); i < tree->num_children; ++i) {
+                if(0 != tree->data.slots[i]) {
+                    num += fprintf(ff, "    n%u -> n%u;\n", id, next_id + 1U);
+                    next_id = fprint_parse_tree_dot(
+                        ff, gram, tree->data.slots[i], next_id + 1U, num
+                    );
+                }
+            }
+
+            return next_id;
+        }
+    }
+
+    /// print out a parse tree as a DOT digraph
     template <typename AlphaT>
     int fprint(
         FILE *ff,
-        fltl::CFG<AlphaT> &gram,
+        const fltl::CFG<AlphaT> &gram,
         const grail::cfg::ParseTree<AlphaT> *tree,
         const dot_language
     ) throw() {
-
-        (void) ff;
-        (void) gram;
-        (void) tree;
+        int num(fprintf(ff, "digraph {\n"));
+        if(0 != tree) {
+            detail::fprint_parse_tree_dot(ff, gram, tree, 0U, num);
+        }
+        num += fprintf(ff, "}\n");
+        return num;
     }
 
+    /// print out a parse tree as an S-expression on a single line
     template <typename AlphaT>
     int fprint(
         FILE *ff,
@@ -61,12 +208,15 @@ namespace grail { namespace io {
         const grail::cfg::ParseTree<AlphaT> *tree,
         const lisp_language
     ) throw() {
-
-        (void) ff;
-        (void) gram;
-        (void) tree;
+        int num(0);
+        if(0 != tree) {
+            num += detail::fprint_parse_tree_lisp(ff, gram, tree);
+        }
+        num += fprintf(ff, "\n");
+        return num;
     }
 
+    /// print out a parse tree with one node per line, indented by depth
     template <typename AlphaT>
     int fprint(
         FILE *ff,
@@ -74,10 +224,10 @@ namespace grail { namespace io {
         const grail::cfg::ParseTree<AlphaT> *tree,
         const tree_language
     ) throw() {
-
-        (void) ff;
-        (void) gram;
-        (void) tree;
+        if(0 == tree) {
+            return 0;
+        }
+        return detail::fprint_parse_tree_indented(ff, gram, tree, 0U);
     }
 }}
 
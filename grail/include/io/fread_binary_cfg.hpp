@@ -0,0 +1,177 @@
+/*
+ * fread_binary_cfg.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FREAD_BINARY_CFG_HPP_
+#define FLTL_FREAD_BINARY_CFG_HPP_
+
+#include <cctype>
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/io/binary.hpp"
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace io {
+
+    namespace binary {
+
+        /// make sure that a name read from a binary file is one that a
+        /// CFG will accept; auto-generated names are '$' and digits.
+        inline bool is_symbol_name(const char *name) throw() {
+            if('\0' == *name) {
+                return false;
+            } else if('$' != *name) {
+                return true;
+            }
+
+            for(++name; '\0' != *name; ++name) {
+                if(!isdigit(*name)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+
+    /// read in a context-free grammar that was written by fwrite_binary
+    template <typename AlphaT>
+    bool fread_binary(
+        FILE *ff,
+        fltl::CFG<AlphaT> &CFG,
+        const char * const file_name
+    ) throw() {
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        if(0 == ff) {
+            return false;
+        }
+
+        io::verbose("Reading binary CFG from '%s'...\n", file_name);
+
+        binary::Reader in(ff);
+        if(!in.get_header(binary::KIND_CFG, file_name)) {
+            return false;
+        }
+
+        std::vector<terminal_type> terms;
+        std::vector<variable_type> vars;
+        std::vector<symbol_type> var_terms;
+        alphabet_type alpha;
+
+        // counts come from the file, so they are only trusted as far as
+        // the reads succeed
+        uint32_t num(in.get_u32());
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            in.get_alpha(alpha);
+            terms.push_back(CFG.get_terminal(alpha));
+        }
+
+        num = in.get_u32();
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            const char *name(in.get_string());
+            if(!binary::is_symbol_name(name)) {
+                return in.fail(file_name);
+            }
+            vars.push_back(CFG.get_variable(name));
+        }
+
+        num = in.get_u32();
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            const char *name(in.get_string());
+            if(!binary::is_symbol_name(name)) {
+                return in.fail(file_name);
+            }
+            var_terms.push_back(CFG.get_variable_symbol(name));
+        }
+
+        if(!vars.empty()) {
+            CFG.set_start_variable(vars[0]);
+        }
+
+        symbol_buffer_type prod_buffer;
+        typename fltl::CFG<AlphaT>::bulk_loader_type loader(CFG);
+
+        num = in.get_u32();
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            const uint32_t head(in.get_u32());
+            const uint32_t len(in.get_u32());
+
+            if(head >= vars.size()) {
+                return in.fail(file_name);
+            }
+
+            prod_buffer.clear();
+            for(uint32_t j(0); j < len && in.is_ok(); ++j) {
+                const uint32_t tagged(in.get_u32());
+                const uint32_t index(tagged >> binary::CFG_TAG_BITS);
+
+                switch(tagged & binary::CFG_TAG_MASK) {
+                case binary::CFG_TERMINAL:
+                    if(index >= terms.size()) {
+                        return in.fail(file_name);
+                    }
+                    prod_buffer.append(terms[index]);
+                    break;
+
+                case binary::CFG_VARIABLE:
+                    if(index >= vars.size()) {
+                        return in.fail(file_name);
+                    }
+                    prod_buffer.append(vars[index]);
+                    break;
+
+                case binary::CFG_VARIABLE_TERMINAL:
+                    if(index >= var_terms.size()) {
+                        return in.fail(file_name);
+                    }
+                    prod_buffer.append(var_terms[index]);
+                    break;
+
+                default:
+                    return in.fail(file_name);
+                }
+            }
+
+            loader.add_production(vars[head], prod_buffer);
+        }
+
+        loader.commit();
+
+        if(!in.is_ok()) {
+            return in.fail(file_name);
+        }
+
+        io::verbose("    %u variables,\n", CFG.num_variables());
+        io::verbose("    %u productions,\n", CFG.num_productions());
+        io::verbose("    %u terminals,\n", CFG.num_terminals());
+        io::verbose("    %u variable terminals.\n", CFG.num_variable_terminals());
+
+        return true;
+    }
+}}
+
+#endif /* FLTL_FREAD_BINARY_CFG_HPP_ */
@@ -0,0 +1,148 @@
+/*
+ * fread_binary_pda.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FREAD_BINARY_PDA_HPP_
+#define FLTL_FREAD_BINARY_PDA_HPP_
+
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/PDA.hpp"
+
+#include "grail/include/io/binary.hpp"
+#include "grail/include/io/verbose.hpp"
+
+namespace grail { namespace io {
+
+    /// read in a pushdown automaton that was written by fwrite_binary
+    template <typename AlphaT>
+    bool fread_binary(
+        FILE *ff,
+        fltl::PDA<AlphaT> &PDA,
+        const char * const file_name
+    ) throw() {
+
+        FLTL_PDA_USE_TYPES(fltl::PDA<AlphaT>);
+
+        if(0 == ff) {
+            return false;
+        }
+
+        io::verbose("Reading binary PDA from '%s'...\n", file_name);
+
+        binary::Reader in(ff);
+        if(!in.get_header(binary::KIND_PDA, file_name)) {
+            return false;
+        }
+
+        std::vector<state_type> states;
+        std::vector<symbol_type> symbols;
+        std::vector<bool> is_input;
+        alphabet_type alpha;
+
+        // the first state of a new PDA is its start state
+        uint32_t num(in.get_u32());
+        const uint32_t start(in.get_u32());
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            const state_type state(
+                0U == i ? PDA.get_start_state() : PDA.add_state()
+            );
+            const char *name(in.get_string());
+            if('\0' != *name) {
+                PDA.set_name(state, name);
+            }
+            states.push_back(state);
+        }
+
+        if(start >= states.size()) {
+            return in.fail(file_name);
+        }
+
+        PDA.set_start_state(states[start]);
+
+        num = in.get_u32();
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            const uint32_t state(in.get_u32());
+            if(state >= states.size()) {
+                return in.fail(file_name);
+            }
+            PDA.add_accept_state(states[state]);
+        }
+
+        symbols.push_back(PDA.epsilon());
+        is_input.push_back(false);
+
+        num = in.get_u32();
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            if(binary::PDA_INPUT_SYMBOL == in.get_u32()) {
+                in.get_alpha(alpha);
+                symbols.push_back(PDA.get_alphabet_symbol(alpha));
+                is_input.push_back(true);
+            } else {
+                const char *name(in.get_string());
+                if('\0' == *name) {
+                    return in.fail(file_name);
+                }
+                symbols.push_back(PDA.get_stack_symbol(name));
+                is_input.push_back(false);
+            }
+        }
+
+        num = in.get_u32();
+        for(uint32_t i(0); i < num && in.is_ok(); ++i) {
+            const uint32_t source(in.get_u32());
+            const uint32_t read(in.get_u32());
+            const uint32_t pop(in.get_u32());
+            const uint32_t push(in.get_u32());
+            const uint32_t sink(in.get_u32());
+
+            if(source >= states.size() || sink >= states.size()
+            || read >= symbols.size() || pop >= symbols.size()
+            || push >= symbols.size()
+            || (0U != read && !is_input[read])) {
+                return in.fail(file_name);
+            }
+
+            PDA.add_transition(
+                states[source],
+                symbols[read],
+                symbols[pop],
+                symbols[push],
+                states[sink]
+            );
+        }
+
+        if(!in.is_ok()) {
+            return in.fail(file_name);
+        }
+
+        io::verbose("    %u states,\n", PDA.num_states());
+        io::verbose("        %u accept states,\n", PDA.num_accept_states());
+        io::verbose("    %u transitions,\n", PDA.num_transitions());
+        io::verbose("    %u symbols.\n", PDA.num_symbols());
+
+        return true;
+    }
+}}
+
+#endif /* FLTL_FREAD_BINARY_PDA_HPP_ */
@@ -34,10 +34,14 @@
 
 #include "fltl/include/CFG.hpp"
 
+#include "fltl/include/helper/Array.hpp"
+#include "fltl/include/helper/Interner.hpp"
+
 #include "grail/include/io/error.hpp"
 #include "grail/include/io/fread.hpp"
 #include "grail/include/io/verbose.hpp"
 #include "grail/include/io/UTF8FileBuffer.hpp"
+#include "grail/include/io/UTF8MappedBuffer.hpp"
 
 #include "grail/include/io/detail/find_balanced.hpp"
 #include "grail/include/io/detail/find_next.hpp"
@@ -81,9 +85,9 @@ namespace grail { namespace io {
         uint8_t next_state(uint8_t curr_state, token_type input) throw();
 
         /// tokenize a file as if it contained
-        template <const bool LOOK_FOR_ERRORS>
+        template <typename BufferT, const bool LOOK_FOR_ERRORS>
         static cfg::token_type get_token(
-            UTF8FileBuffer<cfg::BUFFER_SIZE> &buffer,
+            BufferT &buffer,
             char *scratch,
             const char * const scratch_end,
             const char * const file_name
@@ -140,7 +144,7 @@ namespace grail { namespace io {
                             "the relation of a single-line production (in the "
                             "style of the Natural Language Toolkit) but got "
                             "'%s' instead.",
-                            codepoint
+                            buffer.reread()
                         );
                         return cfg::T_ERROR;
                     }
@@ -156,7 +160,7 @@ namespace grail { namespace io {
                     }
 
                     str_state = detail::find_string<
-                        cfg::BUFFER_SIZE,
+                        BufferT,
                         LOOK_FOR_ERRORS
                     >(
                         buffer,
@@ -225,7 +229,7 @@ namespace grail { namespace io {
 
                         if(LOOK_FOR_ERRORS) {
                             const bool find_close(detail::find_next<
-                                cfg::BUFFER_SIZE,
+                                BufferT,
                                 LOOK_FOR_ERRORS
                             >(
                                 buffer, ":}"
@@ -258,7 +262,7 @@ namespace grail { namespace io {
                         }
 
                         const bool find_close(detail::find_balanced<
-                            cfg::BUFFER_SIZE,
+                            BufferT,
                             LOOK_FOR_ERRORS
                         >(
                             buffer, '{', '}'
@@ -298,7 +302,7 @@ namespace grail { namespace io {
                         if(LOOK_FOR_ERRORS) {
 
                             const bool find_close(detail::find_next<
-                                cfg::BUFFER_SIZE,
+                                BufferT,
                                 LOOK_FOR_ERRORS
                             >(
                                 buffer, "%}"
@@ -350,7 +354,7 @@ namespace grail { namespace io {
                         if(LOOK_FOR_ERRORS) {
 
                             const bool find_close(detail::find_next<
-                                cfg::BUFFER_SIZE,
+                                BufferT,
                                 LOOK_FOR_ERRORS
                             >(
                                 buffer, "*/"
@@ -390,7 +394,7 @@ namespace grail { namespace io {
                             "I found a '/' and so was expecting either a "
                             "'/*' or a '//' as a way of beginning a comment "
                             "block. Instead, you gave me '/%s'.",
-                            codepoint
+                            buffer.reread()
                         );
                         return cfg::T_ERROR;
                     }
@@ -399,7 +403,7 @@ namespace grail { namespace io {
                 // Python-style comments
                 case '#':
                 ignore_line:
-                    detail::find_next<cfg::BUFFER_SIZE,LOOK_FOR_ERRORS>(buffer, "\n");
+                    detail::find_next<BufferT,LOOK_FOR_ERRORS>(buffer, "\n");
                     return cfg::T_NEW_LINE;
 
                 // new line
@@ -411,7 +415,7 @@ namespace grail { namespace io {
                     scratch[0] = '$';
                     scratch[1] = '\0';
                     detail::find_symbol<
-                        cfg::BUFFER_SIZE,
+                        BufferT,
                         LOOK_FOR_ERRORS
                     >(
                         buffer,
@@ -446,9 +450,9 @@ namespace grail { namespace io {
                             temp_col = buffer.column();
                         }
 
-                        strcpy(scratch, codepoint);
+                        memcpy(scratch, codepoint, buffer.byte_length());
                         sym_state = detail::find_symbol<
-                            cfg::BUFFER_SIZE,
+                            BufferT,
                             LOOK_FOR_ERRORS
                         >(
                             buffer,
@@ -492,7 +496,7 @@ namespace grail { namespace io {
                         error(
                             file_name, buffer.line(), buffer.column(),
                             "Unexpected UTF-8 codepoint found: '%s'.",
-                            codepoint
+                            buffer.reread()
                         );
                         return cfg::T_ERROR;
                     }
@@ -501,175 +505,239 @@ namespace grail { namespace io {
 
             return cfg::T_ERROR;
         }
-    }
 
-    /// read in a context free grammar from a file
-    template <typename AlphaT>
-    bool fread(
-        FILE *ff,
-        fltl::CFG<AlphaT> &CFG,
-        const char * const file_name
-    ) throw() {
+        /// a symbol of a production whose kind is not yet known. named
+        /// symbols on the right-hand sides of productions can't be told
+        /// apart from variable terminals until the whole grammar has been
+        /// read, so they are given provisional ids and resolved afterward.
+        template <typename AlphaT>
+        class PendingSymbol {
+        public:
 
-        if(0 == ff) {
-            return false;
-        }
+            typename fltl::CFG<AlphaT>::symbol_type symbol;
 
-        io::verbose("Reading CFG from '%s'...\n", file_name);
+            /// one plus the provisional id of the named symbol, or zero if
+            /// the symbol is a terminal that is already known
+            unsigned name;
 
-        cfg::token_type tt(cfg::T_END);
-        UTF8FileBuffer<cfg::BUFFER_SIZE> buffer(ff);
+            PendingSymbol(void) throw()
+                : symbol()
+                , name(0)
+            { }
+        };
 
-        // extra space is given to the scratch space to allow short overruns
-        char scratch[cfg::SCRATCH_SIZE + 20] = {'\0'};
-        char *scratch_end(&(scratch[cfg::SCRATCH_SIZE - 1]));
+        /// read in a context free grammar from a UTF-8 buffer. the buffer is
+        /// read exactly once, so it need not be seekable.
+        template <typename AlphaT, typename BufferT>
+        bool fread(
+            BufferT &buffer,
+            fltl::CFG<AlphaT> &CFG,
+            const char * const file_name
+        ) throw() {
 
-        // pre-process; this goes and looks for syntax errors and tries
-        // to build up a map of all of the variables.
-        uint8_t prev_state(cfg::STATE_INITIAL);
-        uint8_t state(cfg::STATE_INITIAL);
-        typename fltl::CFG<AlphaT>::alphabet_type terminal;
+            typedef typename fltl::CFG<AlphaT>::variable_type variable_type;
 
-        for(unsigned line(0), col(0);;) {
+            cfg::token_type tt(cfg::T_END);
 
-            line = buffer.line();
-            col = buffer.column();
+            // extra space is given to the scratch space to allow short overruns
+            char scratch[cfg::SCRATCH_SIZE + 20] = {'\0'};
+            char *scratch_end(&(scratch[cfg::SCRATCH_SIZE - 1]));
 
-            scratch[0] = '\0';
-            tt = cfg::get_token<true>(buffer, scratch, scratch_end, file_name);
-            prev_state = state;
-            state = cfg::next_state(state, tt);
+            uint8_t prev_state(cfg::STATE_INITIAL);
+            uint8_t state(cfg::STATE_INITIAL);
+            typename fltl::CFG<AlphaT>::alphabet_type terminal;
 
-            if(cfg::T_ERROR == tt) {
-                return false;
+            // productions are buffered until all variables are known; each
+            // production is a head variable and a run of symbols.
+            fltl::helper::Interner<const char *, unsigned> name_ids;
+            fltl::helper::Array<const char *> names(32U);
+            fltl::helper::Array<variable_type> heads(32U);
+            fltl::helper::Array<unsigned> lengths(32U);
+            fltl::helper::Array<cfg::PendingSymbol<AlphaT> > symbols(128U);
 
-            // add in the terminals
-            } else if(cfg::T_TERMINAL == tt) {
-                fltl::CFG<AlphaT>::traits_type::unserialize(
-                    scratch,
-                    terminal
-                );
-                CFG.get_terminal(terminal);
-            }
+            cfg::PendingSymbol<AlphaT> pending;
+            variable_type var;
+            unsigned length(0);
 
-            switch(state) {
-            case cfg::STATE_FINAL:
-                goto parsed_successfully;
-            case cfg::STATE_SINK:
+            for(unsigned line(0), col(0);;) {
 
-                switch(tt) {
-                case cfg::T_BEGIN_SINGLE_LINE_RELATION:
-                    strcpy(scratch, "->");
-                    break;
-                case cfg::T_BEGIN_MULTILINE_RELATION:
-                    strcpy(scratch, ":");
-                    break;
-                case cfg::T_EXTEND_MULTILINE_RELATION:
-                    strcpy(scratch, "|");
-                    break;
-                case cfg::T_END_RELATION:
-                    strcpy(scratch, ";");
-                    break;
-                case cfg::T_NEW_LINE:
-                    strcpy(scratch, "\\n");
-                    break;
-                case cfg::T_END:
-                    strcpy(scratch, "<EOF>");
-                    break;
+                line = buffer.line();
+                col = buffer.column();
 
-                case cfg::T_ERROR:
-                case cfg::T_SYMBOL:
-                case cfg::T_TERMINAL:
-                default:
-                    break;
+                scratch[0] = '\0';
+                tt = cfg::get_token<BufferT, true>(buffer, scratch, scratch_end, file_name);
+                prev_state = state;
+                state = cfg::next_state(state, tt);
+
+                if(cfg::T_ERROR == tt) {
+                    return false;
                 }
 
-                error(
-                    file_name, buffer.line(), buffer.column(),
-                    "Unexpected symbol found with value '%s'. Note: "
-                    "previous state of parsing automaton was %u.",
-                    scratch, prev_state
-                );
+                switch(state) {
+
+                case cfg::STATE_CAT_SINGLE_LINE:
+                    goto add_symbol;
 
-                return false;
+                case cfg::STATE_EXTEND_OR_CAT_MULTILINE:
+                    if(cfg::T_EXTEND_MULTILINE_RELATION != tt) {
+                        goto add_symbol;
+                    }
+                    /* fall-through */
+                case cfg::STATE_DONE_PRODUCTION:
+                    if(cfg::STATE_CAT_SINGLE_LINE == prev_state
+                    || cfg::STATE_EXTEND_OR_CAT_MULTILINE == prev_state) {
+                        heads.append(var);
+                        lengths.append(length);
+                        length = 0;
+                    }
+                    break;
+
+                case cfg::STATE_FINAL:
+                    goto parsed_successfully;
+
+                case cfg::STATE_SINK:
+
+                    switch(tt) {
+                    case cfg::T_BEGIN_SINGLE_LINE_RELATION:
+                        strcpy(scratch, "->");
+                        break;
+                    case cfg::T_BEGIN_MULTILINE_RELATION:
+                        strcpy(scratch, ":");
+                        break;
+                    case cfg::T_EXTEND_MULTILINE_RELATION:
+                        strcpy(scratch, "|");
+                        break;
+                    case cfg::T_END_RELATION:
+                        strcpy(scratch, ";");
+                        break;
+                    case cfg::T_NEW_LINE:
+                        strcpy(scratch, "\\n");
+                        break;
+                    case cfg::T_END:
+                        strcpy(scratch, "<EOF>");
+                        break;
+
+                    case cfg::T_ERROR:
+                    case cfg::T_SYMBOL:
+                    case cfg::T_TERMINAL:
+                    default:
+                        break;
+                    }
 
-            // record that a symbol is a variable
-            case cfg::STATE_SEEN_PRODUCTION_VARIABLE:
-                if(0 == strcmp(scratch, "epsilon")) {
                     error(
-                        file_name, line, col,
-                        "Cannot re-define meta-variable epsilon."
+                        file_name, buffer.line(), buffer.column(),
+                        "Unexpected symbol found with value '%s'. Note: "
+                        "previous state of parsing automaton was %u.",
+                        scratch, prev_state
                     );
+
                     return false;
-                }
-                CFG.get_variable(scratch);
-                break;
-            }
-        }
-    parsed_successfully:
 
-        // go back to the start of the file
-        buffer.reset();
-        typename fltl::CFG<AlphaT>::symbol_buffer_type prod_buffer;
-        typename fltl::CFG<AlphaT>::variable_type var;
+                // record that a symbol is a variable
+                case cfg::STATE_SEEN_PRODUCTION_VARIABLE:
+                    if(0 == strcmp(scratch, "epsilon")) {
+                        error(
+                            file_name, line, col,
+                            "Cannot re-define meta-variable epsilon."
+                        );
+                        return false;
+                    }
+                    var = CFG.get_variable(scratch);
+                    break;
+                }
 
-        for(state = cfg::STATE_INITIAL; ;) {
+                continue;
 
-            scratch[0] = '\0';
-            tt = cfg::get_token<false>(buffer, scratch, scratch_end, file_name);
-            prev_state = state;
-            state = cfg::next_state(state, tt);
+            add_symbol:
+                if(cfg::T_TERMINAL == tt) {
+                    fltl::CFG<AlphaT>::traits_type::unserialize(
+                        scratch,
+                        terminal
+                    );
+                    pending.symbol = CFG.get_terminal(terminal);
+                    pending.name = 0;
+                    symbols.append(pending);
+                    ++length;
+
+                } else if(cfg::T_SYMBOL == tt) {
+                    if(0 != strcmp(scratch, "epsilon")) {
+                        if(!name_ids.find(scratch, pending.name)) {
+                            pending.name = names.size() + 1U;
+                            names.append(name_ids.insert(scratch, pending.name));
+                        }
+                        symbols.append(pending);
+                        ++length;
+                    }
+                }
+            }
 
-            switch(state) {
+        parsed_successfully:
 
-            case cfg::STATE_CAT_SINGLE_LINE:
-                goto add_symbol;
+            // every variable is now known, so the provisional names can be
+            // resolved to either variables or variable terminals. names are
+            // numbered by first appearance, so variable terminals are
+            // created in the same order as they appear in the grammar.
+            {
+                fltl::helper::Array<
+                    typename fltl::CFG<AlphaT>::symbol_type
+                > resolved(names.size() + 1U);
 
-            case cfg::STATE_EXTEND_OR_CAT_MULTILINE:
-                if(cfg::T_EXTEND_MULTILINE_RELATION != tt) {
-                    goto add_symbol;
+                for(unsigned i(0); i < names.size(); ++i) {
+                    resolved.append(CFG.get_variable_symbol(names.get(i)));
                 }
-                /* fall-through */
-            case cfg::STATE_DONE_PRODUCTION:
-                if(cfg::STATE_CAT_SINGLE_LINE == prev_state
-                || cfg::STATE_EXTEND_OR_CAT_MULTILINE == prev_state) {
-                    CFG.add_production(var, prod_buffer);
+
+                typename fltl::CFG<AlphaT>::symbol_buffer_type prod_buffer;
+                typename fltl::CFG<AlphaT>::bulk_loader_type loader(CFG);
+                loader.reserve(heads.size(), symbols.size());
+
+                for(unsigned i(0), j(0); i < heads.size(); ++i) {
                     prod_buffer.clear();
+                    for(const unsigned end(j + lengths.get(i)); j < end; ++j) {
+                        const cfg::PendingSymbol<AlphaT> &sym(symbols.get(j));
+                        if(0 == sym.name) {
+                            prod_buffer.append(sym.symbol);
+                        } else {
+                            prod_buffer.append(resolved.get(sym.name - 1U));
+                        }
+                    }
+                    loader.add_production(heads.get(i), prod_buffer);
                 }
-                break;
-
-            case cfg::STATE_FINAL:
-                goto done_parsing;
 
-            case cfg::STATE_SEEN_PRODUCTION_VARIABLE:
-                var = CFG.get_variable(scratch);
-                break;
+                loader.commit();
             }
 
-            continue;
-
-        add_symbol:
-            if(cfg::T_TERMINAL == tt) {
-                fltl::CFG<AlphaT>::traits_type::unserialize(
-                    scratch,
-                    terminal
-                );
-                prod_buffer.append(CFG.get_terminal(terminal));
-            } else if(cfg::T_SYMBOL == tt) {
-                if(0 != strcmp(scratch, "epsilon")) {
-                    prod_buffer.append(CFG.get_variable_symbol(scratch));
-                }
-            }
+            io::verbose("    %u variables,\n", CFG.num_variables());
+            io::verbose("    %u productions,\n", CFG.num_productions());
+            io::verbose("    %u terminals,\n", CFG.num_terminals());
+            io::verbose("    %u variable terminals.\n", CFG.num_variable_terminals());
+
+            return true;
+        }
+    }
+
+    /// read in a context free grammar from a file. regular files are
+    /// mapped into memory and tokenized in place; anything else, e.g. a
+    /// pipe, is read through a buffer.
+    template <typename AlphaT>
+    bool fread(
+        FILE *ff,
+        fltl::CFG<AlphaT> &CFG,
+        const char * const file_name
+    ) throw() {
+
+        if(0 == ff) {
+            return false;
         }
 
-    done_parsing:
+        io::verbose("Reading CFG from '%s'...\n", file_name);
 
-        io::verbose("    %u variables,\n", CFG.num_variables());
-        io::verbose("    %u productions,\n", CFG.num_productions());
-        io::verbose("    %u terminals,\n", CFG.num_terminals());
-        io::verbose("    %u variable terminals.\n", CFG.num_variable_terminals());
+        UTF8MappedBuffer mapped_buffer(ff);
+        if(mapped_buffer.is_mapped()) {
+            return cfg::fread(mapped_buffer, CFG, file_name);
+        }
 
-        return true;
+        UTF8FileBuffer<cfg::BUFFER_SIZE> buffer(ff);
+        return cfg::fread(buffer, CFG, file_name);
     }
 
 }}
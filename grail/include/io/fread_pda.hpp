@@ -42,6 +42,7 @@
 #include "grail/include/io/error.hpp"
 #include "grail/include/io/fread.hpp"
 #include "grail/include/io/UTF8FileBuffer.hpp"
+#include "grail/include/io/UTF8MappedBuffer.hpp"
 #include "grail/include/io/verbose.hpp"
 
 #include "grail/include/io/detail/find_next.hpp"
@@ -92,9 +93,9 @@ namespace grail { namespace io {
         uint8_t next_state(uint8_t curr_state, token_type input) throw();
 
         /// tokenize a file as if it contained
-        template <const bool LOOK_FOR_ERRORS>
+        template <typename BufferT, const bool LOOK_FOR_ERRORS>
         static token_type get_token(
-            UTF8FileBuffer<BUFFER_SIZE> &buffer,
+            BufferT &buffer,
             char *scratch,
             const char * const scratch_end,
             const char * const file_name
@@ -129,7 +130,7 @@ namespace grail { namespace io {
                     }
 
                     str_state = detail::find_string<
-                        BUFFER_SIZE,
+                        BufferT,
                         LOOK_FOR_ERRORS
                     >(
                         buffer,
@@ -199,7 +200,7 @@ namespace grail { namespace io {
                             file_name, buffer.line(), buffer.column(),
                             "Expected a '|' as part of a '-|' that signifies "
                             "an accept state. Instead, I got '-%s'.",
-                            codepoint
+                            buffer.reread()
                         );
                         return T_ERROR;
                     }
@@ -216,7 +217,7 @@ namespace grail { namespace io {
                             file_name, buffer.line(), buffer.column(),
                             "Expected a '-' as part of a '|-' that signifies "
                             "a start state. Instead, I got '|%s'.",
-                            codepoint
+                            buffer.reread()
                         );
                         return T_ERROR;
                     }
@@ -231,7 +232,7 @@ namespace grail { namespace io {
                     }
 
                     sym_state = detail::find_symbol<
-                        BUFFER_SIZE,
+                        BufferT,
                         LOOK_FOR_ERRORS
                     >(
                         buffer,
@@ -252,7 +253,7 @@ namespace grail { namespace io {
                             file_name, temp_line, temp_col,
                             "Expected to get '(START)' or '(FINAL)', "
                             "instead I got '(%s%s'.",
-                            scratch, codepoint
+                            scratch, buffer.reread()
                         );
                         return T_ERROR;
                     }
@@ -272,7 +273,7 @@ namespace grail { namespace io {
                         if(LOOK_FOR_ERRORS) {
 
                             const bool find_close(detail::find_next<
-                                BUFFER_SIZE,
+                                BufferT,
                                 LOOK_FOR_ERRORS
                             >(
                                 buffer, "*/"
@@ -298,7 +299,7 @@ namespace grail { namespace io {
                 // Python-style comments
                 case '#':
                 ignore_line:
-                    detail::find_next<BUFFER_SIZE,LOOK_FOR_ERRORS>(buffer, "\n");
+                    detail::find_next<BufferT,LOOK_FOR_ERRORS>(buffer, "\n");
                     return T_NEW_LINE;
 
                 // new line
@@ -310,7 +311,7 @@ namespace grail { namespace io {
                     scratch[0] = '$';
                     scratch[1] = '\0';
                     detail::find_symbol<
-                        BUFFER_SIZE,
+                        BufferT,
                         LOOK_FOR_ERRORS
                     >(
                         buffer,
@@ -342,7 +343,7 @@ namespace grail { namespace io {
                         scratch[1] = '\0';
 
                         detail::find_symbol<
-                            BUFFER_SIZE,
+                            BufferT,
                             LOOK_FOR_ERRORS
                         >(
                             buffer,
@@ -368,10 +369,10 @@ namespace grail { namespace io {
                             type = T_STATE_SYMBOL;
                             scratch_offset = 0U;
                         } else {
-                            strcpy(scratch, codepoint);
+                            memcpy(scratch, codepoint, buffer.byte_length());
                         }
                         sym_state = detail::find_symbol<
-                            BUFFER_SIZE,
+                            BufferT,
                             LOOK_FOR_ERRORS
                         >(
                             buffer,
@@ -415,7 +416,7 @@ namespace grail { namespace io {
                         error(
                             file_name, buffer.line(), buffer.column(),
                             "Unexpected UTF-8 codepoint found: '%s'.",
-                            codepoint
+                            buffer.reread()
                         );
                         return T_ERROR;
                     }
@@ -426,313 +427,331 @@ namespace grail { namespace io {
 
             return T_ERROR;
         }
-    }
-
-    /// read in a PDA from a file
-    template <typename AlphaT>
-    bool fread(
-        FILE *ff,
-        fltl::PDA<AlphaT> &PDA,
-        const char * const file_name
-    ) throw() {
-
-        if(0 == ff) {
-            return false;
-        }
 
-        io::verbose("Reading PDA from '%s'...\n", file_name);
+        /// read in a PDA from a UTF-8 buffer
+        template <typename AlphaT, typename BufferT>
+        bool fread(
+            BufferT &buffer,
+            fltl::PDA<AlphaT> &PDA,
+            const char * const file_name
+        ) throw() {
 
-        pda::token_type tt(pda::T_END);
-        UTF8FileBuffer<pda::BUFFER_SIZE> buffer(ff);
+            pda::token_type tt(pda::T_END);
 
-        // extra space is given to the scratch space to allow short overruns
-        char scratch[pda::SCRATCH_SIZE + 20] = {'\0'};
-        char start_state_name[pda::SCRATCH_SIZE + 20] = {'\0'};
-        char *scratch_end(&(scratch[pda::SCRATCH_SIZE - 1]));
+            // extra space is given to the scratch space to allow short overruns
+            char scratch[pda::SCRATCH_SIZE + 20] = {'\0'};
+            char start_state_name[pda::SCRATCH_SIZE + 20] = {'\0'};
+            char *scratch_end(&(scratch[pda::SCRATCH_SIZE - 1]));
 
-        unsigned num_start_states(0);
-        unsigned long start_state_val(0);
+            unsigned num_start_states(0);
+            unsigned long start_state_val(0);
 
-        uint8_t state(pda::STATE_START);
-        uint8_t prev_state(pda::STATE_SINK);
+            uint8_t state(pda::STATE_START);
+            uint8_t prev_state(pda::STATE_SINK);
 
-        for(;;) {
-            tt = pda::get_token<true>(buffer, scratch, scratch_end, file_name);
+            for(;;) {
+                tt = pda::get_token<BufferT, true>(buffer, scratch, scratch_end, file_name);
 
-            if(pda::T_ERROR == tt) {
-                return false;
-            }
+                if(pda::T_ERROR == tt) {
+                    return false;
+                }
 
-            prev_state = state;
-            state = pda::next_state(state, tt);
+                prev_state = state;
+                state = pda::next_state(state, tt);
 
-            // looking at the start state
-            if(pda::STATE_SEEN_START_SET == prev_state
-            && 1 == ++num_start_states) {
-                strcpy(start_state_name, scratch);
-                if(pda::T_STATE == tt) {
-                    start_state_val = strtoul(scratch, 0, 10);
+                // looking at the start state
+                if(pda::STATE_SEEN_START_SET == prev_state
+                && 1 == ++num_start_states) {
+                    strcpy(start_state_name, scratch);
+                    if(pda::T_STATE == tt) {
+                        start_state_val = strtoul(scratch, 0, 10);
+                    }
                 }
-            }
 
-            switch(state) {
-            case pda::STATE_FINAL:
-                goto checked_syntax;
-
-            case pda::STATE_SINK:
-                switch(tt) {
-                case pda::T_START:
-                    strcpy(scratch, "(START)");
-                    break;
-                case pda::T_START_SET:
-                    strcpy(scratch, "|-");
-                    break;
-                case pda::T_FINAL:
-                    strcpy(scratch, "(FINAL)");
-                    break;
-                case pda::T_FINAL_SET:
-                    strcpy(scratch, "-|");
-                    break;
-                case pda::T_SLASH:
-                    strcpy(scratch, "/");
-                    break;
-                case pda::T_COMMA:
-                    strcpy(scratch, ",");
-                    break;
-                case pda::T_NEW_LINE:
-                    strcpy(scratch, "\\n");
-                    break;
-                case pda::T_END:
-                    strcpy(scratch, "<EOF>");
-                    break;
+                switch(state) {
+                case pda::STATE_FINAL:
+                    goto checked_syntax;
+
+                case pda::STATE_SINK:
+                    switch(tt) {
+                    case pda::T_START:
+                        strcpy(scratch, "(START)");
+                        break;
+                    case pda::T_START_SET:
+                        strcpy(scratch, "|-");
+                        break;
+                    case pda::T_FINAL:
+                        strcpy(scratch, "(FINAL)");
+                        break;
+                    case pda::T_FINAL_SET:
+                        strcpy(scratch, "-|");
+                        break;
+                    case pda::T_SLASH:
+                        strcpy(scratch, "/");
+                        break;
+                    case pda::T_COMMA:
+                        strcpy(scratch, ",");
+                        break;
+                    case pda::T_NEW_LINE:
+                        strcpy(scratch, "\\n");
+                        break;
+                    case pda::T_END:
+                        strcpy(scratch, "<EOF>");
+                        break;
+
+                    case pda::T_INPUT_SYMBOL:
+                    case pda::T_STACK_SYMBOL:
+                    case pda::T_STATE_SYMBOL:
+                    case pda::T_STATE:
+                    case pda::T_ERROR:
+                    default:
+                        break;
+                    }
 
-                case pda::T_INPUT_SYMBOL:
-                case pda::T_STACK_SYMBOL:
-                case pda::T_STATE_SYMBOL:
-                case pda::T_STATE:
-                case pda::T_ERROR:
-                default:
-                    break;
+                    error(
+                        file_name, buffer.line(), buffer.column(),
+                        "Unexpected symbol found with value '%s'. Note: "
+                        "previous state of parsing automaton was %u.",
+                        scratch, prev_state
+                    );
+                    return false;
                 }
-
-                error(
-                    file_name, buffer.line(), buffer.column(),
-                    "Unexpected symbol found with value '%s'. Note: "
-                    "previous state of parsing automaton was %u.",
-                    scratch, prev_state
-                );
-                return false;
             }
-        }
 
-    checked_syntax:
-
-        FLTL_PDA_USE_TYPES(fltl::PDA<AlphaT>);
-
-        // map unsigned longs to states
-        std::map<unsigned long, state_type> state_map;
-        helper::CStringMap<state_type> named_state_map;
-
-        // special case so we don't add in needless epsilon transitions
-        if(1 == num_start_states) {
-            state_map[start_state_val] = PDA.get_start_state();
-        }
+        checked_syntax:
 
-        buffer.reset();
-        state = pda::STATE_START;
-        prev_state = pda::STATE_SINK;
-        uint8_t prev_prev_state(pda::STATE_SINK);
+            FLTL_PDA_USE_TYPES(fltl::PDA<AlphaT>);
 
-        state_type seen_states[2];
-        state_type *next_seen_state(&(seen_states[0]));
-        symbol_type seen_symbols[3];
-        symbol_type *next_seen_symbol(&(seen_symbols[0]));
-        alphabet_type sym;
+            // map unsigned longs to states
+            std::map<unsigned long, state_type> state_map;
+            helper::CStringMap<state_type> named_state_map;
 
-        unsigned long state_id;
+            // special case so we don't add in needless epsilon transitions
+            if(1 == num_start_states) {
+                state_map[start_state_val] = PDA.get_start_state();
+            }
 
-        // re-parse without error checking
-        for(;;) {
-            tt = pda::get_token<false>(buffer, scratch, scratch_end, file_name);
+            buffer.reset();
+            state = pda::STATE_START;
+            prev_state = pda::STATE_SINK;
+            uint8_t prev_prev_state(pda::STATE_SINK);
 
-            prev_prev_state = prev_state;
-            prev_state = state;
-            state = pda::next_state(state, tt);
+            state_type seen_states[2];
+            state_type *next_seen_state(&(seen_states[0]));
+            symbol_type seen_symbols[3];
+            symbol_type *next_seen_symbol(&(seen_symbols[0]));
+            alphabet_type sym;
 
-            switch(tt) {
+            unsigned long state_id;
 
-            case pda::T_INPUT_SYMBOL:
-                traits_type::unserialize(scratch, sym);
-                *next_seen_symbol = PDA.get_alphabet_symbol(sym);
-                ++next_seen_symbol;
-                break;
+            // re-parse without error checking
+            for(;;) {
+                tt = pda::get_token<BufferT, false>(buffer, scratch, scratch_end, file_name);
 
-            case pda::T_STACK_SYMBOL:
-                if(0 == strcmp(scratch, "epsilon")) {
-                    *next_seen_symbol = PDA.epsilon();
-                } else {
-                    *next_seen_symbol = PDA.get_stack_symbol(scratch);
-                }
-                ++next_seen_symbol;
-                break;
-
-            case pda::T_STATE: {
-                state_type curr_state;
-                state_id = strtoul(scratch, 0, 10);
-                if(1 == num_start_states && start_state_val == state_id) {
-                    curr_state = PDA.get_start_state();
-                } else  if(0 == state_map.count(state_id)) {
-                    curr_state = PDA.add_state();
-                    state_map[state_id] = curr_state;
-                } else {
-                    curr_state = state_map[state_id];
-                }
+                prev_prev_state = prev_state;
+                prev_state = state;
+                state = pda::next_state(state, tt);
 
-                *next_seen_state = curr_state;
-                ++next_seen_state;
-                break;
-            }
+                switch(tt) {
 
-            case pda::T_STATE_SYMBOL: {
-                state_type curr_state;
-                bool has_state(false);
+                case pda::T_INPUT_SYMBOL:
+                    traits_type::unserialize(scratch, sym);
+                    *next_seen_symbol = PDA.get_alphabet_symbol(sym);
+                    ++next_seen_symbol;
+                    break;
 
-                if(1 == num_start_states
-                && 0 == strcmp(scratch, start_state_name)) {
-                    curr_state = PDA.get_start_state();
-                    has_state = true;
-                }
+                case pda::T_STACK_SYMBOL:
+                    if(0 == strcmp(scratch, "epsilon")) {
+                        *next_seen_symbol = PDA.epsilon();
+                    } else {
+                        *next_seen_symbol = PDA.get_stack_symbol(scratch);
+                    }
+                    ++next_seen_symbol;
+                    break;
 
-                if(!named_state_map.contains(scratch)) {
-                    if(!has_state) {
+                case pda::T_STATE: {
+                    state_type curr_state;
+                    state_id = strtoul(scratch, 0, 10);
+                    if(1 == num_start_states && start_state_val == state_id) {
+                        curr_state = PDA.get_start_state();
+                    } else  if(0 == state_map.count(state_id)) {
                         curr_state = PDA.add_state();
+                        state_map[state_id] = curr_state;
+                    } else {
+                        curr_state = state_map[state_id];
                     }
-                    PDA.set_name(curr_state, scratch);
-                    named_state_map.set(PDA.get_name(curr_state), curr_state);
-                } else {
-                    curr_state = named_state_map.get(scratch);
-                }
-
-                *next_seen_state = curr_state;
-                ++next_seen_state;
-                break;
-            }
 
-            case pda::T_ERROR:
-            case pda::T_END:
-            case pda::T_NEW_LINE:
-            case pda::T_COMMA:
-            case pda::T_SLASH:
-            case pda::T_FINAL_SET:
-            case pda::T_FINAL:
-            case pda::T_START_SET:
-            case pda::T_START:
-            default:
-                break;
-            }
-
-            switch(state) {
-            case pda::STATE_FINAL:
-                goto done;
-
-            case pda::STATE_START:
+                    *next_seen_state = curr_state;
+                    ++next_seen_state;
+                    break;
+                }
 
-                // we need to add a transition that doesn't push
-                if(pda::STATE_ADDED_NO_PUSH == prev_state) {
+                case pda::T_STATE_SYMBOL: {
+                    state_type curr_state;
+                    bool has_state(false);
 
-                    // it doesn't pop either
-                    if(pda::STATE_SEEN_COMMA == prev_prev_state) {
-                        goto add_nfa_trans;
+                    if(1 == num_start_states
+                    && 0 == strcmp(scratch, start_state_name)) {
+                        curr_state = PDA.get_start_state();
+                        has_state = true;
                     }
 
-                    // it pops one symbol
-                    PDA.add_transition(
-                        seen_states[0],
-                        seen_symbols[0],
-                        seen_symbols[1],
-                        PDA.epsilon(),
-                        seen_states[1]
-                    );
+                    if(!named_state_map.contains(scratch)) {
+                        if(!has_state) {
+                            curr_state = PDA.add_state();
+                        }
+                        PDA.set_name(curr_state, scratch);
+                        named_state_map.set(PDA.get_name(curr_state), curr_state);
+                    } else {
+                        curr_state = named_state_map.get(scratch);
+                    }
 
-                // add a transition that doesn't pop or push
-                } else if(pda::STATE_ADDED_NFA_TRANS == prev_state) {
-                add_nfa_trans:
-                    PDA.add_transition(
-                        seen_states[0],
-                        seen_symbols[0],
-                        PDA.epsilon(),
-                        PDA.epsilon(),
-                        seen_states[1]
-                    );
+                    *next_seen_state = curr_state;
+                    ++next_seen_state;
+                    break;
                 }
 
-                next_seen_state = &(seen_states[0]);
-                next_seen_symbol = &(seen_symbols[0]);
-                prev_state = pda::STATE_START;
-                prev_prev_state = pda::STATE_START;
-                break;
-
-            // one of several types of transitions
-            case pda::STATE_ADDED_ANY:
+                case pda::T_ERROR:
+                case pda::T_END:
+                case pda::T_NEW_LINE:
+                case pda::T_COMMA:
+                case pda::T_SLASH:
+                case pda::T_FINAL_SET:
+                case pda::T_FINAL:
+                case pda::T_START_SET:
+                case pda::T_START:
+                default:
+                    break;
+                }
 
-                // start state
-                if(pda::STATE_SEEN_START_SET == prev_state) {
-                    PDA.add_start_state(seen_states[0]);
+                switch(state) {
+                case pda::STATE_FINAL:
+                    goto done;
 
-                // final state
-                } else if(pda::STATE_SEEN_FINAL_SET == prev_state) {
-                    PDA.add_accept_state(seen_states[0]);
+                case pda::STATE_START:
 
-                // we are pushing a symbol on, figure out if we're popping
-                // as well
-                } else if(pda::STATE_ADDED_NO_PUSH == prev_state) {
+                    // we need to add a transition that doesn't push
+                    if(pda::STATE_ADDED_NO_PUSH == prev_state) {
 
-                    // not popping
-                    if(pda::STATE_SEEN_COMMA == prev_prev_state) {
+                        // it doesn't pop either
+                        if(pda::STATE_SEEN_COMMA == prev_prev_state) {
+                            goto add_nfa_trans;
+                        }
 
+                        // it pops one symbol
                         PDA.add_transition(
                             seen_states[0],
                             seen_symbols[0],
-                            PDA.epsilon(),
                             seen_symbols[1],
+                            PDA.epsilon(),
                             seen_states[1]
                         );
 
-                    // popping and pushing
-                    } else {
+                    // add a transition that doesn't pop or push
+                    } else if(pda::STATE_ADDED_NFA_TRANS == prev_state) {
+                    add_nfa_trans:
                         PDA.add_transition(
                             seen_states[0],
                             seen_symbols[0],
-                            seen_symbols[1],
-                            seen_symbols[2],
+                            PDA.epsilon(),
+                            PDA.epsilon(),
                             seen_states[1]
                         );
                     }
-                }
 
-                prev_state = pda::STATE_SINK;
+                    next_seen_state = &(seen_states[0]);
+                    next_seen_symbol = &(seen_symbols[0]);
+                    prev_state = pda::STATE_START;
+                    prev_prev_state = pda::STATE_START;
+                    break;
+
+                // one of several types of transitions
+                case pda::STATE_ADDED_ANY:
 
-                break;
+                    // start state
+                    if(pda::STATE_SEEN_START_SET == prev_state) {
+                        PDA.add_start_state(seen_states[0]);
 
-            case pda::STATE_ADDED_NFA_TRANS:
-            case pda::STATE_ADDED_NO_PUSH:
-            case pda::STATE_SEEN_COMMA:
-            case pda::STATE_SEEN_FINAL_SET:
-            case pda::STATE_SEEN_START_SET:
-            case pda::STATE_SINK:
-            default:
-                break;
+                    // final state
+                    } else if(pda::STATE_SEEN_FINAL_SET == prev_state) {
+                        PDA.add_accept_state(seen_states[0]);
+
+                    // we are pushing a symbol on, figure out if we're popping
+                    // as well
+                    } else if(pda::STATE_ADDED_NO_PUSH == prev_state) {
+
+                        // not popping
+                        if(pda::STATE_SEEN_COMMA == prev_prev_state) {
+
+                            PDA.add_transition(
+                                seen_states[0],
+                                seen_symbols[0],
+                                PDA.epsilon(),
+                                seen_symbols[1],
+                                seen_states[1]
+                            );
+
+                        // popping and pushing
+                        } else {
+                            PDA.add_transition(
+                                seen_states[0],
+                                seen_symbols[0],
+                                seen_symbols[1],
+                                seen_symbols[2],
+                                seen_states[1]
+                            );
+                        }
+                    }
+
+                    prev_state = pda::STATE_SINK;
+
+                    break;
+
+                case pda::STATE_ADDED_NFA_TRANS:
+                case pda::STATE_ADDED_NO_PUSH:
+                case pda::STATE_SEEN_COMMA:
+                case pda::STATE_SEEN_FINAL_SET:
+                case pda::STATE_SEEN_START_SET:
+                case pda::STATE_SINK:
+                default:
+                    break;
+                }
             }
+
+        done:
+
+            io::verbose("    %u states,\n", PDA.num_states());
+            io::verbose("        %u accept states,\n", PDA.num_accept_states());
+            io::verbose("    %u transitions,\n", PDA.num_transitions());
+            io::verbose("    %u symbols.\n", PDA.num_symbols());
+
+            return true;
         }
+    }
 
-    done:
+    /// read in a PDA from a file. regular files are mapped into memory and
+    /// tokenized in place; anything else, e.g. a pipe, is read through a
+    /// buffer.
+    template <typename AlphaT>
+    bool fread(
+        FILE *ff,
+        fltl::PDA<AlphaT> &PDA,
+        const char * const file_name
+    ) throw() {
 
-        io::verbose("    %u states,\n", PDA.num_states());
-        io::verbose("        %u accept states,\n", PDA.num_accept_states());
-        io::verbose("    %u transitions,\n", PDA.num_transitions());
-        io::verbose("    %u symbols.\n", PDA.num_symbols());
+        if(0 == ff) {
+            return false;
+        }
+
+        io::verbose("Reading PDA from '%s'...\n", file_name);
+
+        UTF8MappedBuffer mapped_buffer(ff);
+        if(mapped_buffer.is_mapped()) {
+            return pda::fread(mapped_buffer, PDA, file_name);
+        }
 
-        return true;
+        UTF8FileBuffer<pda::BUFFER_SIZE> buffer(ff);
+        return pda::fread(buffer, PDA, file_name);
     }
 
 }}
@@ -0,0 +1,169 @@
+/*
+ * fwrite_binary_cfg.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FWRITE_BINARY_CFG_HPP_
+#define FLTL_FWRITE_BINARY_CFG_HPP_
+
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/CFG.hpp"
+
+#include "grail/include/io/binary.hpp"
+
+#include "grail/include/algorithm/CFG_REMOVE_USELESS.hpp"
+
+namespace grail { namespace io {
+
+    /// write out a context-free grammar in the binary format. the layout
+    /// is:
+    ///
+    ///     num terminals, terminals...
+    ///     num variables, variable names... (start variable first)
+    ///     num variable terminals, variable terminal names...
+    ///     num productions, [variable, length, tagged symbols...]...
+    ///
+    /// symbols are numbered by their first appearance, in the same order
+    /// that fprint prints them, so that reading in the binary grammar gives
+    /// the same grammar as reading in the printed one. as with fprint, any
+    /// useless variables and productions are removed first.
+    template <typename AlphaT>
+    bool fwrite_binary(FILE *ff, fltl::CFG<AlphaT> &cfg) throw() {
+
+        FLTL_CFG_USE_TYPES(fltl::CFG<AlphaT>);
+
+        algorithm::CFG_REMOVE_USELESS<AlphaT>::run(cfg);
+
+        binary::Writer out(ff);
+        out.put_header(binary::KIND_CFG);
+
+        // nothing to write
+        if(0 == cfg.num_productions() || !cfg.has_start_variable()) {
+            out.put_u32(0U);
+            out.put_u32(0U);
+            out.put_u32(0U);
+            out.put_u32(0U);
+            return out.is_ok();
+        }
+
+        // indices are offset by one so that zero means "not yet seen"
+        std::vector<unsigned> var_index(cfg.num_variables_capacity() + 1U, 0U);
+        std::vector<unsigned> term_index(cfg.num_terminals() + 2U, 0U);
+
+        std::vector<variable_type> vars;
+        std::vector<terminal_type> terms;
+        std::vector<terminal_type> var_terms;
+        std::vector<uint32_t> prods;
+
+        const variable_type SV(cfg.get_start_variable());
+        variable_type V;
+        symbol_string_type S;
+
+        vars.push_back(SV);
+        var_index[SV.number()] = 1U;
+
+        generator_type all_vars(cfg.search(~V));
+        for(; all_vars.match_next(); ) {
+            if(0U == var_index[V.number()]) {
+                vars.push_back(V);
+                var_index[V.number()] = static_cast<unsigned>(vars.size());
+            }
+        }
+
+        // flatten the productions, numbering terminals as they are seen.
+        // unnamed variables are given names in the same order that fprint
+        // would give them names.
+        unsigned num_prods(0);
+        for(unsigned i(0); i < vars.size(); ++i) {
+            V = vars[i];
+            cfg.get_name(V);
+            generator_type productions(cfg.search(V --->* ~S));
+
+            for(; productions.match_next(); ++num_prods) {
+                const unsigned len(S.length());
+                prods.push_back(static_cast<uint32_t>(i));
+                prods.push_back(static_cast<uint32_t>(len));
+
+                for(unsigned j(0); j < len; ++j) {
+                    const symbol_type sym(S.at(j));
+                    uint32_t tagged(0);
+
+                    if(sym.is_variable()) {
+                        const variable_type A(sym);
+                        cfg.get_name(A);
+                        tagged = static_cast<uint32_t>(
+                            (var_index[A.number()] - 1U) << binary::CFG_TAG_BITS
+                        ) | binary::CFG_VARIABLE;
+
+                    } else {
+                        const terminal_type a(sym);
+                        const bool is_var_term(cfg.is_variable_terminal(a));
+                        unsigned &index(term_index[a.number()]);
+
+                        if(0U == index) {
+                            if(is_var_term) {
+                                var_terms.push_back(a);
+                                index = static_cast<unsigned>(var_terms.size());
+                            } else {
+                                terms.push_back(a);
+                                index = static_cast<unsigned>(terms.size());
+                            }
+                        }
+
+                        tagged = static_cast<uint32_t>(
+                            (index - 1U) << binary::CFG_TAG_BITS
+                        ) | (is_var_term
+                            ? binary::CFG_VARIABLE_TERMINAL
+                            : binary::CFG_TERMINAL);
+                    }
+
+                    prods.push_back(tagged);
+                }
+            }
+        }
+
+        out.put_u32(static_cast<uint32_t>(terms.size()));
+        for(unsigned i(0); i < terms.size(); ++i) {
+            out.put_alpha(cfg.get_alpha(terms[i]));
+        }
+
+        out.put_u32(static_cast<uint32_t>(vars.size()));
+        for(unsigned i(0); i < vars.size(); ++i) {
+            out.put_string(cfg.get_name(vars[i]));
+        }
+
+        out.put_u32(static_cast<uint32_t>(var_terms.size()));
+        for(unsigned i(0); i < var_terms.size(); ++i) {
+            out.put_string(cfg.get_name(var_terms[i]));
+        }
+
+        out.put_u32(static_cast<uint32_t>(num_prods));
+        for(unsigned i(0); i < prods.size(); ++i) {
+            out.put_u32(prods[i]);
+        }
+
+        return out.is_ok();
+    }
+}}
+
+#endif /* FLTL_FWRITE_BINARY_CFG_HPP_ */
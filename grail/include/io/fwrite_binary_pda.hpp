@@ -0,0 +1,106 @@
+/*
+ * fwrite_binary_pda.hpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef FLTL_FWRITE_BINARY_PDA_HPP_
+#define FLTL_FWRITE_BINARY_PDA_HPP_
+
+#include <cstdio>
+#include <vector>
+#include <stdint.h>
+
+#include "fltl/include/PDA.hpp"
+
+#include "grail/include/io/binary.hpp"
+
+namespace grail { namespace io {
+
+    /// write out a pushdown automaton in the binary format. states and
+    /// symbols keep their numbers, so the layout is:
+    ///
+    ///     num states, start state, state names...
+    ///     num accept states, accept states...
+    ///     num symbols, [kind, alpha or name]... (epsilon is implicit)
+    ///     num transitions, [source, read, pop, push, sink]...
+    template <typename AlphaT>
+    bool fwrite_binary(FILE *ff, const fltl::PDA<AlphaT> &pda) throw() {
+
+        FLTL_PDA_USE_TYPES(fltl::PDA<AlphaT>);
+
+        binary::Writer out(ff);
+        out.put_header(binary::KIND_PDA);
+
+        // states are numbered densely from zero
+        state_type state;
+        generator_type states(pda.search(~state));
+
+        out.put_u32(static_cast<uint32_t>(pda.num_states()));
+        out.put_u32(static_cast<uint32_t>(pda.get_start_state().number()));
+        for(; states.match_next(); ) {
+            out.put_string(pda.get_name(state));
+        }
+
+        out.put_u32(static_cast<uint32_t>(pda.num_accept_states()));
+        for(states.rewind(); states.match_next(); ) {
+            if(pda.is_accept_state(state)) {
+                out.put_u32(static_cast<uint32_t>(state.number()));
+            }
+        }
+
+        // symbols are numbered densely from one
+        symbol_type sym;
+        generator_type symbols(pda.search(~sym));
+
+        out.put_u32(static_cast<uint32_t>(pda.num_symbols()));
+        for(; symbols.match_next(); ) {
+            if(0U == sym.number()) {
+                continue;
+            } else if(pda.is_in_input_alphabet(sym)) {
+                out.put_u32(binary::PDA_INPUT_SYMBOL);
+                out.put_alpha(pda.get_alpha(sym));
+            } else {
+                out.put_u32(binary::PDA_STACK_SYMBOL);
+                out.put_string(pda.get_name(sym));
+            }
+        }
+
+        std::vector<uint32_t> trans_data;
+        transition_type trans;
+        generator_type transitions(pda.search(~trans));
+
+        for(; transitions.match_next(); ) {
+            trans_data.push_back(trans.source().number());
+            trans_data.push_back(trans.read().number());
+            trans_data.push_back(trans.pop().number());
+            trans_data.push_back(trans.push().number());
+            trans_data.push_back(trans.sink().number());
+        }
+
+        out.put_u32(static_cast<uint32_t>(trans_data.size() / 5U));
+        for(unsigned i(0); i < trans_data.size(); ++i) {
+            out.put_u32(trans_data[i]);
+        }
+
+        return out.is_ok();
+    }
+}}
+
+#endif /* FLTL_FWRITE_BINARY_PDA_HPP_ */
@@ -0,0 +1,71 @@
+/*
+ * UTF8MappedBuffer.cpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "grail/include/io/UTF8MappedBuffer.hpp"
+
+namespace grail { namespace io { namespace mmap {
+
+    bool map(FILE *fp, const char **data, size_t *size) throw() {
+        struct stat info;
+        const int fd(fileno(fp));
+
+        if(0 > fd || 0 != fstat(fd, &info) || !S_ISREG(info.st_mode)) {
+            return false;
+        }
+
+        // empty files can't be mapped
+        if(0 >= info.st_size) {
+            return false;
+        }
+
+        void *addr(::mmap(
+            0,
+            static_cast<size_t>(info.st_size),
+            PROT_READ,
+            MAP_PRIVATE,
+            fd,
+            0
+        ));
+
+        if(MAP_FAILED == addr) {
+            return false;
+        }
+
+#ifdef MADV_SEQUENTIAL
+        // the file is read front-to-back
+        madvise(addr, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+#endif
+
+        *data = reinterpret_cast<const char *>(addr);
+        *size = static_cast<size_t>(info.st_size);
+        return true;
+    }
+
+    void unmap(const char *data, size_t size) throw() {
+        munmap(const_cast<char *>(data), size);
+    }
+
+}}}
@@ -0,0 +1,208 @@
+/*
+ * binary.cpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cassert>
+
+#include "grail/include/io/binary.hpp"
+#include "grail/include/io/error.hpp"
+#include "grail/include/io/UTF8MappedBuffer.hpp"
+
+namespace grail { namespace io { namespace binary {
+
+    enum {
+        READ_CHUNK_SIZE = 4096U
+    };
+
+    static const char MAGIC[4] = {'G', 'R', 'L', '+'};
+
+    Writer::Writer(FILE *ff_) throw()
+        : fltl::trait::Uncopyable()
+        , ff(ff_)
+        , ok(0 != ff_)
+    { }
+
+    void Writer::put_header(const uint32_t kind) throw() {
+        if(ok) {
+            ok = 4U == ::fwrite(MAGIC, 1U, 4U, ff);
+        }
+        put_u32(VERSION);
+        put_u32(kind);
+    }
+
+    void Writer::put_u32(const uint32_t val) throw() {
+        const unsigned char bytes[4] = {
+            static_cast<unsigned char>(val & 0xFFU),
+            static_cast<unsigned char>((val >> 8U) & 0xFFU),
+            static_cast<unsigned char>((val >> 16U) & 0xFFU),
+            static_cast<unsigned char>((val >> 24U) & 0xFFU)
+        };
+
+        if(ok) {
+            ok = 4U == ::fwrite(bytes, 1U, 4U, ff);
+        }
+    }
+
+    void Writer::put_string(const char *str) throw() {
+        const size_t len(strlen(str));
+        put_u32(static_cast<uint32_t>(len));
+        if(ok) {
+            ok = (len + 1U) == ::fwrite(str, 1U, len + 1U, ff);
+        }
+    }
+
+    Reader::Reader(FILE *ff) throw()
+        : fltl::trait::Uncopyable()
+        , begin(0)
+        , curr(0)
+        , end(0)
+        , mapped_size(0)
+        , owned(0)
+        , ok(true)
+    {
+        if(0 == ff) {
+            ok = false;
+            return;
+        }
+
+        // regular files are mapped in
+        if(mmap::map(ff, &begin, &mapped_size)) {
+            curr = begin;
+            end = begin + mapped_size;
+            return;
+        }
+
+        // everything else is read in
+        size_t size(0);
+        size_t capacity(READ_CHUNK_SIZE);
+        owned = new char[capacity];
+
+        for(;;) {
+            if(size == capacity) {
+                char *grown(new char[capacity * 2U]);
+                memcpy(grown, owned, size);
+                delete [] owned;
+                owned = grown;
+                capacity *= 2U;
+            }
+
+            const size_t got(::fread(owned + size, 1U, capacity - size, ff));
+            if(0U == got) {
+                break;
+            }
+            size += got;
+        }
+
+        begin = owned;
+        curr = begin;
+        end = begin + size;
+    }
+
+    Reader::~Reader(void) throw() {
+        if(0 != mapped_size) {
+            mmap::unmap(begin, mapped_size);
+        } else if(0 != owned) {
+            delete [] owned;
+        }
+
+        begin = 0;
+        curr = 0;
+        end = 0;
+        owned = 0;
+        mapped_size = 0;
+    }
+
+    bool Reader::get_header(const uint32_t kind, const char *file_name) throw() {
+        if(!ok || (end - curr) < 12 || 0 != memcmp(curr, MAGIC, 4U)) {
+            error(
+                "File '%s' does not contain a binary Grail+ object.",
+                file_name
+            );
+            return false;
+        }
+
+        curr += 4;
+
+        const uint32_t version(get_u32());
+        if(VERSION != version) {
+            error(
+                "File '%s' contains a binary Grail+ object of version %u, "
+                "but only version %u is supported.",
+                file_name, static_cast<unsigned>(version),
+                static_cast<unsigned>(VERSION)
+            );
+            return false;
+        }
+
+        if(kind != get_u32()) {
+            error(
+                "File '%s' contains a binary Grail+ object of the wrong "
+                "kind.",
+                file_name
+            );
+            return false;
+        }
+
+        return true;
+    }
+
+    uint32_t Reader::get_u32(void) throw() {
+        if(!ok || (end - curr) < 4) {
+            ok = false;
+            return 0;
+        }
+
+        const unsigned char *bytes(
+            reinterpret_cast<const unsigned char *>(curr)
+        );
+        curr += 4;
+
+        return static_cast<uint32_t>(bytes[0])
+             | (static_cast<uint32_t>(bytes[1]) << 8U)
+             | (static_cast<uint32_t>(bytes[2]) << 16U)
+             | (static_cast<uint32_t>(bytes[3]) << 24U);
+    }
+
+    const char *Reader::get_string(void) throw() {
+        static const char *empty("");
+
+        const uint32_t len(get_u32());
+        if(!ok
+        || static_cast<size_t>(end - curr) <= static_cast<size_t>(len)
+        || '\0' != curr[len]) {
+            ok = false;
+            return empty;
+        }
+
+        const char *str(curr);
+        curr += len + 1U;
+        return str;
+    }
+
+    bool Reader::fail(const char *file_name) throw() {
+        error(
+            "File '%s' contains a truncated or malformed binary Grail+ "
+            "object.",
+            file_name
+        );
+        return false;
+    }
+}}}
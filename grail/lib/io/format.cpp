@@ -0,0 +1,58 @@
+/*
+ * format.cpp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#include "grail/include/io/format.hpp"
+
+namespace grail { namespace io {
+
+    bool get_format(
+        CommandLineOptions &options,
+        const char *opt_name,
+        format::type &fmt
+    ) throw() {
+        fmt = format::TEXT;
+
+        option_type opt(options[opt_name]);
+        if(!opt.is_valid()) {
+            return true;
+        }
+
+        const char *name(opt.value());
+        if(0 == strcmp("text", name)) {
+            fmt = format::TEXT;
+        } else if(0 == strcmp("binary", name)) {
+            fmt = format::BINARY;
+        } else {
+            options.error(
+                "Unknown format '%s'. The supported formats are 'text' "
+                "and 'binary'.",
+                name
+            );
+            options.note("Format specified here:", opt);
+            return false;
+        }
+
+        return true;
+    }
+}}
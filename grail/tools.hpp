@@ -5,10 +5,15 @@
 #include "grail/include/cli/PDA_TO_CFG.hpp"
 #include "grail/include/cli/CFG_TO_GNF.hpp"
 #include "grail/include/cli/CFG_TO_LL1.hpp"
+#include "grail/include/cli/CFG_TO_LALR.hpp"
 #include "grail/include/cli/CFG_STACK_LANG.hpp"
 #include "grail/include/cli/PDA_INTERSECT_NFA.hpp"
 #include "grail/include/cli/NFA_TO_DOT.hpp"
+#include "grail/include/cli/NFA_TO_DFA.hpp"
+#include "grail/include/cli/DFA_MINIMIZE.hpp"
+#include "grail/include/cli/DFA_TO_SCANNER.hpp"
 #include "grail/include/cli/NFA_DOMINATORS.hpp"
+#include "grail/include/cli/NFA_MATCH.hpp"
 #include "grail/include/cli/CFG_REMOVE_LR.hpp"
 
 GRAIL_DECLARE_TOOL(CFG_PARSE)
@@ -18,7 +23,12 @@ GRAIL_DECLARE_TOOL(CFG_TO_CNF)
 GRAIL_DECLARE_TOOL(CFG_TO_GNF)
 GRAIL_DECLARE_TOOL(CFG_TO_PDA)
 GRAIL_DECLARE_TOOL(CFG_TO_LL1)
+GRAIL_DECLARE_TOOL(CFG_TO_LALR)
+GRAIL_DECLARE_TOOL(DFA_MINIMIZE)
+GRAIL_DECLARE_TOOL(DFA_TO_SCANNER)
 GRAIL_DECLARE_TOOL(NFA_DOMINATORS)
+GRAIL_DECLARE_TOOL(NFA_MATCH)
+GRAIL_DECLARE_TOOL(NFA_TO_DFA)
 GRAIL_DECLARE_TOOL(NFA_TO_DOT)
 GRAIL_DECLARE_TOOL(PDA_INTERSECT_NFA)
 GRAIL_DECLARE_TOOL(PDA_TO_CFG)